@@ -0,0 +1,56 @@
+// Trace-driven simulation of the GPGPU-Sim memory partitions.
+//
+// Replays the L2->DRAM request stream recorded by a full run with
+// -gpgpu_dram_trace_file through the memory partitions and DRAM channels
+// only, so DRAM scheduler sweeps run without simulating the shader cores and
+// the interconnect.  Reads gpgpusim.config like the full simulator; options
+// on the command line override it, e.g.
+//
+//   dram_replay -dram_replay_trace dram.trace -gpgpu_dram_scheduler paws
+//
+// The trace must be replayed with the address mapping and partition
+// configuration it was recorded with.
+
+#include <assert.h>
+#include <locale.h>
+#include <stdio.h>
+#include <vector>
+#include "../libcuda/gpgpu_context.h"
+#include "../src/gpgpu-sim/dram_trace.h"
+#include "../src/gpgpu-sim/gpu-sim.h"
+#include "../src/gpgpu-sim/icnt_wrapper.h"
+#include "../src/option_parser.h"
+
+int main(int argc, const char *argv[]) {
+  std::vector<const char *> args;
+  args.push_back(argv[0]);
+  args.push_back("-config");
+  args.push_back("gpgpusim.config");
+  for (int i = 1; i < argc; i++) args.push_back(argv[i]);
+
+  gpgpu_context *ctx = new gpgpu_context();
+  option_parser_t opp = option_parser_create();
+  ctx->ptx_reg_options(opp);
+  ctx->func_sim->ptx_opcocde_latency_options(opp);
+  icnt_reg_options(opp);
+  gpgpu_sim_config *config = new gpgpu_sim_config(ctx);
+  config->reg_options(opp);
+
+  char *trace_file;
+  option_parser_register(opp, "-dram_replay_trace", OPT_CSTR, &trace_file,
+                         "DRAM trace recorded with -gpgpu_dram_trace_file",
+                         "dram.trace");
+
+  option_parser_cmdline(opp, args.size(), &args[0]);
+  fprintf(stdout, "GPGPU-Sim: Configuration options:\n\n");
+  option_parser_print(opp, stdout);
+  assert(setlocale(LC_NUMERIC, "C"));
+  config->init();
+
+  gpgpu_sim *gpu = new exec_gpgpu_sim(*config, ctx);
+  dram_trace_reader trace(trace_file, gpu->getMemoryConfig());
+  gpu->replay_dram_trace(trace);
+
+  option_parser_destroy(opp);
+  return 0;
+}
@@ -730,9 +730,11 @@ void **cudaRegisterFatBinaryInternal(void *fatCubin,
                                             context->no_of_ptx);
       }
       source_num++;
-      ctx->api->load_static_globals(symtab, STATIC_ALLOC_LIMIT, 0xFFFFFFFF,
-                                    context->get_device()->get_gpgpu());
-      ctx->api->load_constants(symtab, STATIC_ALLOC_LIMIT,
+      ctx->api->load_static_globals(
+          symtab, g_generic_mem_layout.static_alloc_limit, 0xFFFFFFFF,
+          context->get_device()->get_gpgpu());
+      ctx->api->load_constants(symtab,
+                               g_generic_mem_layout.static_alloc_limit,
                                context->get_device()->get_gpgpu());
     } else {
       printf(
@@ -1031,6 +1033,33 @@ cudaError_t cudaMallocInternal(void **devPtr, size_t size,
   }
 }
 
+// Device memory whose DRAM layout follows -gpgpu_pim_addr_mapping: each
+// operand tile fills the same row of every bank of one channel.
+cudaError_t cudaMallocPIMInternal(void **devPtr, size_t size,
+                                  gpgpu_context *gpgpu_ctx = NULL) {
+  gpgpu_context *ctx;
+  if (gpgpu_ctx) {
+    ctx = gpgpu_ctx;
+  } else {
+    ctx = GPGPU_Context();
+  }
+  if (g_debug_execution >= 3) {
+    announce_call(__my_func__);
+  }
+  CUctx_st *context = GPGPUSim_Context(ctx);
+  *devPtr = context->get_device()->get_gpgpu()->gpu_malloc_pim(size);
+  if (g_debug_execution >= 3) {
+    printf("GPGPU-Sim PTX: cudaMallocPIM %zu bytes starting at 0x%llx..\n",
+           size, (unsigned long long)*devPtr);
+    ctx->api->g_mallocPtr_Size[(unsigned long long)*devPtr] = size;
+  }
+  if (*devPtr) {
+    return g_last_cudaError = cudaSuccess;
+  } else {
+    return g_last_cudaError = cudaErrorMemoryAllocation;
+  }
+}
+
 cudaError_t cudaMallocHostInternal(void **ptr, size_t size,
                                    gpgpu_context *gpgpu_ctx = NULL) {
   gpgpu_context *ctx;
@@ -1593,9 +1622,10 @@ CUresult cuLinkAddFileInternal(CUlinkState state, CUjitInputType type,
   std::string fname(path);
   ctx->api->name_symtab[fname] = symtab;
   context->add_binary(symtab, 1);
-  ctx->api->load_static_globals(symtab, STATIC_ALLOC_LIMIT, 0xFFFFFFFF,
-                                context->get_device()->get_gpgpu());
-  ctx->api->load_constants(symtab, STATIC_ALLOC_LIMIT,
+  ctx->api->load_static_globals(
+      symtab, g_generic_mem_layout.static_alloc_limit, 0xFFFFFFFF,
+      context->get_device()->get_gpgpu());
+  ctx->api->load_constants(symtab, g_generic_mem_layout.static_alloc_limit,
                            context->get_device()->get_gpgpu());
   addedFile = true;
   return CUDA_SUCCESS;
@@ -2333,6 +2363,12 @@ __host__ cudaError_t CUDARTAPI cudaMalloc(void **devPtr, size_t size) {
   return cudaMallocInternal(devPtr, size);
 }
 
+// GPGPU-Sim extension, declare as
+//   extern "C" cudaError_t cudaMallocPIM(void **devPtr, size_t size);
+__host__ cudaError_t CUDARTAPI cudaMallocPIM(void **devPtr, size_t size) {
+  return cudaMallocPIMInternal(devPtr, size);
+}
+
 __host__ cudaError_t CUDARTAPI cudaMallocHost(void **ptr, size_t size) {
   return cudaMallocHostInternal(ptr, size);
 }
@@ -3555,9 +3591,9 @@ void gpgpu_context::cuobjdumpParseBinary(unsigned int handle) {
   }
   api->name_symtab[fname] = symtab;
   context->add_binary(symtab, handle);
-  api->load_static_globals(symtab, STATIC_ALLOC_LIMIT, 0xFFFFFFFF,
-                           context->get_device()->get_gpgpu());
-  api->load_constants(symtab, STATIC_ALLOC_LIMIT,
+  api->load_static_globals(symtab, g_generic_mem_layout.static_alloc_limit,
+                           0xFFFFFFFF, context->get_device()->get_gpgpu());
+  api->load_constants(symtab, g_generic_mem_layout.static_alloc_limit,
                       context->get_device()->get_gpgpu());
   for (itr_m = api->version_filename.begin();
        itr_m != api->version_filename.end(); itr_m++) {
@@ -3625,9 +3661,9 @@ void gpgpu_context::cuobjdumpParseBinary(unsigned int handle) {
     gpgpu_ptxinfo_load_from_string(ptxcode, handle, max_capability,
                                    context->no_of_ptx);
   }
-  api->load_static_globals(symtab, STATIC_ALLOC_LIMIT, 0xFFFFFFFF,
-                           context->get_device()->get_gpgpu());
-  api->load_constants(symtab, STATIC_ALLOC_LIMIT,
+  api->load_static_globals(symtab, g_generic_mem_layout.static_alloc_limit,
+                           0xFFFFFFFF, context->get_device()->get_gpgpu());
+  api->load_constants(symtab, g_generic_mem_layout.static_alloc_limit,
                       context->get_device()->get_gpgpu());
   api->name_symtab[fname] = symtab;
 
@@ -74,7 +74,10 @@ class gpgpu_context {
   void start_sim_thread(int api);
   struct _cuda_device_id *GPGPUSim_Init();
   void ptx_reg_options(option_parser_t opp);
-  const ptx_instruction *pc_to_instruction(unsigned pc);
+  const ptx_instruction *pc_to_instruction(unsigned pc) {
+    if (pc < s_g_pc_to_insn.size()) return s_g_pc_to_insn[pc];
+    return NULL;
+  }
   const warp_inst_t *ptx_fetch_inst(address_type pc);
   unsigned translate_pc_to_ptxlineno(unsigned pc);
 };
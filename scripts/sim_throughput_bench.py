@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+#
+# Simulator-throughput benchmark for GPGPU-Sim.
+#
+# Runs a set of pre-built benchmark applications (linked against the
+# GPGPU-Sim libcudart, optionally with PTX_SIM_USE_PTX_FILE so that no CUDA
+# toolkit is needed at run time) under a fixed set of configurations and
+# reports how fast the simulator itself runs:
+#
+#   kips            thousand simulated thread instructions (gpu_tot_sim_insn)
+#                   per host second
+#   cycles_per_sec  simulated core cycles per host second
+#   peak_rss_kb     peak resident set size of the simulator process
+#   startup_sec     host time until the performance model is initialized
+#
+# Results are written as JSON.  Given a baseline JSON file from an earlier
+# run, the script compares KIPS per (benchmark, config) pair and exits with
+# a non-zero status if any pair regressed by more than the tolerance.
+#
+# Configurations are SM7_QV100, SM75_RTX2060 and a PIM variant of SM7_QV100
+# for every DRAM scheduler registered for -gpgpu_dram_scheduler (listed by
+# the simulator when given an unknown scheduler name).
+#
+# Example:
+#   source setup_environment release
+#   scripts/sim_throughput_bench.py \
+#       --bench vecadd:/path/to/vecadd \
+#       --bench pim_stream:"/path/to/pim_stream 4096" \
+#       --max-insn 2000000 -o bench.json --baseline bench_master.json
+
+import argparse
+import json
+import os
+import re
+import shlex
+import shutil
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+CFG_DIR = os.path.join(ROOT, "configs", "tested-cfgs")
+
+# -gpgpu_dram_scheduler names, see REGISTER_DRAM_SCHEDULER in
+# src/gpgpu-sim/dram_sched*.cc
+DRAM_POLICIES = [
+    "fifo", "frfcfs", "pim_frfcfs", "mem_first", "pim_first", "gi", "gi_mem",
+    "bliss", "fr_rr_fcfs", "rr_batch_cap", "rr_req_cap", "rr_mem", "paws",
+    "paws_new"
+]
+
+# options appended to SM7_QV100 to obtain the PIM configuration
+PIM_OPTIONS = ["-gpgpu_shader_to_mem_vcs 2", "-gpgpu_pim_fence 1"]
+
+INIT_DONE = "GPGPU-Sim uArch: performance model initialization complete."
+STDBUF = shutil.which("stdbuf")
+STAT_RE = re.compile(r"^(gpu_tot_sim_cycle|gpu_tot_sim_insn|"
+                     r"sim_prof_cycles_per_sec|sim_prof_insn_per_sec)"
+                     r"\s*=\s*([0-9.]+)")
+
+
+def build_configs(names):
+  configs = []
+  for name in names:
+    if name == "PIM":
+      for policy in DRAM_POLICIES:
+        configs.append(("PIM_" + policy.upper(), "SM7_QV100",
+                        PIM_OPTIONS + ["-gpgpu_dram_scheduler " + policy]))
+    else:
+      configs.append((name, name, []))
+  return configs
+
+
+def setup_rundir(rundir, base, extra_opts, max_insn):
+  src = os.path.join(CFG_DIR, base)
+  if not os.path.isdir(src):
+    sys.exit("unknown configuration directory: " + src)
+  for f in os.listdir(src):
+    shutil.copy(os.path.join(src, f), rundir)
+  opts = list(extra_opts)
+  if max_insn:
+    opts.append("-gpgpu_max_insn %d" % max_insn)
+  if opts:
+    with open(os.path.join(rundir, "gpgpusim.config"), "a") as cfg:
+      cfg.write("\n# sim_throughput_bench overrides\n")
+      for o in opts:
+        cfg.write(o + "\n")
+
+
+def run_once(cmd, rundir, timeout):
+  stats = {}
+  startup = None
+  log = open(os.path.join(rundir, "sim.log"), "w")
+  # line-buffer the simulator's stdout so INIT_DONE is read when it is
+  # printed, also from builds that do not flush it
+  if STDBUF:
+    cmd = [STDBUF, "-oL"] + cmd
+  start = time.time()
+  proc = subprocess.Popen(cmd, cwd=rundir, stdout=subprocess.PIPE,
+                          stderr=subprocess.STDOUT, universal_newlines=True)
+  # kills the simulator even while it prints nothing
+  watchdog = None
+  if timeout:
+    watchdog = threading.Timer(timeout, proc.kill)
+    watchdog.start()
+  for line in proc.stdout:
+    log.write(line)
+    if startup is None and line.startswith(INIT_DONE):
+      startup = time.time() - start
+    m = STAT_RE.match(line)
+    if m:
+      stats[m.group(1)] = float(m.group(2))
+  proc.stdout.close()
+  _, status, rusage = os.wait4(proc.pid, 0)
+  wall = time.time() - start
+  if watchdog:
+    watchdog.cancel()
+  log.close()
+
+  if startup is None:
+    startup = 0.0
+  sim_sec = max(wall - startup, 1e-6)
+  insn = stats.get("gpu_tot_sim_insn", 0)
+  cycles = stats.get("gpu_tot_sim_cycle", 0)
+  res = {
+      "exit_status": os.WEXITSTATUS(status) if os.WIFEXITED(status) else -1,
+      "wall_sec": wall,
+      "startup_sec": startup,
+      "sim_insn": int(insn),
+      "sim_cycles": int(cycles),
+      "kips": insn / sim_sec / 1000.0,
+      "cycles_per_sec": cycles / sim_sec,
+      "peak_rss_kb": rusage.ru_maxrss,
+  }
+  # present only when the simulator was built with SELF_PROF=1
+  for k in ("sim_prof_cycles_per_sec", "sim_prof_insn_per_sec"):
+    if k in stats:
+      res[k] = stats[k]
+  return res
+
+
+def compare(results, baseline, tolerance):
+  ref = {(r["bench"], r["config"]): r for r in baseline["results"]}
+  regressions = []
+  for r in results:
+    b = ref.get((r["bench"], r["config"]))
+    if b is None or b["kips"] <= 0:
+      continue
+    ratio = r["kips"] / b["kips"]
+    r["baseline_kips"] = b["kips"]
+    r["speedup"] = ratio
+    if ratio < 1.0 - tolerance:
+      regressions.append(r)
+  return regressions
+
+
+def main():
+  parser = argparse.ArgumentParser(
+      description="Measure GPGPU-Sim simulation throughput.")
+  parser.add_argument("--bench", action="append", required=True,
+                      metavar="NAME:CMD",
+                      help="benchmark name and command line (repeatable)")
+  parser.add_argument("--configs", default="SM7_QV100,SM75_RTX2060,PIM",
+                      help="comma separated list of configs; PIM expands to "
+                           "one config per DRAM scheduling policy")
+  parser.add_argument("--max-insn", type=int, default=0,
+                      help="bound each run with -gpgpu_max_insn")
+  parser.add_argument("--repeat", type=int, default=1,
+                      help="runs per pair; the fastest run is reported")
+  parser.add_argument("--timeout", type=float, default=0,
+                      help="kill a run after this many seconds")
+  parser.add_argument("--keep", action="store_true",
+                      help="keep run directories (and sim.log)")
+  parser.add_argument("-o", "--output", help="JSON output file (default "
+                                             "stdout)")
+  parser.add_argument("--baseline", help="JSON results to compare against")
+  parser.add_argument("--tolerance", type=float, default=0.05,
+                      help="allowed KIPS drop vs. baseline (default 0.05)")
+  args = parser.parse_args()
+
+  results = []
+  for spec in args.bench:
+    if ":" not in spec:
+      sys.exit("--bench expects NAME:CMD, got " + spec)
+    name, cmdline = spec.split(":", 1)
+    cmd = shlex.split(cmdline)
+    for cfg_name, base, opts in build_configs(args.configs.split(",")):
+      best = None
+      for _ in range(max(args.repeat, 1)):
+        rundir = tempfile.mkdtemp(prefix="simbench_%s_%s_" % (name, cfg_name))
+        setup_rundir(rundir, base, opts, args.max_insn)
+        res = run_once(cmd, rundir, args.timeout)
+        if not args.keep:
+          shutil.rmtree(rundir)
+        else:
+          res["rundir"] = rundir
+        if best is None or res["kips"] > best["kips"]:
+          best = res
+      best["bench"] = name
+      best["config"] = cfg_name
+      results.append(best)
+      sys.stderr.write("%-16s %-22s %10.1f KIPS %12.0f cyc/s %8d KB "
+                       "startup %.2fs\n" %
+                       (name, cfg_name, best["kips"], best["cycles_per_sec"],
+                        best["peak_rss_kb"], best["startup_sec"]))
+
+  regressions = []
+  if args.baseline:
+    with open(args.baseline) as f:
+      regressions = compare(results, json.load(f), args.tolerance)
+
+  report = {
+      "host": os.uname()[1],
+      "timestamp": int(time.time()),
+      "max_insn": args.max_insn,
+      "results": results,
+  }
+  if args.output:
+    with open(args.output, "w") as f:
+      json.dump(report, f, indent=2)
+  else:
+    json.dump(report, sys.stdout, indent=2)
+    sys.stdout.write("\n")
+
+  for r in regressions:
+    sys.stderr.write("REGRESSION %s %s: %.1f KIPS vs. %.1f baseline\n" %
+                     (r["bench"], r["config"], r["kips"], r["baseline_kips"]))
+  failed = [r for r in results if r["exit_status"] != 0]
+  return 1 if regressions or failed else 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())
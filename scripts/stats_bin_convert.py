@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+#
+# Convert the binary statistics stream written with -gpgpu_stats_binary_file
+# (see src/gpgpu-sim/stats_registry.h) or the DRAM/PIM time series written
+# with -gpgpu_mem_sample_interval (see src/gpgpu-sim/mem_timeseries.h) to CSV
+# or JSON.
+#
+# CSV output has one row per record.  Vector and matrix counters are expanded
+# into one column per element (name[i] or name[row][col]).  JSON output keeps
+# them as (nested) lists.
+#
+# Example:
+#   scripts/stats_bin_convert.py stats.bin --format csv -o stats.csv
+#   scripts/stats_bin_convert.py stats.bin --format json --match 'dram\['
+#   scripts/stats_bin_convert.py stats.bin --list
+#   scripts/stats_bin_convert.py mem_timeseries.bin --format csv
+
+import argparse
+import csv
+import json
+import re
+import struct
+import sys
+
+MAGIC = b"GSIMSTAT"
+TS_MAGIC = b"GSIMTSER"
+TS_HEADER_BYTES = 4096
+TS_NAME_LEN = 32
+KINDS = [("I", 4), ("Q", 8), ("q", 8), ("d", 8)]  # u32, u64, i64, f64
+RECORD_TYPES = {1: "kernel", 2: "sample"}
+
+
+def read_stats(path):
+  with open(path, "rb") as f:
+    data = f.read()
+  if data[:8] != MAGIC:
+    sys.exit("%s: not a GPGPU-Sim binary stats file" % path)
+  bo = "<"
+  version, bom = struct.unpack_from("<II", data, 8)
+  if bom != 0x01020304:
+    bo = ">"
+    version, bom = struct.unpack_from(">II", data, 8)
+  if version != 1:
+    sys.exit("%s: unsupported version %d" % (path, version))
+  n_entries, record_size = struct.unpack_from(bo + "IQ", data, 16)
+
+  pos = 28
+  entries = []
+  for _ in range(n_entries):
+    (name_len,) = struct.unpack_from(bo + "I", data, pos)
+    pos += 4
+    name = data[pos:pos + name_len].decode()
+    pos += name_len
+    kind, count, cols, offset = struct.unpack_from(bo + "IIIQ", data, pos)
+    pos += 20
+    entries.append((name, kind, count, cols, offset))
+
+  records = []
+  while pos + record_size <= len(data):
+    rtype, index, cycle, insn = struct.unpack_from(bo + "IIQQ", data, pos)
+    values = {}
+    for name, kind, count, cols, offset in entries:
+      fmt, _ = KINDS[kind]
+      vals = list(struct.unpack_from(bo + fmt * count, data, pos + offset))
+      if count == 1:
+        values[name] = vals[0]
+      elif cols:
+        values[name] = [vals[i:i + cols] for i in range(0, count, cols)]
+      else:
+        values[name] = vals
+    records.append({"type": RECORD_TYPES.get(rtype, rtype), "index": index,
+                    "cycle": cycle, "insn": insn, "stats": values})
+    pos += record_size
+  return entries, records
+
+
+def read_timeseries(path):
+  with open(path, "rb") as f:
+    data = f.read()
+  bo = "<"
+  version, bom = struct.unpack_from("<II", data, 8)
+  if bom != 0x01020304:
+    bo = ">"
+    version, bom = struct.unpack_from(">II", data, 8)
+  n_cols, block_rows, block_bytes = struct.unpack_from(bo + "IIQ", data, 16)
+  names = []
+  for c in range(n_cols):
+    raw = data[32 + c * TS_NAME_LEN:32 + (c + 1) * TS_NAME_LEN]
+    name = raw.split(b"\0", 1)[0].decode()
+    names.append(name[3:].lower() if name.startswith("TS_") else name)
+
+  rows = []
+  pos = TS_HEADER_BYTES
+  while pos + 16 <= len(data):
+    (n_rows,) = struct.unpack_from(bo + "Q", data, pos)
+    cols = []
+    for c in range(n_cols):
+      off = pos + 16 + c * block_rows * 8
+      cols.append(struct.unpack_from(bo + "d" * n_rows, data, off))
+    for r in range(n_rows):
+      row = {}
+      for c in range(n_cols):
+        v = cols[c][r]
+        row[names[c]] = int(v) if v == int(v) else v
+      rows.append(row)
+    pos += block_bytes
+  return names, rows
+
+
+def convert_timeseries(args, out):
+  names, rows = read_timeseries(args.file)
+  if args.list:
+    for n in names:
+      out.write(n + "\n")
+  elif args.format == "json":
+    json.dump(rows, out, indent=1)
+    out.write("\n")
+  else:
+    writer = csv.DictWriter(out, fieldnames=names)
+    writer.writeheader()
+    writer.writerows(rows)
+  return 0
+
+
+def flatten(name, value):
+  if not isinstance(value, list):
+    return [(name, value)]
+  out = []
+  for i, v in enumerate(value):
+    out.extend(flatten("%s[%d]" % (name, i), v))
+  return out
+
+
+def main():
+  parser = argparse.ArgumentParser(
+      description="Convert GPGPU-Sim binary statistics to CSV or JSON.")
+  parser.add_argument("file")
+  parser.add_argument("--format", choices=["csv", "json"], default="csv")
+  parser.add_argument("--match", help="only keep counters matching this regex")
+  parser.add_argument("--type", choices=["kernel", "sample"],
+                      help="only keep records of this type")
+  parser.add_argument("--list", action="store_true",
+                      help="list the registered counters and exit")
+  parser.add_argument("-o", "--output", help="output file (default stdout)")
+  args = parser.parse_args()
+
+  with open(args.file, "rb") as f:
+    magic = f.read(8)
+  if magic == TS_MAGIC:
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    return convert_timeseries(args, out)
+
+  entries, records = read_stats(args.file)
+  if args.list:
+    for name, kind, count, cols, _ in entries:
+      shape = "%dx%d" % (count // cols, cols) if cols else str(count)
+      print("%-48s %-4s %s" % (name, ["u32", "u64", "i64", "f64"][kind],
+                               shape))
+    return 0
+
+  if args.match:
+    pat = re.compile(args.match)
+    for r in records:
+      r["stats"] = {k: v for k, v in r["stats"].items() if pat.search(k)}
+  if args.type:
+    records = [r for r in records if r["type"] == args.type]
+
+  out = open(args.output, "w", newline="") if args.output else sys.stdout
+  if args.format == "json":
+    json.dump(records, out, indent=1)
+    out.write("\n")
+  else:
+    writer = csv.writer(out)
+    header = None
+    for r in records:
+      cols = [("type", r["type"]), ("index", r["index"]),
+              ("cycle", r["cycle"]), ("insn", r["insn"])]
+      for name, _, _, _, _ in entries:
+        if name in r["stats"]:
+          cols.extend(flatten(name, r["stats"][name]))
+      if header is None:
+        header = [c[0] for c in cols]
+        writer.writerow(header)
+      writer.writerow([c[1] for c in cols])
+  return 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())
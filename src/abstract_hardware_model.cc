@@ -173,6 +173,49 @@ void gpgpu_functional_sim_config::ptx_set_tex_cache_linesize(
   m_texcache_linesize = linesize;
 }
 
+// The generic windows used to be fixed at Volta sizes (80 SMs, 2048
+// threads/SM, 96kB shared memory/SM).  They never shrink below that, so
+// configs that fit keep the addresses they always had.
+static const unsigned VOLTA_N_SM = 80;
+static const unsigned VOLTA_THREAD_PER_SM = 1 << 11;
+static const unsigned long long VOLTA_SHARED_MEM_SIZE = 96 * (1 << 10);
+// Room kept below the local windows for the statics of the .ptx files
+static const unsigned long long MIN_STATIC_ALLOC_SIZE = 1 << 28;
+
+generic_memory_layout g_generic_mem_layout;
+
+generic_memory_layout::generic_memory_layout() {
+  init(VOLTA_N_SM, VOLTA_THREAD_PER_SM, VOLTA_SHARED_MEM_SIZE, 1 << 14);
+}
+
+void generic_memory_layout::init(unsigned n_sm, unsigned n_thread_per_sm,
+                                 unsigned long long shared_mem_size,
+                                 unsigned long long local_mem_size) {
+  this->n_sm = std::max(n_sm, VOLTA_N_SM);
+  this->n_thread_per_sm = std::max(n_thread_per_sm, VOLTA_THREAD_PER_SM);
+  shared_mem_size_max = std::max(shared_mem_size, VOLTA_SHARED_MEM_SIZE);
+  local_mem_size_max = local_mem_size;
+
+  total_local_mem_per_sm = this->n_thread_per_sm * local_mem_size_max;
+  unsigned long long total_shared_mem = this->n_sm * shared_mem_size_max;
+  unsigned long long total_local_mem = this->n_sm * total_local_mem_per_sm;
+  if (total_shared_mem + total_local_mem + MIN_STATIC_ALLOC_SIZE >
+      GLOBAL_HEAP_START) {
+    printf(
+        "GPGPU-Sim uArch: Error ** generic address space overflow: %u SMs x "
+        "(%llukB shared + %u threads x %llukB local) does not fit below "
+        "0x%llx with %llukB left for statics; reduce "
+        "-gpgpu_local_mem_size_max\n",
+        this->n_sm, shared_mem_size_max >> 10, this->n_thread_per_sm,
+        local_mem_size_max >> 10, GLOBAL_HEAP_START,
+        MIN_STATIC_ALLOC_SIZE >> 10);
+    abort();
+  }
+  shared_generic_start = GLOBAL_HEAP_START - total_shared_mem;
+  local_generic_start = shared_generic_start - total_local_mem;
+  static_alloc_limit = local_generic_start;
+}
+
 gpgpu_t::gpgpu_t(const gpgpu_functional_sim_config &config, gpgpu_context *ctx)
     : m_function_model_config(config) {
   gpgpu_ctx = ctx;
@@ -451,7 +494,7 @@ void warp_inst_t::generate_mem_accesses() {
       unsigned block_address = line_size_based_tag_func(addr, cache_block_size);
       accesses[block_address].set(thread);
       unsigned idx = addr - block_address;
-      for (unsigned i = 0; i < data_size; i++) byte_mask.set(idx + i);
+      byte_mask |= transaction_info::byte_range(idx, data_size);
     }
     for (a = accesses.begin(); a != accesses.end(); ++a)
       m_accessq.push_back(mem_access_t(
@@ -466,6 +509,18 @@ void warp_inst_t::generate_mem_accesses() {
   m_mem_accesses_created = true;
 }
 
+// Sort key for one segment touched by one thread: the segment's block
+// address, then the lane, then the byte offset within the 128B chunk.
+static inline unsigned long long coalescing_key(unsigned block_address,
+                                                unsigned thread,
+                                                new_addr_type addr) {
+  return ((unsigned long long)block_address << 16) | (thread << 8) |
+         (addr & 127);
+}
+static inline new_addr_type coalescing_key_block(unsigned long long key) {
+  return key >> 16;
+}
+
 void warp_inst_t::memory_coalescing_arch(bool is_write,
                                          mem_access_type access_type) {
   // see the CUDA manual where it discusses coalescing rules before reading this
@@ -501,75 +556,66 @@ void warp_inst_t::memory_coalescing_arch(bool is_write,
   }
   unsigned subwarp_size = m_config->warp_size / warp_parts;
 
+  unsigned data_size_coales = data_size;
+  if (space.get_type() == local_space ||
+      space.get_type() == param_space_local) {
+    // Local memory accesses >4B were split into 4B chunks
+    if (data_size >= 4) data_size_coales = 4;
+    // Otherwise keep the same data_size for sub-4B access to local memory
+  }
+  assert(data_size / data_size_coales <= MAX_ACCESSES_PER_INSN_PER_THREAD);
+
+  // Each (thread, access) touches at most two segments.  Rather than keying a
+  // std::map by segment, collect one sort key per segment touch:
+  //   [block address | thread | byte offset within the 128B chunk]
+  // then sort the keys and fold each run with the same block address into a
+  // single transaction.  Runs come out in ascending block address order, the
+  // same order the map used to produce.
+  unsigned long long keys[MAX_WARP_SIZE * MAX_ACCESSES_PER_INSN_PER_THREAD * 2];
+
   for (unsigned subwarp = 0; subwarp < warp_parts; subwarp++) {
-    std::map<new_addr_type, transaction_info> subwarp_transactions;
+    unsigned n_keys = 0;
 
     // step 1: find all transactions generated by this subwarp
     for (unsigned thread = subwarp * subwarp_size;
          thread < subwarp_size * (subwarp + 1); thread++) {
       if (!active(thread)) continue;
 
-      unsigned data_size_coales = data_size;
-      unsigned num_accesses = 1;
-
-      if (space.get_type() == local_space ||
-          space.get_type() == param_space_local) {
-        // Local memory accesses >4B were split into 4B chunks
-        if (data_size >= 4) {
-          data_size_coales = 4;
-          num_accesses = data_size / 4;
-        }
-        // Otherwise keep the same data_size for sub-4B access to local memory
-      }
-
-      assert(num_accesses <= MAX_ACCESSES_PER_INSN_PER_THREAD);
-
-      //            for(unsigned access=0; access<num_accesses; access++) {
       for (unsigned access = 0;
            (access < MAX_ACCESSES_PER_INSN_PER_THREAD) &&
            (m_per_scalar_thread[thread].memreqaddr[access] != 0);
            access++) {
         new_addr_type addr = m_per_scalar_thread[thread].memreqaddr[access];
         unsigned block_address = line_size_based_tag_func(addr, segment_size);
-        unsigned chunk =
-            (addr & 127) / 32;  // which 32-byte chunk within in a 128-byte
-                                // chunk does this thread access?
-        transaction_info &info = subwarp_transactions[block_address];
-
-        // can only write to one segment
-        // it seems like in trace driven, a thread can write to more than one
-        // segment assert(block_address ==
-        // line_size_based_tag_func(addr+data_size_coales-1,segment_size));
-
-        info.chunks.set(chunk);
-        info.active.set(thread);
-        unsigned idx = (addr & 127);
-        for (unsigned i = 0; i < data_size_coales; i++)
-          if ((idx + i) < MAX_MEMORY_ACCESS_SIZE) info.bytes.set(idx + i);
+        keys[n_keys++] = coalescing_key(block_address, thread, addr);
 
         // it seems like in trace driven, a thread can write to more than one
         // segment handle this special case
         if (block_address != line_size_based_tag_func(
                                  addr + data_size_coales - 1, segment_size)) {
           addr = addr + data_size_coales - 1;
-          unsigned block_address = line_size_based_tag_func(addr, segment_size);
-          unsigned chunk = (addr & 127) / 32;
-          transaction_info &info = subwarp_transactions[block_address];
-          info.chunks.set(chunk);
-          info.active.set(thread);
-          unsigned idx = (addr & 127);
-          for (unsigned i = 0; i < data_size_coales; i++)
-            if ((idx + i) < MAX_MEMORY_ACCESS_SIZE) info.bytes.set(idx + i);
+          block_address = line_size_based_tag_func(addr, segment_size);
+          keys[n_keys++] = coalescing_key(block_address, thread, addr);
         }
       }
     }
 
-    // step 2: reduce each transaction size, if possible
-    std::map<new_addr_type, transaction_info>::iterator t;
-    for (t = subwarp_transactions.begin(); t != subwarp_transactions.end();
-         t++) {
-      new_addr_type addr = t->first;
-      const transaction_info &info = t->second;
+    // coalesced warps usually generate keys in order already
+    if (!std::is_sorted(keys, keys + n_keys)) std::sort(keys, keys + n_keys);
+
+    // step 2: build each transaction and reduce its size, if possible
+    const mem_access_byte_mask_t lane_bytes =
+        transaction_info::byte_range(0, data_size_coales);
+    for (unsigned k = 0; k < n_keys;) {
+      new_addr_type addr = coalescing_key_block(keys[k]);
+      transaction_info info;
+      for (; k < n_keys && coalescing_key_block(keys[k]) == addr; k++) {
+        unsigned idx = keys[k] & 127;
+        info.chunks.set(idx / 32);  // which 32-byte chunk within in a 128-byte
+                                    // chunk does this thread access?
+        info.active.set((keys[k] >> 8) & 0xff);
+        info.bytes |= lane_bytes << idx;
+      }
 
       memory_coalescing_arch_reduce_and_send(is_write, access_type, info, addr,
                                              segment_size);
@@ -615,9 +661,14 @@ void warp_inst_t::memory_coalescing_arch_atomic(bool is_write,
   }
   unsigned subwarp_size = m_config->warp_size / warp_parts;
 
+  // Every thread joins an existing transaction or opens a new one, so a
+  // subwarp never has more transactions than threads.
+  transaction_info transactions[MAX_WARP_SIZE];
+  unsigned blocks[MAX_WARP_SIZE];
+  unsigned order[MAX_WARP_SIZE];
+
   for (unsigned subwarp = 0; subwarp < warp_parts; subwarp++) {
-    std::map<new_addr_type, std::list<transaction_info> >
-        subwarp_transactions;  // each block addr maps to a list of transactions
+    unsigned n_transactions = 0;
 
     // step 1: find all transactions generated by this subwarp
     for (unsigned thread = subwarp * subwarp_size;
@@ -635,49 +686,45 @@ void warp_inst_t::memory_coalescing_arch_atomic(bool is_write,
              line_size_based_tag_func(addr + data_size - 1, segment_size));
 
       // Find a transaction that does not conflict with this thread's accesses
-      bool new_transaction = true;
-      std::list<transaction_info>::iterator it;
-      transaction_info *info;
-      for (it = subwarp_transactions[block_address].begin();
-           it != subwarp_transactions[block_address].end(); it++) {
-        unsigned idx = (addr & 127);
-        if (not it->test_bytes(idx, idx + data_size - 1)) {
-          new_transaction = false;
-          info = &(*it);
+      unsigned idx = (addr & 127);
+      mem_access_byte_mask_t bytes =
+          transaction_info::byte_range(idx, data_size);
+      transaction_info *info = NULL;
+      for (unsigned t = 0; t < n_transactions; t++) {
+        if (blocks[t] == block_address &&
+            (transactions[t].bytes & bytes).none()) {
+          info = &transactions[t];
           break;
         }
       }
-      if (new_transaction) {
+      if (info == NULL) {
         // Need a new transaction
-        subwarp_transactions[block_address].push_back(transaction_info());
-        info = &subwarp_transactions[block_address].back();
+        blocks[n_transactions] = block_address;
+        info = &transactions[n_transactions];
+        *info = transaction_info();
+        n_transactions++;
       }
-      assert(info);
 
       info->chunks.set(chunk);
       info->active.set(thread);
-      unsigned idx = (addr & 127);
-      for (unsigned i = 0; i < data_size; i++) {
-        assert(!info->bytes.test(idx + i));
-        info->bytes.set(idx + i);
-      }
+      info->bytes |= bytes;
     }
 
-    // step 2: reduce each transaction size, if possible
-    std::map<new_addr_type, std::list<transaction_info> >::iterator t_list;
-    for (t_list = subwarp_transactions.begin();
-         t_list != subwarp_transactions.end(); t_list++) {
-      // For each block addr
-      new_addr_type addr = t_list->first;
-      const std::list<transaction_info> &transaction_list = t_list->second;
-
-      std::list<transaction_info>::const_iterator t;
-      for (t = transaction_list.begin(); t != transaction_list.end(); t++) {
-        // For each transaction
-        const transaction_info &info = *t;
-        memory_coalescing_arch_reduce_and_send(is_write, access_type, info,
-                                               addr, segment_size);
-      }
+    // step 2: reduce each transaction size, if possible.  Transactions are
+    // sent by block address and, within a block, in the order they were
+    // opened.
+    for (unsigned t = 0; t < n_transactions; t++) order[t] = t;
+    for (unsigned t = 1; t < n_transactions; t++) {
+      unsigned o = order[t];
+      unsigned j = t;
+      for (; j > 0 && blocks[order[j - 1]] > blocks[o]; j--)
+        order[j] = order[j - 1];
+      order[j] = o;
+    }
+    for (unsigned t = 0; t < n_transactions; t++) {
+      memory_coalescing_arch_reduce_and_send(is_write, access_type,
+                                             transactions[order[t]],
+                                             blocks[order[t]], segment_size);
     }
   }
 }
@@ -928,8 +975,10 @@ simt_stack::simt_stack(unsigned wid, unsigned warpSize, class gpgpu_sim *gpu) {
 
 void simt_stack::reset() { m_stack.clear(); }
 
-void simt_stack::launch(address_type start_pc, const simt_mask_t &active_mask) {
+void simt_stack::launch(address_type start_pc, const simt_mask_t &active_mask,
+                        unsigned max_depth) {
   reset();
+  m_stack.reserve(max_depth);
   simt_stack_entry new_stack_entry;
   new_stack_entry.m_pc = start_pc;
   new_stack_entry.m_calldepth = 1;
@@ -1051,11 +1100,42 @@ void simt_stack::update(simt_mask_t &thread_done, addr_vector_t &next_pc,
   assert(top_active_mask.any());
 
   const address_type null_pc = -1;
+
+  // Fast path: the threads still running all go to the same PC, which is the
+  // common case for every non-branch instruction.  The top entry either
+  // reconverges or simply moves to the next PC.
+  if (next_inst_op != CALL_OPS &&
+      !(next_inst_op == RET_OPS && top_type == STACK_ENTRY_TYPE_CALL)) {
+    simt_mask_t live_mask = top_active_mask & ~thread_done;
+    address_type uniform_pc = null_pc;
+    bool uniform = true;
+    for (unsigned i = 0; i < m_warp_size && uniform; i++) {
+      if (!live_mask.test(i)) continue;
+      if (uniform_pc == null_pc)
+        uniform_pc = next_pc[i];
+      else
+        uniform = (next_pc[i] == uniform_pc);
+    }
+    if (uniform) {
+      if (uniform_pc == null_pc ||
+          (uniform_pc == top_recvg_pc && top_type != STACK_ENTRY_TYPE_CALL)) {
+        // all threads done, or the entry reached its reconvergence point
+        m_stack.pop_back();
+      } else {
+        m_stack.back().m_pc = uniform_pc;
+        m_stack.back().m_active_mask = live_mask;
+      }
+      return;
+    }
+  }
+
   bool warp_diverged = false;
   address_type new_recvg_pc = null_pc;
   unsigned num_divergent_paths = 0;
 
-  std::map<address_type, simt_mask_t> divergent_paths;
+  // a branch splits the warp at most two ways
+  address_type path_pc[2];
+  simt_mask_t path_mask[2];
   while (top_active_mask.any()) {
     // extract a group of threads with the same next PC among the active threads
     // in the warp
@@ -1081,28 +1161,23 @@ void simt_stack::update(simt_mask_t &thread_done, addr_vector_t &next_pc,
       continue;
     }
 
-    divergent_paths[tmp_next_pc] = tmp_active_mask;
+    assert(num_divergent_paths < 2);
+    path_pc[num_divergent_paths] = tmp_next_pc;
+    path_mask[num_divergent_paths] = tmp_active_mask;
     num_divergent_paths++;
   }
 
+  // The not-taken path is pushed first, otherwise the lower PC goes first.
   address_type not_taken_pc = next_inst_pc + next_inst_size;
-  assert(num_divergent_paths <= 2);
+  if (num_divergent_paths == 2 &&
+      (path_pc[1] == not_taken_pc ||
+       (path_pc[0] != not_taken_pc && path_pc[1] < path_pc[0]))) {
+    std::swap(path_pc[0], path_pc[1]);
+    std::swap(path_mask[0], path_mask[1]);
+  }
   for (unsigned i = 0; i < num_divergent_paths; i++) {
-    address_type tmp_next_pc = null_pc;
-    simt_mask_t tmp_active_mask;
-    tmp_active_mask.reset();
-    if (divergent_paths.find(not_taken_pc) != divergent_paths.end()) {
-      assert(i == 0);
-      tmp_next_pc = not_taken_pc;
-      tmp_active_mask = divergent_paths[tmp_next_pc];
-      divergent_paths.erase(tmp_next_pc);
-    } else {
-      std::map<address_type, simt_mask_t>::iterator it =
-          divergent_paths.begin();
-      tmp_next_pc = it->first;
-      tmp_active_mask = divergent_paths[tmp_next_pc];
-      divergent_paths.erase(tmp_next_pc);
-    }
+    address_type tmp_next_pc = path_pc[i];
+    simt_mask_t tmp_active_mask = path_mask[i];
 
     // HANDLE THE SPECIAL CASES FIRST
     if (next_inst_op == CALL_OPS) {
@@ -1200,7 +1275,8 @@ bool core_t::ptx_thread_done(unsigned hw_thread_id) const {
 
 void core_t::updateSIMTStack(unsigned warpId, warp_inst_t *inst) {
   simt_mask_t thread_done;
-  addr_vector_t next_pc;
+  addr_vector_t &next_pc = m_simt_next_pc;
+  next_pc.clear();
   unsigned wtid = warpId * m_warp_size;
   for (unsigned i = 0; i < m_warp_size; i++) {
     if (ptx_thread_done(wtid + i)) {
@@ -164,6 +164,8 @@ enum _memory_op_t { no_memory_op = 0, memory_load, memory_store };
 #include <map>
 #include <vector>
 
+#include "small_vector.h"
+
 #if !defined(__VECTOR_TYPES_H__)
 #include "vector_types.h"
 #endif
@@ -395,6 +397,18 @@ class core_config {
   unsigned gpgpu_shmem_sizeDefault;
   unsigned gpgpu_shmem_sizePrefL1;
   unsigned gpgpu_shmem_sizePrefShared;
+  // largest shared memory any of the carveout settings can give a core
+  unsigned max_shmem_size() const {
+    unsigned size = gpgpu_shmem_size;
+    if (gpgpu_shmem_sizeDefault != (unsigned)-1)
+      size = std::max(size, gpgpu_shmem_sizeDefault);
+    if (gpgpu_shmem_sizePrefL1 != (unsigned)-1)
+      size = std::max(size, gpgpu_shmem_sizePrefL1);
+    if (gpgpu_shmem_sizePrefShared != (unsigned)-1)
+      size = std::max(size, gpgpu_shmem_sizePrefShared);
+    return size;
+  }
+  unsigned gpgpu_local_mem_size_max;  // generic local window per thread
   unsigned mem_unit_ports;
 
   // texture and constant cache line sizes (used to determine number of memory
@@ -421,7 +435,10 @@ class simt_stack {
   simt_stack(unsigned wid, unsigned warpSize, class gpgpu_sim *gpu);
 
   void reset();
-  void launch(address_type start_pc, const simt_mask_t &active_mask);
+  // max_depth: expected stack depth (function_info::max_simt_stack_depth());
+  // the stack still grows past it if calls nest deeper
+  void launch(address_type start_pc, const simt_mask_t &active_mask,
+              unsigned max_depth = 1);
   void update(simt_mask_t &thread_done, addr_vector_t &next_pc,
               address_type recvg_pc, op_type next_inst_op,
               unsigned next_inst_size, address_type next_inst_pc);
@@ -439,53 +456,57 @@ class simt_stack {
 
   enum stack_entry_type { STACK_ENTRY_TYPE_NORMAL = 0, STACK_ENTRY_TYPE_CALL };
 
+  // fields ordered to avoid padding: 32 bytes per entry
   struct simt_stack_entry {
     address_type m_pc;
+    address_type m_recvg_pc;
     unsigned int m_calldepth;
+    stack_entry_type m_type;
     simt_mask_t m_active_mask;
-    address_type m_recvg_pc;
     unsigned long long m_branch_div_cycle;
-    stack_entry_type m_type;
     simt_stack_entry()
         : m_pc(-1),
+          m_recvg_pc(-1),
           m_calldepth(0),
+          m_type(STACK_ENTRY_TYPE_NORMAL),
           m_active_mask(),
-          m_recvg_pc(-1),
-          m_branch_div_cycle(0),
-          m_type(STACK_ENTRY_TYPE_NORMAL){};
+          m_branch_div_cycle(0){};
   };
 
-  std::deque<simt_stack_entry> m_stack;
+  // Storage is reserved at launch and never released by reset(), so pushes
+  // and pops in update() do not allocate once a warp has run.
+  std::vector<simt_stack_entry> m_stack;
 
   class gpgpu_sim *m_gpu;
 };
 
-// Let's just upgrade to C++11 so we can use constexpr here...
 // start allocating from this address (lower values used for allocating globals
 // in .ptx file)
 const unsigned long long GLOBAL_HEAP_START = 0xC0000000;
-// Volta max shmem size is 96kB
-const unsigned long long SHARED_MEM_SIZE_MAX = 96 * (1 << 10);
-// Volta max local mem is 16kB
-const unsigned long long LOCAL_MEM_SIZE_MAX = 1 << 14;
-// Volta Titan V has 80 SMs
-const unsigned MAX_STREAMING_MULTIPROCESSORS = 80;
-// Max 2048 threads / SM
-const unsigned MAX_THREAD_PER_SM = 1 << 11;
 // MAX 64 warps / SM
 const unsigned MAX_WARP_PER_SM = 1 << 6;
-const unsigned long long TOTAL_LOCAL_MEM_PER_SM =
-    MAX_THREAD_PER_SM * LOCAL_MEM_SIZE_MAX;
-const unsigned long long TOTAL_SHARED_MEM =
-    MAX_STREAMING_MULTIPROCESSORS * SHARED_MEM_SIZE_MAX;
-const unsigned long long TOTAL_LOCAL_MEM =
-    MAX_STREAMING_MULTIPROCESSORS * MAX_THREAD_PER_SM * LOCAL_MEM_SIZE_MAX;
-const unsigned long long SHARED_GENERIC_START =
-    GLOBAL_HEAP_START - TOTAL_SHARED_MEM;
-const unsigned long long LOCAL_GENERIC_START =
-    SHARED_GENERIC_START - TOTAL_LOCAL_MEM;
-const unsigned long long STATIC_ALLOC_LIMIT =
-    GLOBAL_HEAP_START - (TOTAL_LOCAL_MEM + TOTAL_SHARED_MEM);
+
+// Generic address space below GLOBAL_HEAP_START.  From the top down: one
+// shared memory window per SM, one local memory window per hardware thread,
+// then the statics of the .ptx files (up to static_alloc_limit).  The window
+// sizes come from the shader config (see init()); the functional model's
+// addresses are 32 bits wide, so init() aborts if they do not fit.
+struct generic_memory_layout {
+  generic_memory_layout();
+  void init(unsigned n_sm, unsigned n_thread_per_sm,
+            unsigned long long shared_mem_size,
+            unsigned long long local_mem_size);
+
+  unsigned n_sm;
+  unsigned n_thread_per_sm;
+  unsigned long long shared_mem_size_max;  // per SM
+  unsigned long long local_mem_size_max;   // per hardware thread
+  unsigned long long total_local_mem_per_sm;
+  unsigned long long shared_generic_start;
+  unsigned long long local_generic_start;
+  unsigned long long static_alloc_limit;
+};
+extern generic_memory_layout g_generic_mem_layout;
 
 #if !defined(__CUDA_RUNTIME_API_H__)
 
@@ -753,8 +774,8 @@ typedef std::bitset<SECTOR_CHUNCK_SIZE> mem_access_sector_mask_t;
   MA_TUP(GLOBAL_ACC_R), MA_TUP(LOCAL_ACC_R), MA_TUP(CONST_ACC_R),       \
       MA_TUP(TEXTURE_ACC_R), MA_TUP(GLOBAL_ACC_W), MA_TUP(LOCAL_ACC_W), \
       MA_TUP(L1_WRBK_ACC), MA_TUP(L2_WRBK_ACC), MA_TUP(INST_ACC_R),     \
-      MA_TUP(L1_WR_ALLOC_R), MA_TUP(L2_WR_ALLOC_R),                     \
-      MA_TUP(NUM_MEM_ACCESS_TYPE) MA_TUP_END(mem_access_type)
+      MA_TUP(L1_WR_ALLOC_R), MA_TUP(L2_WR_ALLOC_R), MA_TUP(L1_PREF_R),  \
+      MA_TUP(L2_PREF_R), MA_TUP(NUM_MEM_ACCESS_TYPE) MA_TUP_END(mem_access_type)
 
 #define MA_TUP_BEGIN(X) enum X {
 #define MA_TUP(X) X
@@ -1067,7 +1088,7 @@ class warp_inst_t : public inst_t {
       return;
     else {
       printf("Printing mem access generated\n");
-      std::list<mem_access_t>::iterator it;
+      mem_access_queue_t::iterator it;
       for (it = m_accessq.begin(); it != m_accessq.end(); ++it) {
         printf("MEM_TXN_GEN:%s:%llx, Size:%d \n",
                mem_access_type_str(it->get_type()), it->get_addr(),
@@ -1080,10 +1101,13 @@ class warp_inst_t : public inst_t {
     mem_access_byte_mask_t bytes;
     active_mask_t active;  // threads in this transaction
 
-    bool test_bytes(unsigned start_bit, unsigned end_bit) {
-      for (unsigned i = start_bit; i <= end_bit; i++)
-        if (bytes.test(i)) return true;
-      return false;
+    bool test_bytes(unsigned start_bit, unsigned end_bit) const {
+      return (bytes & byte_range(start_bit, end_bit - start_bit + 1)).any();
+    }
+    // bytes [start, start + len) as a mask; bytes past the end are dropped
+    static mem_access_byte_mask_t byte_range(unsigned start, unsigned len) {
+      return (~mem_access_byte_mask_t() >> (MAX_MEMORY_ACCESS_SIZE - len))
+             << start;
     }
   };
 
@@ -1208,7 +1232,10 @@ class warp_inst_t : public inst_t {
   bool m_per_scalar_thread_valid;
   std::vector<per_thread_info> m_per_scalar_thread;
   bool m_mem_accesses_created;
-  std::list<mem_access_t> m_accessq;
+  // Almost every instruction generates only a handful of accesses, so keep
+  // them inline rather than allocating a list node per access.
+  typedef small_vector<mem_access_t, 4> mem_access_queue_t;
+  mem_access_queue_t m_accessq;
 
   unsigned m_scheduler_id;  // the scheduler that issues this inst
 
@@ -1305,6 +1332,7 @@ class core_t {
   unsigned m_warp_size;
   unsigned m_warp_count;
   unsigned reduction_storage[MAX_CTA_PER_SHADER][MAX_BARRIERS_PER_CTA];
+  addr_vector_t m_simt_next_pc;  // reused by updateSIMTStack()
 };
 
 // register that can hold multiple instructions.
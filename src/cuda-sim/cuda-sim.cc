@@ -381,27 +381,31 @@ void function_info::ptx_assemble() {
 }
 
 addr_t shared_to_generic(unsigned smid, addr_t addr) {
-  assert(addr < SHARED_MEM_SIZE_MAX);
-  return SHARED_GENERIC_START + smid * SHARED_MEM_SIZE_MAX + addr;
+  const generic_memory_layout &l = g_generic_mem_layout;
+  assert(addr < l.shared_mem_size_max);
+  return l.shared_generic_start + smid * l.shared_mem_size_max + addr;
 }
 
 addr_t global_to_generic(addr_t addr) { return addr; }
 
 bool isspace_shared(unsigned smid, addr_t addr) {
-  addr_t start = SHARED_GENERIC_START + smid * SHARED_MEM_SIZE_MAX;
-  addr_t end = SHARED_GENERIC_START + (smid + 1) * SHARED_MEM_SIZE_MAX;
+  const generic_memory_layout &l = g_generic_mem_layout;
+  addr_t start = l.shared_generic_start + smid * l.shared_mem_size_max;
+  addr_t end = l.shared_generic_start + (smid + 1) * l.shared_mem_size_max;
   if ((addr >= end) || (addr < start)) return false;
   return true;
 }
 
 bool isspace_global(addr_t addr) {
-  return (addr >= GLOBAL_HEAP_START) || (addr < STATIC_ALLOC_LIMIT);
+  return (addr >= GLOBAL_HEAP_START) ||
+         (addr < g_generic_mem_layout.static_alloc_limit);
 }
 
 memory_space_t whichspace(addr_t addr) {
-  if ((addr >= GLOBAL_HEAP_START) || (addr < STATIC_ALLOC_LIMIT)) {
+  if ((addr >= GLOBAL_HEAP_START) ||
+      (addr < g_generic_mem_layout.static_alloc_limit)) {
     return global_space;
-  } else if (addr >= SHARED_GENERIC_START) {
+  } else if (addr >= g_generic_mem_layout.shared_generic_start) {
     return shared_space;
   } else {
     return local_space;
@@ -410,28 +414,32 @@ memory_space_t whichspace(addr_t addr) {
 
 addr_t generic_to_shared(unsigned smid, addr_t addr) {
   assert(isspace_shared(smid, addr));
-  return addr - (SHARED_GENERIC_START + smid * SHARED_MEM_SIZE_MAX);
+  const generic_memory_layout &l = g_generic_mem_layout;
+  return addr - (l.shared_generic_start + smid * l.shared_mem_size_max);
 }
 
 addr_t local_to_generic(unsigned smid, unsigned hwtid, addr_t addr) {
-  assert(addr < LOCAL_MEM_SIZE_MAX);
-  return LOCAL_GENERIC_START + (TOTAL_LOCAL_MEM_PER_SM * smid) +
-         (LOCAL_MEM_SIZE_MAX * hwtid) + addr;
+  const generic_memory_layout &l = g_generic_mem_layout;
+  assert(addr < l.local_mem_size_max);
+  return l.local_generic_start + (l.total_local_mem_per_sm * smid) +
+         (l.local_mem_size_max * hwtid) + addr;
 }
 
 bool isspace_local(unsigned smid, unsigned hwtid, addr_t addr) {
-  addr_t start = LOCAL_GENERIC_START + (TOTAL_LOCAL_MEM_PER_SM * smid) +
-                 (LOCAL_MEM_SIZE_MAX * hwtid);
-  addr_t end = LOCAL_GENERIC_START + (TOTAL_LOCAL_MEM_PER_SM * smid) +
-               (LOCAL_MEM_SIZE_MAX * (hwtid + 1));
+  const generic_memory_layout &l = g_generic_mem_layout;
+  addr_t start = l.local_generic_start + (l.total_local_mem_per_sm * smid) +
+                 (l.local_mem_size_max * hwtid);
+  addr_t end = l.local_generic_start + (l.total_local_mem_per_sm * smid) +
+               (l.local_mem_size_max * (hwtid + 1));
   if ((addr >= end) || (addr < start)) return false;
   return true;
 }
 
 addr_t generic_to_local(unsigned smid, unsigned hwtid, addr_t addr) {
   assert(isspace_local(smid, hwtid, addr));
-  return addr - (LOCAL_GENERIC_START + (TOTAL_LOCAL_MEM_PER_SM * smid) +
-                 (LOCAL_MEM_SIZE_MAX * hwtid));
+  const generic_memory_layout &l = g_generic_mem_layout;
+  return addr - (l.local_generic_start + (l.total_local_mem_per_sm * smid) +
+                 (l.local_mem_size_max * hwtid));
 }
 
 addr_t generic_to_global(addr_t addr) { return addr; }
@@ -1825,9 +1833,9 @@ void ptx_thread_info::ptx_exec_inst(warp_inst_t &inst, unsigned lane_id) {
       if (!((inst_opcode == MMA_LD_OP || inst_opcode == MMA_ST_OP))) {
         insn_memaddr = last_eaddr();
         insn_space = last_space();
-        unsigned to_type = pI->get_type();
-        insn_data_size = datatype2size(to_type);
-        insn_memory_op = pI->has_memory_read() ? memory_load : memory_store;
+        // static part decoded once per instruction by pre_decode()
+        insn_data_size = pI->data_size;
+        insn_memory_op = pI->memory_op;
       }
     }
 
@@ -2081,7 +2089,9 @@ unsigned ptx_sim_init_thread(kernel_info_t &kernel,
     } else {
       char buf[512];
       snprintf(buf, 512, "local_%u_%u", sid, new_tid);
-      local_mem = new memory_space_impl<32>(buf, 32);
+      // no buckets until the thread first touches local memory; untouched
+      // locations read as zero
+      local_mem = new memory_space_impl<32>(buf, 0);
       local_mem_lookup[new_tid] = local_mem;
     }
     thd->set_info(kernel.entry());
@@ -2542,7 +2552,8 @@ void functionalCoreSim::createWarp(unsigned warpId) {
 
   assert(m_thread[warpId * m_warp_size] != NULL);
   m_simt_stack[warpId]->launch(m_thread[warpId * m_warp_size]->get_pc(),
-                               initialMask);
+                               initialMask,
+                               m_kernel->entry()->max_simt_stack_depth());
   char fname[2048];
   snprintf(fname, 2048, "checkpoint_files/warp_%d_0_simt.txt", warpId);
 
@@ -44,13 +44,6 @@ typedef void *yyscan_t;
 
 #define STR_SIZE 1024
 
-const ptx_instruction *gpgpu_context::pc_to_instruction(unsigned pc) {
-  if (pc < s_g_pc_to_insn.size())
-    return s_g_pc_to_insn[pc];
-  else
-    return NULL;
-}
-
 unsigned symbol::get_uid() {
   unsigned result = (gpgpu_ctx->symbol_sm_next_uid)++;
   return result;
@@ -622,6 +615,7 @@ void function_info::do_pdom() {
   }
   find_postdominators();
   find_ipostdominators();
+  find_max_simt_stack_depth();
   if (g_debug_execution >= 50) {
     print_postdominators();
     print_ipostdominators();
@@ -906,6 +900,37 @@ unsigned function_info::get_num_reconvergence_pairs() {
   return num_reconvergence_pairs;
 }
 
+void function_info::find_max_simt_stack_depth() {
+  // A divergent branch turns the stack top into the reconvergence entry and
+  // pushes one entry per path, so every branch region [branch, ipdom) that is
+  // still open adds at most two entries.  Backward branches reconverge at the
+  // loop exit and are covered by the regions of the branches inside the loop.
+  std::vector<std::pair<unsigned, int> > events;
+  for (unsigned i = 0; i + 1 < m_basic_blocks.size(); i++) {
+    const basic_block_t *bb = m_basic_blocks[i];
+    if (bb->ptx_end->get_opcode() != BRA_OP) continue;
+    if (bb->immediatepostdominator_id < 0) continue;
+    const ptx_instruction *recvg =
+        m_basic_blocks[bb->immediatepostdominator_id]->ptx_begin;
+    if (recvg == NULL) continue;  // reconverges at function return
+    unsigned branch_pc = bb->ptx_end->get_PC();
+    unsigned recvg_pc = recvg->get_PC();
+    if (recvg_pc <= branch_pc) continue;
+    events.push_back(std::make_pair(branch_pc, 1));
+    events.push_back(std::make_pair(recvg_pc, -1));
+  }
+  // closing events sort before opening ones at the same pc
+  std::sort(events.begin(), events.end());
+
+  int open_regions = 0;
+  int max_open_regions = 0;
+  for (unsigned i = 0; i < events.size(); i++) {
+    open_regions += events[i].second;
+    max_open_regions = std::max(max_open_regions, open_regions);
+  }
+  m_max_simt_stack_depth = 1 + 2 * max_open_regions;
+}
+
 void function_info::get_reconvergence_pairs(gpgpu_recon_t *recon_points) {
   unsigned idx = 0;  // array index
   if (m_basic_blocks.size() == 0) return;
@@ -1496,6 +1521,7 @@ function_info::function_info(int entry_point, gpgpu_context *ctx) {
   m_local_mem_framesize = 0;
   m_args_aligned_size = -1;
   pdom_done = false;  // initialize it to false
+  m_max_simt_stack_depth = 1;
 }
 
 unsigned function_info::print_insn(unsigned pc, FILE *fp) const {
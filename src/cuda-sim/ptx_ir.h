@@ -1293,6 +1293,9 @@ class function_info {
   // Muchnick's Adv. Compiler Design & Implemmntation Fig 7.15
   void find_ipostdominators();
   void print_ipostdominators();
+  // bound on the SIMT stack depth a warp needs without calls, from the
+  // nesting of branch-to-reconvergence regions
+  void find_max_simt_stack_depth();
   void do_pdom();  // function to call pdom analysis
 
   unsigned get_num_reconvergence_pairs();
@@ -1358,6 +1361,7 @@ class function_info {
   bool is_entry_point() const { return m_entry_point; }
   bool is_pdom_set() const { return pdom_done; }  // return pdom flag
   void set_pdom() { pdom_done = true; }           // set pdom flag
+  unsigned max_simt_stack_depth() const { return m_max_simt_stack_depth; }
 
   void add_config_param(size_t size, unsigned alignment) {
     unsigned offset = 0;
@@ -1393,6 +1397,7 @@ class function_info {
   bool m_extern;
   bool m_assembled;
   bool pdom_done;  // flag to check whether pdom is completed or not
+  unsigned m_max_simt_stack_depth;
   std::string m_name;
   ptx_instruction **m_instr_mem;
   unsigned m_start_PC;
@@ -41,6 +41,7 @@ static new_addr_type addrdec_packbits(new_addr_type mask, new_addr_type val,
                                       unsigned char high, unsigned char low);
 static void addrdec_getmasklimit(new_addr_type mask, unsigned char *high,
                                  unsigned char *low);
+static unsigned addrdec_nbits(new_addr_type mask);
 
 linear_to_raw_address_translation::linear_to_raw_address_translation() {
   addrdec_option = NULL;
@@ -52,6 +53,9 @@ linear_to_raw_address_translation::linear_to_raw_address_translation() {
   addrdec_mask[2] = 0x000000000FFF0000;
   addrdec_mask[3] = 0x000000000000E0FF;
   addrdec_mask[4] = 0x000000000000000F;
+  m_pim_addr_mapping = false;
+  m_pim_row_base = 0;
+  m_pim_next_row = 0;
 }
 
 void linear_to_raw_address_translation::addrdec_setoption(option_parser_t opp) {
@@ -73,10 +77,72 @@ void linear_to_raw_address_translation::addrdec_setoption(option_parser_t opp) {
       &memory_partition_indexing,
       "0 = no indexing, 1 = bitwise xoring, 2 = IPoly, 3 = custom indexing",
       "0");
+  option_parser_register(
+      opp, "-gpgpu_pim_addr_mapping", OPT_BOOL, &m_pim_addr_mapping,
+      "lay out cudaMallocPIM regions so that each operand tile fills one row "
+      "of every bank of a channel",
+      "0");
+  option_parser_register(
+      opp, "-gpgpu_pim_row_base", OPT_UINT32, &m_pim_row_base,
+      "first DRAM row used by PIM regions (rows are shared with the generic "
+      "mapping, which only affects row buffer timing)",
+      "0");
+}
+
+void linear_to_raw_address_translation::add_pim_region(
+    new_addr_type start, new_addr_type size) const {
+  if (!m_pim_addr_mapping || size == 0) return;
+  const new_addr_type tile_bytes = 1ULL << (m_pim_col_bits + m_pim_bk_bits);
+  const new_addr_type n_tiles = (size + tile_bytes - 1) / tile_bytes;
+  const unsigned n_rows = (n_tiles + m_n_channel - 1) / m_n_channel;
+  if (m_pim_next_row + n_rows > (1ULL << m_pim_row_bits)) {
+    printf("GPGPU-Sim uArch: PIM region of %llu bytes at 0x%llx does not fit "
+           "in the DRAM rows left (-gpgpu_pim_row_base %u)\n",
+           (unsigned long long)size, (unsigned long long)start,
+           m_pim_row_base);
+    abort();
+  }
+  pim_region_t &r = m_pim_regions[start];
+  r.size = size;
+  r.row_base = m_pim_next_row;
+  m_pim_next_row += n_rows;
+}
+
+bool linear_to_raw_address_translation::is_pim_region(
+    new_addr_type addr) const {
+  if (m_pim_regions.empty()) return false;
+  std::map<new_addr_type, pim_region_t>::const_iterator r =
+      m_pim_regions.upper_bound(addr);
+  if (r == m_pim_regions.begin()) return false;
+  --r;
+  return addr < r->first + r->second.size;
+}
+
+bool linear_to_raw_address_translation::pim_addrdec_tlx(
+    new_addr_type addr, addrdec_t *tlx) const {
+  std::map<new_addr_type, pim_region_t>::const_iterator r =
+      m_pim_regions.upper_bound(addr);
+  if (r == m_pim_regions.begin()) return false;
+  --r;
+  if (addr >= r->first + r->second.size) return false;
+
+  const new_addr_type ofs = addr - r->first;
+  const new_addr_type tile = ofs >> (m_pim_col_bits + m_pim_bk_bits);
+  tlx->chip = tile % m_n_channel;
+  tlx->row = r->second.row_base + tile / m_n_channel;
+  tlx->bk = (ofs >> m_pim_col_bits) & ((1ULL << m_pim_bk_bits) - 1);
+  tlx->col = ofs & ((1ULL << m_pim_col_bits) - 1);
+  tlx->burst = tlx->col & ((1ULL << m_pim_burst_bits) - 1);
+  unsigned sub_partition_addr_mask = m_n_sub_partition_in_channel - 1;
+  tlx->sub_partition = tlx->chip * m_n_sub_partition_in_channel +
+                       (tlx->bk & sub_partition_addr_mask);
+  return true;
 }
 
 new_addr_type linear_to_raw_address_translation::partition_address(
     new_addr_type addr) const {
+  // PIM region addresses are unique as they are
+  if (is_pim_region(addr)) return addr;
   if (!gap) {
     return addrdec_packbits(~(addrdec_mask[CHIP] | sub_partition_id_mask), addr,
                             64, 0);
@@ -94,6 +160,7 @@ new_addr_type linear_to_raw_address_translation::partition_address(
 
 void linear_to_raw_address_translation::addrdec_tlx(new_addr_type addr,
                                                     addrdec_t *tlx) const {
+  if (!m_pim_regions.empty() && pim_addrdec_tlx(addr, tlx)) return;
   unsigned long long int addr_for_chip, rest_of_addr, rest_of_addr_high_bits;
   if (!gap) {
     tlx->chip = addrdec_packbits(addrdec_mask[CHIP], addr, addrdec_mkhigh[CHIP],
@@ -459,6 +526,16 @@ void linear_to_raw_address_translation::init(
   }
   printf("sub_partition_id_mask = %016llx\n", sub_partition_id_mask);
 
+  m_pim_col_bits = addrdec_nbits(addrdec_mask[COL]);
+  m_pim_burst_bits = addrdec_nbits(addrdec_mask[BURST]);
+  m_pim_bk_bits = addrdec_nbits(addrdec_mask[BK]);
+  m_pim_row_bits = addrdec_nbits(addrdec_mask[ROW]);
+  m_pim_next_row = m_pim_row_base;
+  if (m_pim_addr_mapping) {
+    printf("PIM tile = %u banks x %u bytes, first row %u\n",
+           1U << m_pim_bk_bits, 1U << m_pim_col_bits, m_pim_row_base);
+  }
+
   if (run_test) {
     sweep_test();
   }
@@ -605,6 +682,12 @@ static new_addr_type addrdec_packbits(new_addr_type mask, new_addr_type val,
   return result;
 }
 
+static unsigned addrdec_nbits(new_addr_type mask) {
+  unsigned n = 0;
+  for (; mask; mask &= mask - 1) n++;
+  return n;
+}
+
 static void addrdec_getmasklimit(new_addr_type mask, unsigned char *high,
                                  unsigned char *low) {
   *high = 64;
@@ -29,6 +29,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <map>
 #include "../option_parser.h"
 
 #ifndef ADDRDEC_H
@@ -67,7 +68,15 @@ class linear_to_raw_address_translation {
   void addrdec_tlx(new_addr_type addr, addrdec_t *tlx) const;
   new_addr_type partition_address(new_addr_type addr) const;
 
+  // PIM data layout (-gpgpu_pim_addr_mapping).  Regions allocated with
+  // cudaMallocPIM are cut into operand tiles of one DRAM row per bank; tile t
+  // lives in row <region row base> + t / n_channel of every bank of channel
+  // t % n_channel.  Regions are added at allocation time, after init().
+  void add_pim_region(new_addr_type start, new_addr_type size) const;
+  bool is_pim_region(new_addr_type addr) const;
+
  private:
+  bool pim_addrdec_tlx(new_addr_type addr, addrdec_t *tlx) const;
   void addrdec_parseoption(const char *option);
   void sweep_test() const;  // sanity check to ensure no overlapping
 
@@ -91,6 +100,20 @@ class linear_to_raw_address_translation {
   unsigned log2channel;
   unsigned log2sub_partition;
   unsigned nextPowerOf2_m_n_channel;
+
+  bool m_pim_addr_mapping;
+  unsigned m_pim_row_base;
+  unsigned m_pim_col_bits;  // bytes per bank row = 1 << m_pim_col_bits
+  unsigned m_pim_burst_bits;
+  unsigned m_pim_bk_bits;
+  unsigned m_pim_row_bits;
+  struct pim_region_t {
+    new_addr_type size;
+    unsigned row_base;
+  };
+  // region start -> region, filled while the config is otherwise read-only
+  mutable std::map<new_addr_type, pim_region_t> m_pim_regions;
+  mutable unsigned m_pim_next_row;
 };
 
 #endif
@@ -0,0 +1,193 @@
+#include "chrome_trace.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include "dram.h"
+#include "mem_fetch.h"
+
+#define MF_TUP_BEGIN(X) static const char *mf_status_str[] = {
+#define MF_TUP(X) #X
+#define MF_TUP_END(X) \
+  }                   \
+  ;
+#include "mem_fetch_status.tup"
+#undef MF_TUP_BEGIN
+#undef MF_TUP
+#undef MF_TUP_END
+
+static const char *dram_mode_str[] = {"READ_MODE", "WRITE_MODE", "PIM_MODE"};
+
+// process ids of the trace tracks
+enum { TRACE_PID_REQUESTS = 1, TRACE_PID_KERNELS = 2, TRACE_PID_DRAM = 3 };
+
+static const size_t trace_buffer_bytes = 1 << 20;
+
+chrome_trace *g_chrome_trace = NULL;
+
+static void chrome_trace_atexit() {
+  if (g_chrome_trace) g_chrome_trace->close();
+}
+
+chrome_trace::chrome_trace(const char *filename, unsigned sample_period,
+                           unsigned n_channels) {
+  m_fp = fopen(filename, "w");
+  if (m_fp == NULL) {
+    printf("GPGPU-Sim uArch: cannot open trace file %s\n", filename);
+    abort();
+  }
+  m_sample_period = sample_period ? sample_period : 1;
+  m_cycle = 0;
+  m_dram_mode.resize(n_channels, READ_MODE);
+  m_dram_mode_since.resize(n_channels, 0);
+  m_buffer.reserve(trace_buffer_bytes + 1024);
+  m_done = false;
+  pthread_mutex_init(&m_lock, NULL);
+  pthread_cond_init(&m_cond, NULL);
+  pthread_create(&m_writer, NULL, writer_main, this);
+
+  char ev[256];
+  m_buffer += "[\n";
+  const char *procs[] = {"", "Memory requests", "Kernels", "DRAM modes"};
+  for (int pid = TRACE_PID_REQUESTS; pid <= TRACE_PID_DRAM; pid++)
+    emit(ev, snprintf(ev, sizeof(ev),
+                      "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+                      "\"args\":{\"name\":\"%s\"}}",
+                      pid, procs[pid]));
+  for (unsigned ch = 0; ch < n_channels; ch++)
+    emit(ev, snprintf(ev, sizeof(ev),
+                      "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+                      "\"tid\":%u,\"args\":{\"name\":\"channel %u\"}}",
+                      TRACE_PID_DRAM, ch, ch));
+  atexit(chrome_trace_atexit);
+}
+
+chrome_trace::~chrome_trace() { close(); }
+
+void chrome_trace::emit(const char *event, int len) {
+  m_buffer.append(event, len);
+  m_buffer += ",\n";
+  if (m_buffer.size() >= trace_buffer_bytes) hand_off();
+}
+
+void chrome_trace::hand_off() {
+  if (m_buffer.empty()) return;
+  std::string *full = new std::string();
+  full->reserve(trace_buffer_bytes + 1024);
+  full->swap(m_buffer);
+  pthread_mutex_lock(&m_lock);
+  m_full.push_back(full);
+  pthread_cond_signal(&m_cond);
+  pthread_mutex_unlock(&m_lock);
+}
+
+void *chrome_trace::writer_main(void *arg) {
+  chrome_trace *t = (chrome_trace *)arg;
+  pthread_mutex_lock(&t->m_lock);
+  while (true) {
+    while (t->m_full.empty() && !t->m_done)
+      pthread_cond_wait(&t->m_cond, &t->m_lock);
+    if (t->m_full.empty()) break;
+    std::string *buf = t->m_full.front();
+    t->m_full.pop_front();
+    pthread_mutex_unlock(&t->m_lock);
+    fwrite(buf->data(), 1, buf->size(), t->m_fp);
+    delete buf;
+    pthread_mutex_lock(&t->m_lock);
+  }
+  pthread_mutex_unlock(&t->m_lock);
+  fflush(t->m_fp);
+  return NULL;
+}
+
+void chrome_trace::mf_status(mem_fetch *mf, unsigned old_status,
+                             unsigned long long since,
+                             unsigned long long cycle) {
+  char ev[384];
+  const unsigned uid = mf->get_request_uid();
+  const char *cat = mf->is_pim() ? "PIM" : "MEM";
+  if (old_status == MEM_FETCH_INITIALIZED) {
+    // outer slice spanning the whole request
+    emit(ev, snprintf(ev, sizeof(ev),
+                      "{\"name\":\"%s %s\",\"cat\":\"%s\",\"ph\":\"b\","
+                      "\"id\":%u,\"pid\":%d,\"tid\":0,\"ts\":%llu,"
+                      "\"args\":{\"addr\":\"0x%llx\",\"sid\":%u,"
+                      "\"wid\":%u,\"chip\":%u,\"bank\":%u,\"row\":%u}}",
+                      cat, mf->get_is_write() ? "write" : "read", cat, uid,
+                      TRACE_PID_REQUESTS, since,
+                      (unsigned long long)mf->get_addr(), mf->get_sid(),
+                      mf->get_wid(), mf->get_tlx_addr().chip,
+                      mf->get_tlx_addr().bk, mf->get_tlx_addr().row));
+    return;
+  }
+  assert(old_status < NUM_MEM_REQ_STAT);
+  const char *name = mf_status_str[old_status];
+  emit(ev, snprintf(ev, sizeof(ev),
+                    "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"b\",\"id\":%u,"
+                    "\"pid\":%d,\"tid\":0,\"ts\":%llu}",
+                    name, cat, uid, TRACE_PID_REQUESTS, since));
+  emit(ev, snprintf(ev, sizeof(ev),
+                    "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"e\",\"id\":%u,"
+                    "\"pid\":%d,\"tid\":0,\"ts\":%llu}",
+                    name, cat, uid, TRACE_PID_REQUESTS, cycle));
+}
+
+void chrome_trace::mf_deleted(mem_fetch *mf, unsigned last_status,
+                              unsigned long long since) {
+  if (last_status == MEM_FETCH_INITIALIZED) return;  // never left the core
+  mf_status(mf, last_status, since, m_cycle);
+  char ev[256];
+  const char *cat = mf->is_pim() ? "PIM" : "MEM";
+  emit(ev, snprintf(ev, sizeof(ev),
+                    "{\"name\":\"%s %s\",\"cat\":\"%s\",\"ph\":\"e\","
+                    "\"id\":%u,\"pid\":%d,\"tid\":0,\"ts\":%llu}",
+                    cat, mf->get_is_write() ? "write" : "read", cat,
+                    mf->get_request_uid(), TRACE_PID_REQUESTS, m_cycle));
+}
+
+void chrome_trace::kernel_launch(unsigned uid, const std::string &name) {
+  char ev[512];
+  emit(ev, snprintf(ev, sizeof(ev),
+                    "{\"name\":\"%.300s\",\"cat\":\"kernel\",\"ph\":\"b\","
+                    "\"id\":%u,\"pid\":%d,\"tid\":0,\"ts\":%llu}",
+                    name.c_str(), uid, TRACE_PID_KERNELS, m_cycle));
+}
+
+void chrome_trace::kernel_done(unsigned uid, const std::string &name) {
+  char ev[512];
+  emit(ev, snprintf(ev, sizeof(ev),
+                    "{\"name\":\"%.300s\",\"cat\":\"kernel\",\"ph\":\"e\","
+                    "\"id\":%u,\"pid\":%d,\"tid\":0,\"ts\":%llu}",
+                    name.c_str(), uid, TRACE_PID_KERNELS, m_cycle));
+}
+
+// Called every DRAM cycle; a phase is written out when the mode changes.
+void chrome_trace::dram_mode(unsigned channel, unsigned mode) {
+  if (m_dram_mode[channel] == mode) return;
+  char ev[256];
+  const unsigned long long since = m_dram_mode_since[channel];
+  emit(ev, snprintf(ev, sizeof(ev),
+                    "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,"
+                    "\"ts\":%llu,\"dur\":%llu}",
+                    dram_mode_str[m_dram_mode[channel]], TRACE_PID_DRAM,
+                    channel, since, m_cycle - since));
+  m_dram_mode[channel] = mode;
+  m_dram_mode_since[channel] = m_cycle;
+}
+
+void chrome_trace::flush() { hand_off(); }
+
+void chrome_trace::close() {
+  if (m_fp == NULL) return;
+  for (unsigned ch = 0; ch < m_dram_mode.size(); ch++)
+    dram_mode(ch, (m_dram_mode[ch] + 1) % 3);  // close the open phase
+  m_buffer +=
+      "{\"name\":\"trace_end\",\"ph\":\"M\",\"pid\":0,\"args\":{}}\n]\n";
+  hand_off();
+  pthread_mutex_lock(&m_lock);
+  m_done = true;
+  pthread_cond_signal(&m_cond);
+  pthread_mutex_unlock(&m_lock);
+  pthread_join(m_writer, NULL);
+  fclose(m_fp);
+  m_fp = NULL;
+}
@@ -0,0 +1,71 @@
+#ifndef __CHROME_TRACE_H__
+#define __CHROME_TRACE_H__
+
+#include <pthread.h>
+#include <stdio.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+class mem_fetch;
+
+// Opt-in exporter of sampled memory request lifecycles in the Chrome
+// trace-event JSON format (loads in chrome://tracing and Perfetto).
+//
+// Every sample_period-th mem_fetch (by request uid) becomes an async track
+// with one slice per mem_fetch_status it passes through, from L1 through the
+// interconnect, L2, the DRAM scheduler queue and bank, and back.  Requests
+// are tagged MEM or PIM through the event category.  Kernels and DRAM
+// READ/WRITE/PIM mode phases of each channel are separate tracks.
+// Timestamps are core cycles (1 us in the viewer = 1 core cycle).
+//
+// Events are formatted into a buffer on the simulation thread; full buffers
+// are handed to a writer thread so file I/O stays off the critical path.
+class chrome_trace {
+ public:
+  chrome_trace(const char *filename, unsigned sample_period,
+               unsigned n_channels);
+  ~chrome_trace();
+
+  bool sampled(unsigned request_uid) const {
+    return request_uid % m_sample_period == 0;
+  }
+  void set_cycle(unsigned long long cycle) { m_cycle = cycle; }
+
+  // mf left |old_status| (entered at |since|) at |cycle|
+  void mf_status(mem_fetch *mf, unsigned old_status,
+                 unsigned long long since, unsigned long long cycle);
+  void mf_deleted(mem_fetch *mf, unsigned last_status,
+                  unsigned long long since);
+
+  void kernel_launch(unsigned uid, const std::string &name);
+  void kernel_done(unsigned uid, const std::string &name);
+  void dram_mode(unsigned channel, unsigned mode);
+
+  void flush();
+  void close();
+
+ private:
+  void emit(const char *event, int len);
+  void hand_off();
+  static void *writer_main(void *arg);
+
+  FILE *m_fp;
+  unsigned m_sample_period;
+  unsigned long long m_cycle;
+
+  std::vector<unsigned> m_dram_mode;
+  std::vector<unsigned long long> m_dram_mode_since;
+
+  std::string m_buffer;
+  std::deque<std::string *> m_full;  // buffers waiting for the writer thread
+  bool m_done;
+  pthread_t m_writer;
+  pthread_mutex_t m_lock;
+  pthread_cond_t m_cond;
+};
+
+// NULL unless -gpgpu_chrome_trace_file is set
+extern chrome_trace *g_chrome_trace;
+
+#endif
@@ -28,25 +28,16 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "dram.h"
+#include "chrome_trace.h"
 #include "dram_sched.h"
-#include "dram_sched_bliss.h"
-#include "dram_sched_fr_rr_fcfs.h"
-#include "dram_sched_gi.h"
-#include "dram_sched_gi_mem.h"
-#include "dram_sched_mem_first.h"
-#include "dram_sched_paws.h"
-#include "dram_sched_paws_new.h"
-#include "dram_sched_pim_first.h"
-#include "dram_sched_pim_frfcfs.h"
-#include "dram_sched_rr_batch_cap.h"
-#include "dram_sched_rr_mem.h"
-#include "dram_sched_rr_req_cap.h"
 #include "gpu-misc.h"
 #include "gpu-sim.h"
 #include "hashing.h"
 #include "l2cache.h"
 #include "mem_fetch.h"
 #include "mem_latency_stat.h"
+#include "mem_timeseries.h"
+#include "stats_registry.h"
 
 #ifdef DRAM_VERIFY
 int PRINT_CYCLE = 0;
@@ -55,6 +46,13 @@ int PRINT_CYCLE = 0;
 template class fifo_pipeline<mem_fetch>;
 template class fifo_pipeline<dram_req_t>;
 
+// -gpgpu_dram_scheduler fifo: no scheduler object, dram_t::scheduler_fifo()
+static dram_scheduler *create_fifo(const memory_config *config, dram_t *dm,
+                                   memory_stats_t *stats) {
+  return NULL;
+}
+static dram_scheduler_registrar register_fifo("fifo", 0, create_fifo);
+
 dram_t::dram_t(unsigned int partition_id, const memory_config *config,
                memory_stats_t *stats, memory_partition_unit *mp,
                gpgpu_sim *gpu) {
@@ -140,8 +138,38 @@ dram_t::dram_t(unsigned int partition_id, const memory_config *config,
   }
   prio = 0;
 
+  m_bkgrp_banks.resize(m_config->nbkgrp);
+  for (unsigned i = 0; i < m_config->nbk; i++) {
+    m_all_banks.push_back(i);
+    m_bkgrp_banks[get_bankgrp_number(i)].push_back(i);
+  }
+
+  const pim_unit_config *unit_config = &m_config->m_pim_unit_config;
+  if (unit_config->enabled) {
+    const unsigned n_units =
+        unit_config->per_bankgrp ? m_config->nbkgrp : m_config->nbk;
+    m_pim_units.resize(n_units, pim_unit(unit_config));
+    m_bkgrp_units.resize(m_config->nbkgrp);
+    for (unsigned u = 0; u < n_units; u++) m_all_units.push_back(u);
+    for (unsigned g = 0; g < m_config->nbkgrp; g++) {
+      if (unit_config->per_bankgrp)
+        m_bkgrp_units[g].push_back(g);
+      else
+        m_bkgrp_units[g] = m_bkgrp_banks[g];
+    }
+  }
+
+  if (!dram_scheduler_registry::exists(m_config->dram_scheduler_name)) {
+    printf("Error: Unknown DRAM scheduler \"%s\", available:\n",
+           m_config->dram_scheduler_name);
+    dram_scheduler_registry::print(stdout);
+    assert(0);
+  }
+  m_scheduler = dram_scheduler_registry::create(m_config->dram_scheduler_name,
+                                                m_config, this, stats);
+
   unsigned max_mrqq = 2;
-  if (m_config->scheduler_type == DRAM_FIFO) {
+  if (!m_scheduler) {
     max_mrqq = m_config->gpgpu_frfcfs_dram_sched_queue_size + \
                m_config->gpgpu_frfcfs_dram_pim_queue_size;
   }
@@ -157,52 +185,11 @@ dram_t::dram_t(unsigned int partition_id, const memory_config *config,
           ? 1024
           : m_config->gpgpu_dram_return_queue_size);
 
-  switch (m_config->scheduler_type) {
-    case DRAM_BLISS:
-      m_scheduler = new bliss_scheduler(m_config, this, stats);
-      break;
-    case DRAM_FIFO:
-      m_scheduler = NULL;
-      break;
-    case DRAM_FRFCFS:
-      m_scheduler = new dram_scheduler(m_config, this, stats);
-      break;
-    case DRAM_FR_RR_FCFS:
-      m_scheduler = new fr_rr_fcfs_scheduler(m_config, this, stats);
-      break;
-    case DRAM_GI:
-      m_scheduler = new gi_scheduler(m_config, this, stats);
-      break;
-    case DRAM_GI_MEM:
-      m_scheduler = new gi_mem_scheduler(m_config, this, stats);
-      break;
-    case DRAM_MEM_FIRST:
-      m_scheduler = new mem_first_scheduler(m_config, this, stats);
-      break;
-    case DRAM_PAWS:
-      m_scheduler = new paws_scheduler(m_config, this, stats);
-      break;
-    case DRAM_PAWS_NEW:
-      m_scheduler = new paws_new_scheduler(m_config, this, stats);
-      break;
-    case DRAM_PIM_FIRST:
-      m_scheduler = new pim_first_scheduler(m_config, this, stats);
-      break;
-    case DRAM_PIM_FRFCFS:
-      m_scheduler = new pim_frfcfs_scheduler(m_config, this, stats);
-      break;
-    case DRAM_RR_BATCH_CAP:
-      m_scheduler = new rr_batch_cap_scheduler(m_config, this, stats);
-      break;
-    case DRAM_RR_MEM:
-      m_scheduler = new rr_mem_scheduler(m_config, this, stats);
-      break;
-    case DRAM_RR_REQ_CAP:
-      m_scheduler = new rr_req_cap_scheduler(m_config, this, stats);
-      break;
-    default:
-      printf("Error: Unknown DRAM scheduler type\n");
-      assert(0);
+  if (m_config->dram_pim_bankgrp_mode && m_scheduler &&
+      (m_scheduler->name() == "paws")) {
+    // PAWS keeps per-bank copies of every PIM request
+    printf("Error: -dram_pim_bankgrp_mode is not supported by PAWS\n");
+    assert(0);
   }
 
   n_cmd = 0;
@@ -247,6 +234,15 @@ dram_t::dram_t(unsigned int partition_id, const memory_config *config,
   nonpim2pimswitches = 0;
   nonpim2pimswitchlatency = 0;
   nonpim2pimswitchconflicts = 0;
+  mem_issued_in_pim_mode = 0;
+  for (unsigned i = 0; i < NUM_PIM_OP; i++) pim_unit_ops[i] = 0;
+  pim_unit_stalls = 0;
+  pim_unit_spills = 0;
+  pim_result_reads = 0;
+  pim_result_waits = 0;
+  n_pim_act_banks = 0;
+  n_pim_alu_ops = 0;
+  n_pim_reg_accesses = 0;
   first_non_pim_insert_timestamp = 0;
   first_pim_insert_timestamp = 0;
   last_non_pim_finish_timestamp = 0;
@@ -260,7 +256,7 @@ dram_t::dram_t(unsigned int partition_id, const memory_config *config,
 }
 
 bool dram_t::full(bool is_write, bool is_pim) const {
-  if (m_config->scheduler_type == DRAM_FIFO) {
+  if (!m_scheduler) {
     if (is_pim) {
       return m_num_pim_pending >= m_config->gpgpu_frfcfs_dram_pim_queue_size;
     } else {
@@ -284,9 +280,13 @@ bool dram_t::full(bool is_write, bool is_pim) const {
   }
 }
 
+unsigned dram_t::pim_que_length() const {
+  return m_scheduler ? m_scheduler->num_pim_pending() : m_num_pim_pending;
+}
+
 unsigned dram_t::que_length() const {
   unsigned nreqs = 0;
-  if (m_config->scheduler_type == DRAM_FIFO) {
+  if (!m_scheduler) {
     nreqs = mrqq->get_length();
   } else {
     nreqs = m_scheduler->num_pending();
@@ -404,7 +404,7 @@ void dram_t::push(class mem_fetch *data) {
   // stats...
   n_req += 1;
   n_req_partial += 1;
-  if (m_config->scheduler_type == DRAM_FIFO) {
+  if (!m_scheduler) {
     max_mrqs_temp = (max_mrqs_temp > mrqq->get_length()) ? max_mrqs_temp
                                                          : mrqq->get_length();
     max_pim_mrqs_temp = (max_pim_mrqs_temp > m_num_pim_pending) ? \
@@ -440,7 +440,7 @@ void dram_t::scheduler_fifo() {
 
       bool can_schedule = true;
 
-      for (unsigned int b = 0; b < m_config->nbk; b++) {
+      for (unsigned b : pim_banks(head_mrqq)) {
         if (bk[b]->mrq) {
           can_schedule = false;
 
@@ -454,16 +454,15 @@ void dram_t::scheduler_fifo() {
 
       if (can_schedule) {
         head_mrqq = mrqq->pop();
-        for (unsigned int b = 0; b < m_config->nbk; b++) {
+        for (unsigned b : pim_banks(head_mrqq)) {
           access_num++;
           pim_num++;
           if (bk[b]->curr_row == head_mrqq->row) {
             hits_num++;
             hits_pim_num++;
           }
-
-          bk[b]->mrq = head_mrqq;
         }
+        assign_pim(head_mrqq);
 
         m_num_pim_pending--;
         request_issued = true;
@@ -570,6 +569,8 @@ void dram_t::scheduler_fifo() {
   a ^= b;
 
 void dram_t::cycle() {
+  if (g_chrome_trace) g_chrome_trace->dram_mode(id, mode);
+
   if (!returnq->full()) {
     dram_req_t *cmd = rwq->pop();
     if (cmd) {
@@ -610,14 +611,11 @@ void dram_t::cycle() {
   /* check if the upcoming request is on an idle bank */
   /* Should we modify this so that multiple requests are checked? */
 
-  switch (m_config->scheduler_type) {
-    case DRAM_FIFO:
-      scheduler_fifo();
-      break;
-    default:
-      scheduler_frfcfs();
-  }
-  if (m_config->scheduler_type == DRAM_FIFO) {
+  if (m_scheduler)
+    scheduler_frfcfs();
+  else
+    scheduler_fifo();
+  if (!m_scheduler) {
     if (mrqq->get_length() > max_mrqs) {
       max_mrqs = mrqq->get_length();
     }
@@ -748,24 +746,34 @@ void dram_t::cycle() {
     }
   }
 
-  if (in_pim_mode) {
-    issued_col_cmd = issue_pim_col_command();
-    issued_row_cmd = issue_pim_row_command();
+  if (m_config->dram_pim_bankgrp_mode) {
+    // PIM commands only occupy the bank groups of their operands; the other
+    // banks keep issuing MEM commands below
+    for (unsigned g = 0; g < m_config->nbkgrp; g++) {
+      if (bkgrp[g]->mode != PIM_MODE) continue;
+      if (!issued_col_cmd)
+        issued_col_cmd = issue_pim_col_command(m_bkgrp_banks[g]);
+      if (!issued_row_cmd)
+        issued_row_cmd = issue_pim_row_command(m_bkgrp_banks[g]);
+    }
+  } else if (in_pim_mode) {
+    issued_col_cmd = issue_pim_col_command(m_all_banks);
+    issued_row_cmd = issue_pim_row_command(m_all_banks);
   }
 
-  else {
+  if (!in_pim_mode || m_config->dram_pim_bankgrp_mode) {
     if (m_config->dual_bus_interface) {
       // dual bus interface
       // issue one row command and one column command
-      for (unsigned i = 0; i < m_config->nbk; i++) {
+      for (unsigned i = 0; i < m_config->nbk && !issued_col_cmd; i++) {
         unsigned j = (i + prio) % m_config->nbk;
+        if (bk[j]->mrq && bk[j]->mrq->data->is_pim()) continue;
         issued_col_cmd = issue_col_command(j);
-        if (issued_col_cmd) break;
       }
-      for (unsigned i = 0; i < m_config->nbk; i++) {
+      for (unsigned i = 0; i < m_config->nbk && !issued_row_cmd; i++) {
         unsigned j = (i + prio) % m_config->nbk;
+        if (bk[j]->mrq && bk[j]->mrq->data->is_pim()) continue;
         issued_row_cmd = issue_row_command(j);
-        if (issued_row_cmd) break;
       }
       for (unsigned i = 0; i < m_config->nbk; i++) {
         unsigned j = (i + prio) % m_config->nbk;
@@ -781,6 +789,7 @@ void dram_t::cycle() {
       // issue only one row/column command
       for (unsigned i = 0; i < m_config->nbk; i++) {
         unsigned j = (i + prio) % m_config->nbk;
+        if (bk[j]->mrq && bk[j]->mrq->data->is_pim()) continue;
         if (!issued_col_cmd) issued_col_cmd = issue_col_command(j);
 
         if (!issued_col_cmd && !issued_row_cmd)
@@ -1047,16 +1056,21 @@ bool dram_t::issue_row_command(int j) {
   return issued;
 }
 
-bool dram_t::issue_pim_col_command() {
-  if (bk[0]->mrq && (bk[0]->mrq->artificial_wait_time < \
+bool dram_t::issue_pim_col_command(const std::vector<unsigned> &banks) {
+  bank_t *lead = bk[banks[0]];
+  if (lead->mrq && (lead->mrq->artificial_wait_time < \
       m_config->dram_artificial_wait_time)) {
-    bk[0]->mrq->artificial_wait_time++;
+    lead->mrq->artificial_wait_time++;
     return false;
   }
 
+  if (lead->mrq && (lead->mrq->rw == READ)) {
+    return issue_pim_read_command(banks);
+  }
+
   bool can_issue = true;
 
-  for (int j = 0; j < m_config->nbk; j++) {
+  for (unsigned j : banks) {
     unsigned grp = get_bankgrp_number(j);
 
     can_issue = can_issue && bk[j]->mrq &&
@@ -1067,22 +1081,47 @@ bool dram_t::issue_pim_col_command() {
     if (!can_issue) { break; }
   }
 
+  if (can_issue && m_config->m_pim_unit_config.enabled) {
+    enum pim_op_class op = pim_op(lead->mrq);
+    for (unsigned u : pim_units(lead->mrq)) {
+      if (!m_pim_units[u].can_issue(op, m_dram_cycle)) {
+        pim_unit_stalls++;
+        can_issue = false;
+        break;
+      }
+    }
+    if (can_issue) {
+      for (unsigned u : pim_units(lead->mrq)) {
+        if (m_pim_units[u].issue(op, lead->mrq->row, m_dram_cycle)) {
+          pim_unit_spills++;
+          n_pim_reg_accesses++;
+        }
+      }
+      pim_unit_ops[op]++;
+    }
+  }
+
   if (can_issue) {
     if (rw == READ) {
       rw = WRITE;
       rwq->set_min_length(m_config->WL);
     }
-    rwq->push(bk[0]->mrq);
-
-    update_service_latency_stats(bk[0]->mrq);
-
-    for (unsigned j = 0; j < m_config->nbk; j++) {
+    dram_req_t *req = lead->mrq;
+    rwq->push(req);
+
+    // a write-combined PIM write carries several columns of the same row,
+    // one column command each; the banks are released after the last one
+    req->txbytes += m_config->dram_atom_size;
+    const bool done = !(req->txbytes < req->nbytes);
+    if (done) update_service_latency_stats(req);
+    n_pim_alu_ops += banks.size();
+    n_pim_reg_accesses += banks.size();
+    req->data->set_status(IN_PARTITION_DRAM,
+                          m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
+
+    for (unsigned j : banks) {
       unsigned grp = get_bankgrp_number(j);
 
-      bk[j]->mrq->data->set_status(
-          IN_PARTITION_DRAM, m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
-
-      bk[j]->mrq->txbytes += m_config->dram_atom_size;
       bkgrp[grp]->CCDLc = m_config->tCCDL;
       bk[j]->WTPc = m_config->tWTP;
 
@@ -1096,7 +1135,10 @@ bool dram_t::issue_pim_col_command() {
              bk[j]->curr_row, bk[j]->mrq->col);
 #endif
 
-      bk[j]->mrq = NULL;
+      if (done) {
+        bkgrp[grp]->mode = (mode == PIM_MODE) ? READ_MODE : mode;
+        bk[j]->mrq = NULL;
+      }
     }
 
     CCDc = m_config->tCCD;
@@ -1106,19 +1148,23 @@ bool dram_t::issue_pim_col_command() {
   return can_issue;
 }
 
-bool dram_t::issue_pim_row_command() {
-  if (bk[0]->mrq && (bk[0]->mrq->artificial_wait_time < \
+bool dram_t::issue_pim_row_command(const std::vector<unsigned> &banks) {
+  bank_t *lead = bk[banks[0]];
+  if (lead->mrq && (lead->mrq->artificial_wait_time < \
       m_config->dram_artificial_wait_time)) {
-    bk[0]->mrq->artificial_wait_time++;
+    lead->mrq->artificial_wait_time++;
     return false;
   }
 
+  // result reads are served from the PIM unit registers, not from a row
+  if (lead->mrq && (lead->mrq->rw == READ)) return false;
+
   bool can_issue = false;
 
   std::vector<unsigned> precharge_banks;
   std::vector<unsigned> activate_banks;
 
-  for (unsigned j = 0; j < m_config->nbk; j++) {
+  for (unsigned j : banks) {
     if (bk[j]->mrq) {
       if ((bk[j]->state == BANK_ACTIVE) &&
           (bk[j]->curr_row != bk[j]->mrq->row)) {
@@ -1186,12 +1232,74 @@ bool dram_t::issue_pim_row_command() {
       prio = 0;
       n_act_partial++;
       n_act++;
+      n_pim_act_banks += activate_banks.size();
     }
   }
 
   return can_issue;
 }
 
+bool dram_t::issue_pim_read_command(const std::vector<unsigned> &banks) {
+  dram_req_t *req = bk[banks[0]]->mrq;
+
+  bool can_issue = !CCDc && (WTRc == 0) && !rwq->full();
+  for (unsigned j : banks) {
+    unsigned grp = get_bankgrp_number(j);
+    can_issue = can_issue && bk[j]->mrq && !(bkgrp[grp]->CCDLc);
+    if (!can_issue) return false;
+  }
+
+  if (m_config->m_pim_unit_config.enabled) {
+    // every unit starts its read-back, if any, in the same cycle
+    bool ready = true;
+    for (unsigned u : pim_units(req))
+      ready = m_pim_units[u].result_ready(req->row, m_dram_cycle) && ready;
+    if (!ready) {
+      pim_result_waits++;
+      return false;
+    }
+  }
+
+  if (rw == WRITE) {
+    rw = READ;
+    rwq->set_min_length(m_config->CL);
+  }
+  rwq->push(req);
+  req->data->set_status(IN_PARTITION_DRAM,
+                        m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
+  req->txbytes += m_config->dram_atom_size;
+  CCDc = m_config->tCCD;
+  RTWc = m_config->tRTW;
+  for (unsigned j : banks) {
+    bkgrp[get_bankgrp_number(j)]->CCDLc = m_config->tCCDL;
+  }
+
+  bwutil += m_config->BL / m_config->data_command_freq_ratio;
+  bwutil_partial += m_config->BL / m_config->data_command_freq_ratio;
+
+#ifdef DRAM_VERIFY
+  PRINT_CYCLE = 1;
+  printf("\tPIMRD Ch:%d Bk:%d Row:%03x \n", id, req->bk, req->row);
+#endif
+
+  // transfer done
+  if (!(req->txbytes < req->nbytes)) {
+    if (m_config->m_pim_unit_config.enabled) {
+      for (unsigned u : pim_units(req)) m_pim_units[u].read_result(req->row);
+    }
+    pim_result_reads++;
+    n_pim_reg_accesses += banks.size();
+    update_service_latency_stats(req);
+    for (unsigned j : banks) {
+      unsigned grp = get_bankgrp_number(j);
+      bkgrp[grp]->mode = (mode == PIM_MODE) ? READ_MODE : mode;
+      bk[j]->mrq = NULL;
+    }
+  }
+
+  return true;
+}
+
 void dram_t::update_service_latency_stats(dram_req_t *req) {
   unsigned service_latency = m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle -\
                              req->timestamp;
@@ -1215,29 +1323,8 @@ class mem_fetch *dram_t::return_queue_top() {
   return returnq->top();
 }
 
-template <class T>
-std::vector<T> get_stats(std::vector<T> *v) {
-  double sum = 0;
-  double mean = 0;
-  double sq = 0;
-  double stdev = 0;
-  double max = 0;
-  unsigned long long len = v->size();
-
-  if (len > 0) {
-    sum = std::accumulate(v->begin(), v->end(), 0.0);
-    mean = sum / len;
-    sq = std::inner_product(v->begin(), v->end(), v->begin(), 0.0);
-    stdev = std::sqrt(sq / len - mean * mean);
-    max = *std::max_element(std::begin(*v), std::end(*v));
-  }
-
-  std::vector<T> retval;
-  retval.push_back((T) mean);
-  retval.push_back((T) stdev);
-  retval.push_back((T) max);
-
-  return retval;
+void dram_t::finalize_stats() {
+  if (m_scheduler) m_scheduler->finalize_stats();
 }
 
 void dram_t::print(FILE *simFile) const {
@@ -1377,6 +1464,19 @@ void dram_t::print(FILE *simFile) const {
   printf("nonpim2pimswitches = %llu\n", nonpim2pimswitches);
   printf("nonpim2pimswitchlatency = %llu\n", nonpim2pimswitchlatency);
   printf("nonpim2pimswitchconflicts = %llu\n", nonpim2pimswitchconflicts);
+  printf("mem_issued_in_pim_mode = %llu\n", mem_issued_in_pim_mode);
+  if (m_config->m_pim_unit_config.enabled) {
+    printf("pim_unit_ops = mac:%llu add:%llu reduce:%llu\n",
+           pim_unit_ops[PIM_OP_MAC], pim_unit_ops[PIM_OP_ADD],
+           pim_unit_ops[PIM_OP_REDUCE]);
+    printf("pim_unit_stalls = %llu\n", pim_unit_stalls);
+    printf("pim_unit_spills = %llu\n", pim_unit_spills);
+    printf("pim_result_waits = %llu\n", pim_result_waits);
+  }
+  printf("pim_result_reads = %llu\n", pim_result_reads);
+  printf("pim_act_banks = %llu\n", n_pim_act_banks);
+  printf("pim_alu_ops = %llu\n", n_pim_alu_ops);
+  printf("pim_reg_accesses = %llu\n", n_pim_reg_accesses);
   printf("first_non_pim_insert = %llu\n", first_non_pim_insert_timestamp);
   printf("first_pim_insert = %llu\n", first_pim_insert_timestamp);
   printf("last_non_pim_finish = %llu\n", last_non_pim_finish_timestamp);
@@ -1385,266 +1485,9 @@ void dram_t::print(FILE *simFile) const {
   printf("avg_non_pim_queuing_delay = %lf\n", (double)non_pim_queueing_delay /
       (n_rd + n_wr + n_rd_L2_A + n_wr_WB));
 
-  if (m_config->scheduler_type == DRAM_FRFCFS) {
-    dram_scheduler *sched = (dram_scheduler*) m_scheduler;
-
-    printf("\nMEM2PIM Switch Breakdown:\n");
-    for (int i = 0; i < FRFCFS_NUM_SWITCH_REASONS; i++) {
-      printf("  %s: %d\n", frfcfs_switch_reason_str[i].c_str(),
-          sched->m_mem2pim_switch_reason[
-            static_cast<frfcfs_switch_reason>(i)]);
-    }
-
-    printf("\nPIM2MEM Switch Breakdown:\n");
-    for (int i = 0; i < FRFCFS_NUM_SWITCH_REASONS; i++) {
-      printf("  %s: %d\n", frfcfs_switch_reason_str[i].c_str(),
-          sched->m_pim2mem_switch_reason[
-            static_cast<frfcfs_switch_reason>(i)]);
-    }
-  }
-
-  if (m_config->scheduler_type == DRAM_PIM_FRFCFS) {
-    pim_frfcfs_scheduler *sched = (pim_frfcfs_scheduler*) m_scheduler;
-
-    printf("\nMEM2PIM Switch Breakdown:\n");
-    for (int i = 0; i < PIM_FRFCFS_NUM_SWITCH_REASONS; i++) {
-      printf("  %s: %d\n", pim_frfcfs_switch_reason_str[i].c_str(),
-          sched->m_mem2pim_switch_reason[
-            static_cast<pim_frfcfs_switch_reason>(i)]);
-    }
-
-    printf("\nPIM2MEM Switch Breakdown:\n");
-    for (int i = 0; i < PIM_FRFCFS_NUM_SWITCH_REASONS; i++) {
-      printf("  %s: %d\n", pim_frfcfs_switch_reason_str[i].c_str(),
-          sched->m_pim2mem_switch_reason[
-            static_cast<pim_frfcfs_switch_reason>(i)]);
-    }
-  }
-
-  if (m_config->scheduler_type == DRAM_RR_BATCH_CAP) {
-    rr_batch_cap_scheduler *sched = (rr_batch_cap_scheduler*) m_scheduler;
-
-    sched->finalize_stats();
-
-    std::vector<unsigned long long> stats = get_stats<unsigned long long>(
-        &(sched->m_pim_batch_exec_time));
-
-    printf("\nAvgPimBatchExecTime = %u", stats[0]);
-    printf("\nMaxPimBatchExecTime = %u", stats[2]);
-    printf("\nStDevPimBatchExecTime = %u", stats[1]);
-
-    unsigned len = sched->m_pim_batch_exec_time.size();
-    double avg_batch_size = 0;
-    if (len > 0) { avg_batch_size = n_pim / len; }
-    printf("\nAvgPimBatchSize = %.6f\n", avg_batch_size);
-
-    // MEM batch execution time
-    stats = get_stats<unsigned long long>(&(sched->m_mem_batch_exec_time));
-
-    printf("\nAvgMemBatchExecTime = %u", stats[0]);
-    printf("\nMaxMemBatchExecTime = %u", stats[2]);
-    printf("\nStDevMemBatchExecTime = %u\n", stats[1]);
-
-    // Wasted MEM batch cycles
-    stats = get_stats<unsigned long long>(&(sched->m_mem_wasted_cycles));
-
-    printf("\nAvgMemWastedCycles = %u", stats[0]);
-    printf("\nMaxMemWastedCycles = %u", stats[2]);
-    printf("\nStDevMemWastedCycles = %u\n", stats[1]);
-  }
-
-  if (m_config->scheduler_type == DRAM_RR_REQ_CAP) {
-    rr_req_cap_scheduler *sched = (rr_req_cap_scheduler*) m_scheduler;
-
-    sched->finalize_stats();
-
-    std::vector<unsigned long long> stats = get_stats<unsigned long long>(
-        &(sched->m_pim_batch_exec_time));
-
-    printf("\nAvgPimBatchExecTime = %u", stats[0]);
-    printf("\nMaxPimBatchExecTime = %u", stats[2]);
-    printf("\nStDevPimBatchExecTime = %u", stats[1]);
-
-    unsigned len = sched->m_pim_batch_exec_time.size();
-    double avg_batch_size = 0;
-    if (len > 0) { avg_batch_size = n_pim / len; }
-    printf("\nAvgPimBatchSize = %.6f\n", avg_batch_size);
-
-    // MEM batch execution time
-    stats = get_stats<unsigned long long>(&(sched->m_mem_batch_exec_time));
-
-    printf("\nAvgMemBatchExecTime = %u", stats[0]);
-    printf("\nMaxMemBatchExecTime = %u", stats[2]);
-    printf("\nStDevMemBatchExecTime = %u\n", stats[1]);
-
-    // Wasted MEM batch cycles
-    stats = get_stats<unsigned long long>(&(sched->m_mem_wasted_cycles));
-
-    printf("\nAvgMemWastedCycles = %u", stats[0]);
-    printf("\nMaxMemWastedCycles = %u", stats[2]);
-    printf("\nStDevMemWastedCycles = %u\n", stats[1]);
-  }
-
-  if (m_config->scheduler_type == DRAM_PAWS) {
-    paws_scheduler *sched = (paws_scheduler*)m_scheduler;
-
-    printf("\nBank stall time for PIM:\n");
-    for (unsigned b = 0; b < m_config->nbk; b++) {
-      printf("Bank_%d_stall_time = %llu\n", b,sched->m_bank_pim_stall_time[b]);
-    }
-
-    printf("\nBank waste time for PIM:\n");
-    for (unsigned b = 0; b < m_config->nbk; b++) {
-      printf("Bank_%d_waste_time = %llu\n", b,sched->m_bank_pim_waste_time[b]);
-    }
-
-    printf("\nMEM2PIM switch readiness latency:\n");
-
-    double sum = 0;
-    double mean = 0;
-    double sq = 0;
-    double stdev = 0;
-    double max = 0;
-    unsigned long long len = sched->m_mem2pim_switch_latency.size();
-
-    if (len > 0) {
-      sum = std::accumulate(sched->m_mem2pim_switch_latency.begin(),
-          sched->m_mem2pim_switch_latency.end(), 0.0);
-      mean = sum / len;
-      sq = std::inner_product(sched->m_mem2pim_switch_latency.begin(),
-          sched->m_mem2pim_switch_latency.end(),
-          sched->m_mem2pim_switch_latency.begin(), 0.0);
-      stdev = std::sqrt(sq / len - mean * mean);
-      max = *std::max_element(std::begin(sched->m_mem2pim_switch_latency),
-          std::end(sched->m_mem2pim_switch_latency));
-    }
-
-    printf("\nAvgSwitchReadinessLatency = %.6f", mean);
-    printf("\nMaxSwitchReadinessLatency = %.6f", max);
-    printf("\nStDevSwitchReadinessLatency = %.6f", stdev);
-
-    unsigned long long len_non_zeros = len -
-        std::count(sched->m_mem2pim_switch_latency.begin(),
-                sched->m_mem2pim_switch_latency.end(), 0);
-
-    if (len_non_zeros > 0) {
-      mean = sum / len_non_zeros;
-      stdev = std::sqrt(sq / len_non_zeros - mean * mean);
-    }
-
-    printf("\nAvgNonZeroSwitchReadinessLatency = %.6f", mean);
-    printf("\nStDevNonZeroSwitchReadinessLatency = %.6f\n", stdev);
-
-    std::vector<unsigned> stats = get_stats<unsigned>(
-        &(sched->m_mem_cap));
-
-    printf("\nAvgMemCap = %u", stats[0]);
-    printf("\nMaxMemCap = %u", stats[2]);
-    printf("\nStDevMemCap = %u", stats[1]);
-
-    stats = get_stats<unsigned>(
-        &(sched->m_max_mem_requests_issued_at_any_bank));
-
-    printf("\nAvgMemRequestsIssuedPerBank = %u", stats[0]);
-    printf("\nMaxMemRequestsIssuedPerBank = %u", stats[2]);
-    printf("\nStDevMemRequestsIssuedPerBank = %u", stats[1]);
-
-    stats = get_stats<unsigned>(&(sched->m_pim_requests_issued));
-
-    printf("\nAvgPimRequestsIssued = %u", stats[0]);
-    printf("\nMaxPimRequestsIssued = %u", stats[2]);
-    printf("\nStDevPimRequestsIssued = %u", stats[1]);
-
-    printf("\nMEM2PIM Switch Breakdown:\n");
-    for (int i = 0; i < PAWS_NUM_SWITCH_REASONS; i++) {
-      unsigned count = std::count(sched->m_mem2pim_switch_reason.begin(),
-          sched->m_mem2pim_switch_reason.end(), i);
-      printf("  %s: %u\n", paws_switch_reason_str[i].c_str(), count);
-    }
-
-    printf("\nPIM2MEM Switch Breakdown:\n");
-    for (int i = 0; i < PAWS_NUM_SWITCH_REASONS; i++) {
-      unsigned count = std::count(sched->m_pim2mem_switch_reason.begin(),
-          sched->m_pim2mem_switch_reason.end(), i);
-      printf("  %s: %u\n", paws_switch_reason_str[i].c_str(), count);
-    }
-  }
-
-  if (m_config->scheduler_type == DRAM_PAWS_NEW) {
-    paws_new_scheduler *sched = (paws_new_scheduler*) m_scheduler;
-
-    sched->finalize_stats();
-
-    std::vector<unsigned long long> stats = get_stats<unsigned long long>(
-        &(sched->m_pim_batch_exec_time));
-
-    printf("\nAvgPimBatchExecTime = %u", stats[0]);
-    printf("\nMaxPimBatchExecTime = %u", stats[2]);
-    printf("\nStDevPimBatchExecTime = %u", stats[1]);
-
-    unsigned len = sched->m_pim_batch_exec_time.size();
-    double avg_batch_size = 0;
-    if (len > 0) { avg_batch_size = n_pim / len; }
-    printf("\nAvgPimBatchSize = %.6f\n", avg_batch_size);
-
-    // MEM batch execution time
-    stats = get_stats<unsigned long long>(&(sched->m_mem_batch_exec_time));
-
-    printf("\nAvgMemBatchExecTime = %u", stats[0]);
-    printf("\nMaxMemBatchExecTime = %u", stats[2]);
-    printf("\nStDevMemBatchExecTime = %u\n", stats[1]);
-
-    // Wasted MEM batch cycles
-    stats = get_stats<unsigned long long>(&(sched->m_mem_wasted_cycles));
-
-    printf("\nAvgMemWastedCycles = %u", stats[0]);
-    printf("\nMaxMemWastedCycles = %u", stats[2]);
-    printf("\nStDevMemWastedCycles = %u\n", stats[1]);
-  }
-
-  if (m_config->scheduler_type == DRAM_FR_RR_FCFS) {
-    fr_rr_fcfs_scheduler *sched = (fr_rr_fcfs_scheduler*)m_scheduler;
-
-    std::vector<unsigned> stats = get_stats<unsigned>(
-        &(sched->m_max_mem_requests_issued_at_any_bank));
-
-    printf("\nAvgMemRequestsIssuedPerBank = %u", stats[0]);
-    printf("\nMaxMemRequestsIssuedPerBank = %u", stats[2]);
-    printf("\nStDevMemRequestsIssuedPerBank = %u", stats[1]);
-
-    stats = get_stats<unsigned>(&(sched->m_pim_requests_issued));
-
-    printf("\nAvgPimRequestsIssued = %u", stats[0]);
-    printf("\nMaxPimRequestsIssued = %u", stats[2]);
-    printf("\nStDevPimRequestsIssued = %u", stats[1]);
-
-    printf("\nMEM2PIM Switch Breakdown:\n");
-    for (int i = 0; i < FR_RR_FCFS_NUM_SWITCH_REASONS; i++) {
-      unsigned count = std::count(sched->m_mem2pim_switch_reason.begin(),
-          sched->m_mem2pim_switch_reason.end(), i);
-      printf("  %s: %u\n", fr_rr_fcfs_switch_reason_str[i].c_str(), count);
-    }
-
-    printf("\nPIM2MEM Switch Breakdown:\n");
-    for (int i = 0; i < FR_RR_FCFS_NUM_SWITCH_REASONS; i++) {
-      unsigned count = std::count(sched->m_pim2mem_switch_reason.begin(),
-          sched->m_pim2mem_switch_reason.end(), i);
-      printf("  %s: %u\n", fr_rr_fcfs_switch_reason_str[i].c_str(), count);
-    }
-  }
-
-  if (m_config->scheduler_type == DRAM_BLISS) {
-    bliss_scheduler *sched = (bliss_scheduler*) m_scheduler;
-    printf("\nBlacklist statistics\n");
-    printf("Total cycles = %ull\n", m_dram_cycle);
-    printf("Cycles none blacklisted = %u\n",
-        sched->m_cycles_none_blacklisted);
-    printf("Cycles both blacklisted = %u\n",
-        sched->m_cycles_both_blacklisted);
-    printf("Cycles PIM blacklisted = %u\n",
-        sched->m_cycles_pim_blacklisted);
-    printf("Cycles MEM blacklisted = %u\n",
-        sched->m_cycles_mem_blacklisted);
+  if (m_scheduler) {
+    m_scheduler->print_stats(stdout);
+    if (m_scheduler->tuner()) m_scheduler->tuner()->print(stdout);
   }
 
   printf("\nDual Bus Interface Util: \n");
@@ -1664,7 +1507,7 @@ void dram_t::print(FILE *simFile) const {
   fprintf(simFile, "\ndram_eff_bins:");
   for (i = 0; i < 10; i++) fprintf(simFile, " %d", dram_eff_bins[i]);
   fprintf(simFile, "\n");
-  if (m_config->scheduler_type != DRAM_FIFO) {
+  if (m_scheduler) {
     fprintf(simFile, "mrqq: max=%d avg=%g\n", max_mrqs,
             (float)ave_mrqs / n_cmd);
     fprintf(simFile, "mrqq_pim: max=%d avg=%g\n", max_pim_mrqs,
@@ -1686,6 +1529,131 @@ void dram_t::visualize() const {
   if (m_scheduler) m_scheduler->print(stdout);
 }
 
+void dram_t::register_stats(stats_registry &reg) const {
+  char prefix[32];
+  snprintf(prefix, sizeof(prefix), "dram[%u].", id);
+  const std::string p(prefix);
+
+  reg.add(p + "n_cmd", &n_cmd);
+  reg.add(p + "n_activity", &n_activity);
+  reg.add(p + "n_nop", &n_nop);
+  reg.add(p + "n_act", &n_act);
+  reg.add(p + "n_pre", &n_pre);
+  reg.add(p + "n_ref", &n_ref);
+  reg.add(p + "n_req", &n_req);
+  reg.add(p + "n_rd", &n_rd);
+  reg.add(p + "n_rd_L2_A", &n_rd_L2_A);
+  reg.add(p + "n_wr", &n_wr);
+  reg.add(p + "n_wr_WB", &n_wr_WB);
+  reg.add(p + "n_pim", &n_pim);
+  reg.add(p + "bwutil", &bwutil);
+  reg.add(p + "max_mrqs", &max_mrqs);
+  reg.add(p + "ave_mrqs", &ave_mrqs);
+  reg.add(p + "dram_util_bins", dram_util_bins, 10);
+  reg.add(p + "dram_eff_bins", dram_eff_bins, 10);
+
+  reg.add(p + "wasted_bw_row", &wasted_bw_row);
+  reg.add(p + "wasted_bw_col", &wasted_bw_col);
+  reg.add(p + "util_bw", &util_bw);
+  reg.add(p + "idle_bw", &idle_bw);
+  reg.add(p + "RCDc_limit", &RCDc_limit);
+  reg.add(p + "CCDLc_limit", &CCDLc_limit);
+  reg.add(p + "CCDLc_limit_alone", &CCDLc_limit_alone);
+  reg.add(p + "CCDc_limit", &CCDc_limit);
+  reg.add(p + "WTRc_limit", &WTRc_limit);
+  reg.add(p + "WTRc_limit_alone", &WTRc_limit_alone);
+  reg.add(p + "RCDWRc_limit", &RCDWRc_limit);
+  reg.add(p + "RTWc_limit", &RTWc_limit);
+  reg.add(p + "RTWc_limit_alone", &RTWc_limit_alone);
+  reg.add(p + "rwq_limit", &rwq_limit);
+
+  reg.add(p + "access_num", &access_num);
+  reg.add(p + "read_num", &read_num);
+  reg.add(p + "write_num", &write_num);
+  reg.add(p + "pim_num", &pim_num);
+  reg.add(p + "hits_num", &hits_num);
+  reg.add(p + "hits_read_num", &hits_read_num);
+  reg.add(p + "hits_write_num", &hits_write_num);
+  reg.add(p + "hits_pim_num", &hits_pim_num);
+  reg.add(p + "banks_1time", &banks_1time);
+  reg.add(p + "banks_access_total", &banks_access_total);
+  reg.add(p + "banks_time_rw", &banks_time_rw);
+  reg.add(p + "banks_access_rw_total", &banks_access_rw_total);
+  reg.add(p + "banks_time_ready", &banks_time_ready);
+  reg.add(p + "banks_access_ready_total", &banks_access_ready_total);
+  reg.add(p + "issued_two", &issued_two);
+  reg.add(p + "issued_total", &issued_total);
+  reg.add(p + "issued_total_row", &issued_total_row);
+  reg.add(p + "issued_total_col", &issued_total_col);
+  reg.add(p + "bkgrp_parallsim_rw", &bkgrp_parallsim_rw);
+
+  // PIM/MEM mode switching
+  reg.add(p + "pim2nonpimswitches", &pim2nonpimswitches);
+  reg.add(p + "nonpim2pimswitches", &nonpim2pimswitches);
+  reg.add(p + "nonpim2pimswitchlatency", &nonpim2pimswitchlatency);
+  reg.add(p + "nonpim2pimswitchconflicts", &nonpim2pimswitchconflicts);
+  reg.add(p + "mem_issued_in_pim_mode", &mem_issued_in_pim_mode);
+  reg.add(p + "pim_unit_ops", pim_unit_ops, NUM_PIM_OP);
+  reg.add(p + "pim_unit_stalls", &pim_unit_stalls);
+  reg.add(p + "pim_unit_spills", &pim_unit_spills);
+  reg.add(p + "pim_result_reads", &pim_result_reads);
+  reg.add(p + "pim_act_banks", &n_pim_act_banks);
+  reg.add(p + "pim_alu_ops", &n_pim_alu_ops);
+  reg.add(p + "pim_reg_accesses", &n_pim_reg_accesses);
+  reg.add(p + "pim_result_waits", &pim_result_waits);
+  reg.add(p + "pim_queueing_delay", &pim_queueing_delay);
+  reg.add(p + "non_pim_queueing_delay", &non_pim_queueing_delay);
+  reg.add(p + "max_pim_mrqs", &max_pim_mrqs);
+  reg.add(p + "ave_pim_mrqs", &ave_pim_mrqs);
+  if (m_scheduler)
+    m_scheduler->register_stats(reg, p + m_scheduler->name() + ".");
+
+  // per bank
+  bank_t *const *banks = bk;
+  const unsigned nbk = m_config->nbk;
+  reg.add_reader(p + "bank_n_access", stats_registry::STAT_U32, nbk, 0,
+                 [banks, nbk](unsigned char *dst) {
+                   for (unsigned b = 0; b < nbk; b++)
+                     ((unsigned *)dst)[b] = banks[b]->n_access;
+                 });
+  reg.add_reader(p + "bank_n_writes", stats_registry::STAT_U32, nbk, 0,
+                 [banks, nbk](unsigned char *dst) {
+                   for (unsigned b = 0; b < nbk; b++)
+                     ((unsigned *)dst)[b] = banks[b]->n_writes;
+                 });
+  reg.add_reader(p + "bank_n_idle", stats_registry::STAT_U32, nbk, 0,
+                 [banks, nbk](unsigned char *dst) {
+                   for (unsigned b = 0; b < nbk; b++)
+                     ((unsigned *)dst)[b] = banks[b]->n_idle;
+                 });
+}
+
+void dram_t::get_sample_counters(dram_sample_counters &c) const {
+  c.n_cmd = n_cmd;
+  c.bwutil = bwutil;
+  c.access_num = access_num;
+  c.hits_num = hits_num;
+  c.n_rd = n_rd;
+  c.n_wr = n_wr;
+  c.n_pim = n_pim;
+  c.pim2mem_switches = pim2nonpimswitches;
+  c.mem2pim_switches = nonpim2pimswitches;
+  c.mem_queueing_delay = non_pim_queueing_delay;
+  c.pim_queueing_delay = pim_queueing_delay;
+  c.mem2pim_switch_latency = nonpim2pimswitchlatency;
+  c.mem2pim_switch_conflicts = nonpim2pimswitchconflicts;
+  c.mode = mode;
+  if (!m_scheduler) {
+    c.mem_pending = m_num_pending;
+    c.mem_write_pending = 0;
+    c.pim_pending = m_num_pim_pending;
+  } else {
+    c.mem_pending = m_scheduler->num_pending();
+    c.mem_write_pending = m_scheduler->num_write_pending();
+    c.pim_pending = m_scheduler->num_pim_pending();
+  }
+}
+
 void dram_t::print_stat(FILE *simFile) {
   fprintf(simFile,
           "DRAM (%u): n_cmd=%llu n_nop=%llu n_act=%llu n_pre=%llu n_ref=%llu "
@@ -1753,8 +1721,9 @@ void dram_t::visualizer_print(gzFile visualizer_file) {
 
 void dram_t::set_dram_power_stats(unsigned &cmd, unsigned &activity,
                                   unsigned &nop, unsigned &act, unsigned &pre,
-                                  unsigned &rd, unsigned &wr,
-                                  unsigned &req) const {
+                                  unsigned &rd, unsigned &wr, unsigned &req,
+                                  unsigned &pim_act, unsigned &pim_alu,
+                                  unsigned &pim_reg) const {
   // Point power performance counters to low-level DRAM counters
   cmd = n_cmd;
   activity = n_activity;
@@ -1764,9 +1733,12 @@ void dram_t::set_dram_power_stats(unsigned &cmd, unsigned &activity,
   rd = n_rd;
   wr = n_wr + n_pim;
   req = n_req;
+  pim_act = n_pim_act_banks;
+  pim_alu = n_pim_alu_ops;
+  pim_reg = n_pim_reg_accesses;
 }
 
-unsigned dram_t::get_bankgrp_number(unsigned i) {
+unsigned dram_t::get_bankgrp_number(unsigned i) const {
   if (m_config->dram_bnkgrp_indexing_policy == HIGHER_BITS) {  // higher bits
     return i >> m_config->bk_tag_length;
   } else if (m_config->dram_bnkgrp_indexing_policy ==
@@ -1776,3 +1748,69 @@ unsigned dram_t::get_bankgrp_number(unsigned i) {
     assert(1);
   }
 }
+
+const std::vector<unsigned> &dram_t::pim_banks(const dram_req_t *req) const {
+  if (m_config->dram_pim_bankgrp_mode)
+    return m_bkgrp_banks[get_bankgrp_number(req->bk)];
+  return m_all_banks;
+}
+
+enum memory_mode dram_t::bankgrp_mode(unsigned bank) const {
+  return bkgrp[get_bankgrp_number(bank)]->mode;
+}
+
+void dram_t::assign_pim(dram_req_t *req) {
+  for (unsigned b : pim_banks(req)) {
+    bk[b]->mrq = req;
+    bkgrp[get_bankgrp_number(b)]->mode = PIM_MODE;
+  }
+}
+
+const std::vector<unsigned> &dram_t::pim_units(const dram_req_t *req) const {
+  if (m_config->dram_pim_bankgrp_mode)
+    return m_bkgrp_units[get_bankgrp_number(req->bk)];
+  return m_all_units;
+}
+
+enum pim_op_class dram_t::pim_op(const dram_req_t *req) const {
+  if (m_config->dram_pim_op_bit == 0) return PIM_OP_MAC;
+  unsigned op = (req->addr >> m_config->dram_pim_op_bit) & 0x3;
+  return (op < NUM_PIM_OP) ? (enum pim_op_class)op : PIM_OP_MAC;
+}
+
+void dram_t::count_insert(const dram_req_t *req) {
+  const unsigned long long cycle =
+      m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle;
+  if (req->data->is_pim()) {
+    if (first_pim_insert_timestamp == 0) first_pim_insert_timestamp = cycle;
+  } else {
+    if (first_non_pim_insert_timestamp == 0)
+      first_non_pim_insert_timestamp = cycle;
+  }
+}
+
+void dram_t::count_mem_access(bool is_write, bool rowhit) {
+  access_num++;
+  if (is_write)
+    write_num++;
+  else
+    read_num++;
+
+  if (rowhit) {
+    hits_num++;
+    if (is_write)
+      hits_write_num++;
+    else
+      hits_read_num++;
+  }
+}
+
+void dram_t::count_pim_access() {
+  access_num++;
+  pim_num++;
+}
+
+void dram_t::count_pim_row_hit() {
+  hits_num++;
+  hits_pim_num++;
+}
@@ -43,6 +43,7 @@
 #include <algorithm>
 #include <numeric>
 #include "delayqueue.h"
+#include "pim_unit.h"
 
 #define READ 'R'  // define read and write states
 #define WRITE 'W'
@@ -80,6 +81,12 @@ class dram_req_t {
 struct bankgrp_t {
   unsigned int CCDLc;
   unsigned int RTPLc;
+
+  // PIM_MODE while a PIM op occupies the banks of this group
+  // (-dram_pim_bankgrp_mode); MEM requests may use the other groups, and
+  // READ_MODE or WRITE_MODE selects their queue while the channel is in PIM
+  // mode
+  enum memory_mode mode;
 };
 
 struct bank_t {
@@ -127,9 +134,14 @@ class dram_t {
   void visualize() const;
   void print_stat(FILE *simFile);
   unsigned que_length() const;
+  unsigned pim_que_length() const;
   bool returnq_full() const;
   unsigned int queue_limit() const;
   void visualizer_print(gzFile visualizer_file);
+  void register_stats(class stats_registry &reg) const;
+  void get_sample_counters(struct dram_sample_counters &c) const;
+  // end of kernel, before print() and the stats registry dump
+  void finalize_stats();
 
   class mem_fetch *return_queue_pop();
   class mem_fetch *return_queue_top();
@@ -141,12 +153,42 @@ class dram_t {
   class memory_partition_unit *m_memory_partition_unit;
   class gpgpu_sim *m_gpu;
   unsigned int id;
-  enum memory_mode mode;
+
+  // Scheduler interface (see dram_scheduler).  Schedulers read bank and bank
+  // group state through these accessors and only change the DRAM mode and
+  // the statistics below.
+  const bank_t &bank(unsigned b) const { return *bk[b]; }
+  const bankgrp_t &bank_group(unsigned g) const { return *bkgrp[g]; }
+  unsigned get_bankgrp_number(unsigned i) const;
+  // per bank group MEM/PIM mode, see bankgrp_t::mode
+  enum memory_mode bankgrp_mode(unsigned bank) const;
+  // READ_MODE or WRITE_MODE: queue the next MEM request to |bank| comes from
+  enum memory_mode mem_rw_mode(unsigned bank) const {
+    return (mode == PIM_MODE) ? bankgrp_mode(bank) : mode;
+  }
+  // banks a PIM request executes in: all banks, or the bank group that holds
+  // its operands when -dram_pim_bankgrp_mode is set
+  const std::vector<unsigned> &pim_banks(const dram_req_t *req) const;
+  unsigned long long dram_cycle() const { return m_dram_cycle; }
+  unsigned long long pim_accesses() const { return pim_num; }
+  unsigned long long pim_requests() const { return n_pim; }
+
+  enum memory_mode get_mode() const { return mode; }
+  void set_mode(enum memory_mode m) { mode = m; }
+  void count_pim2mem_switch() { pim2nonpimswitches++; }
+  void count_mem2pim_switch() { nonpim2pimswitches++; }
+  void count_insert(const dram_req_t *req);
+  void count_mem_access(bool is_write, bool rowhit);
+  void count_pim_access();
+  void count_pim_row_hit();
 
   // Power Model
+  // pim_act: banks activated by PIM ACTs, pim_alu: PIM ops executed per bank,
+  // pim_reg: PIM register file accesses per bank
   void set_dram_power_stats(unsigned &cmd, unsigned &activity, unsigned &nop,
                             unsigned &act, unsigned &pre, unsigned &rd,
-                            unsigned &wr, unsigned &req) const;
+                            unsigned &wr, unsigned &req, unsigned &pim_act,
+                            unsigned &pim_alu, unsigned &pim_reg) const;
 
   const memory_config *m_config;
 
@@ -155,8 +197,10 @@ class dram_t {
 
   bank_t **bk;
   unsigned int prio;
+  enum memory_mode mode;
 
-  unsigned get_bankgrp_number(unsigned i);
+  std::vector<unsigned> m_all_banks;
+  std::vector<std::vector<unsigned> > m_bkgrp_banks;
 
   unsigned long long m_dram_cycle;
 
@@ -167,6 +211,9 @@ class dram_t {
 
   void scheduler_fifo();
   void scheduler_frfcfs();
+  dram_req_t *schedule_mem(const dram_req_t *pim_next);
+  void update_bankgrp_rw_mode(unsigned bank);
+  void assign_pim(dram_req_t *req);
 
   // Occupancy numbers for FIFO
   unsigned m_num_pending;
@@ -176,8 +223,18 @@ class dram_t {
   bool issue_row_command(int j);
 
   // PIM command issue
-  bool issue_pim_col_command();
-  bool issue_pim_row_command();
+  bool issue_pim_col_command(const std::vector<unsigned> &banks);
+  bool issue_pim_row_command(const std::vector<unsigned> &banks);
+  // a PIM read returns the accumulated result of its row (-dram_pim_unit)
+  bool issue_pim_read_command(const std::vector<unsigned> &banks);
+
+  // PIM compute units (-dram_pim_unit), one per bank or per bank group
+  std::vector<pim_unit> m_pim_units;
+  std::vector<unsigned> m_all_units;
+  std::vector<std::vector<unsigned> > m_bkgrp_units;
+  // units a PIM request executes in, the ones of its pim_banks()
+  const std::vector<unsigned> &pim_units(const dram_req_t *req) const;
+  enum pim_op_class pim_op(const dram_req_t *req) const;
 
   void update_service_latency_stats(dram_req_t *req);
 
@@ -273,6 +330,16 @@ class dram_t {
   unsigned long long nonpim2pimswitches;
   unsigned long long nonpim2pimswitchlatency;
   unsigned long long nonpim2pimswitchconflicts;
+  unsigned long long mem_issued_in_pim_mode;  // -dram_pim_bankgrp_mode
+  unsigned long long pim_unit_ops[NUM_PIM_OP];  // -dram_pim_unit
+  unsigned long long pim_unit_stalls;   // PIM write waited for a busy ALU
+  unsigned long long pim_unit_spills;   // accumulator evicted to its row
+  unsigned long long pim_result_reads;
+  unsigned long long pim_result_waits;  // result read waited for the ALU
+  // PIM energy events, counted per bank (power model)
+  unsigned long long n_pim_act_banks;
+  unsigned long long n_pim_alu_ops;
+  unsigned long long n_pim_reg_accesses;
   unsigned long long first_non_pim_insert_timestamp;
   unsigned long long first_pim_insert_timestamp;
   unsigned long long last_non_pim_finish_timestamp;
@@ -302,21 +369,6 @@ class dram_t {
   std::set<unsigned> m_mem_rows;
   std::set<unsigned> m_pim_rows;
 #endif
-
-  friend class bliss_scheduler;
-  friend class dram_scheduler;
-  friend class frfcfs_scheduler;
-  friend class fr_rr_fcfs_scheduler;
-  friend class gi_scheduler;
-  friend class gi_mem_scheduler;
-  friend class mem_first_scheduler;
-  friend class paws_scheduler;
-  friend class paws_new_scheduler;
-  friend class pim_first_scheduler;
-  friend class pim_frfcfs_scheduler;
-  friend class rr_batch_cap_scheduler;
-  friend class rr_mem_scheduler;
-  friend class rr_req_cap_scheduler;
 };
 
 #endif /*DRAM_H*/
@@ -31,15 +31,78 @@
 #include "gpu-misc.h"
 #include "gpu-sim.h"
 #include "mem_latency_stat.h"
+#include "stats_registry.h"
+
+static dram_scheduler *create_frfcfs(const memory_config *config,
+                                     dram_t *dm, memory_stats_t *stats) {
+  return new dram_scheduler(config, dm, stats, true);
+}
+static dram_scheduler_registrar register_frfcfs("frfcfs", 1, create_frfcfs);
+
+std::vector<dram_scheduler_registry::entry> &
+dram_scheduler_registry::entries() {
+  static std::vector<entry> registered;
+  return registered;
+}
+
+void dram_scheduler_registry::add(const char *name, int legacy_id,
+                                  dram_scheduler_factory factory) {
+  entry e;
+  e.name = name;
+  e.legacy_id = legacy_id;
+  e.factory = factory;
+  entries().push_back(e);
+}
+
+// name is a scheduler name or the numeric id the option used to take
+const dram_scheduler_registry::entry *dram_scheduler_registry::find(
+    const char *name) {
+  char *end;
+  long id = strtol(name, &end, 10);
+  bool numeric = (*name != '\0') && (*end == '\0');
+  for (const entry &e : entries()) {
+    if (numeric ? (e.legacy_id == id) : (e.name == name)) return &e;
+  }
+  return NULL;
+}
+
+bool dram_scheduler_registry::exists(const char *name) {
+  return find(name) != NULL;
+}
+
+dram_scheduler *dram_scheduler_registry::create(const char *name,
+                                                const memory_config *config,
+                                                dram_t *dm,
+                                                memory_stats_t *stats) {
+  const entry *e = find(name);
+  assert(e);
+  dram_scheduler *sched = e->factory(config, dm, stats);
+  if (sched) sched->m_name = e->name;
+  return sched;
+}
+
+void dram_scheduler_registry::print(FILE *fp) {
+  for (const entry &e : entries())
+    fprintf(fp, "  %-14s (%d)\n", e.name.c_str(), e.legacy_id);
+}
 
 dram_scheduler::dram_scheduler(const memory_config *config, dram_t *dm,
-                                   memory_stats_t *stats) {
+                               memory_stats_t *stats, bool frfcfs_switching) {
+  m_frfcfs_switching = frfcfs_switching;
   m_config = config;
   m_stats = stats;
   m_num_pending = 0;
   m_num_write_pending = 0;
   m_num_pim_pending = 0;
   m_dram = dm;
+  m_thr.frfcfs_cap = m_config->frfcfs_cap;
+  m_thr.pim_high_watermark = m_config->pim_high_watermark;
+  m_thr.pim_low_watermark = m_config->pim_low_watermark;
+  m_thr.min_pim_batches = m_config->min_pim_batches;
+  m_thr.max_pim_slowdown = m_config->max_pim_slowdown;
+  m_tuner = NULL;
+  if (m_config->m_sched_tuner_config.policy != DRAM_TUNER_NONE)
+    m_tuner = new dram_sched_tuner(&m_config->m_sched_tuner_config, dm, &m_thr);
   m_queue = new std::list<dram_req_t *>[m_config->nbk];
   m_bins = new std::map<
       unsigned, std::list<std::list<dram_req_t *>::iterator> >[m_config->nbk];
@@ -83,16 +146,15 @@ dram_scheduler::dram_scheduler(const memory_config *config, dram_t *dm,
   m_num_bypasses = 0;
 }
 
+dram_scheduler::~dram_scheduler() { delete m_tuner; }
+
 void dram_scheduler::add_req(dram_req_t *req) {
   if (req->data->is_pim()) {
     assert(m_num_pim_pending < m_config->gpgpu_frfcfs_dram_pim_queue_size);
     m_num_pim_pending++;
     m_pim_queue->push_back(req);
 
-    if (m_dram->first_pim_insert_timestamp == 0) {
-      m_dram->first_pim_insert_timestamp = m_dram->m_gpu->gpu_sim_cycle +
-                                           m_dram->m_gpu->gpu_tot_sim_cycle;
-    }
+    m_dram->count_insert(req);
   } else if (m_config->seperate_write_queue_enabled && req->data->is_write()) {
     assert(m_num_write_pending < m_config->gpgpu_frfcfs_dram_write_queue_size);
     m_num_write_pending++;
@@ -101,10 +163,7 @@ void dram_scheduler::add_req(dram_req_t *req) {
     m_write_bins[req->bk][req->row].push_front(ptr);  // newest reqs to the
                                                       // front
 
-    if (m_dram->first_non_pim_insert_timestamp == 0) {
-      m_dram->first_non_pim_insert_timestamp = m_dram->m_gpu->gpu_sim_cycle +
-                                              m_dram->m_gpu->gpu_tot_sim_cycle;
-    }
+    m_dram->count_insert(req);
   } else {
     assert(m_num_pending < m_config->gpgpu_frfcfs_dram_sched_queue_size);
     m_num_pending++;
@@ -112,10 +171,7 @@ void dram_scheduler::add_req(dram_req_t *req) {
     std::list<dram_req_t *>::iterator ptr = m_queue[req->bk].begin();
     m_bins[req->bk][req->row].push_front(ptr);  // newest reqs to the front
 
-    if (m_dram->first_non_pim_insert_timestamp == 0) {
-      m_dram->first_non_pim_insert_timestamp = m_dram->m_gpu->gpu_sim_cycle +
-                                              m_dram->m_gpu->gpu_tot_sim_cycle;
-    }
+    m_dram->count_insert(req);
   }
 }
 
@@ -177,7 +233,7 @@ void dram_scheduler::update_mode() {
   bool have_mem = have_reads || have_writes;
   bool have_pim = m_num_pim_pending > 0;
 
-  if (m_dram->mode == PIM_MODE) {
+  if (m_dram->get_mode() == PIM_MODE) {
     bool switch_to_mem = false;
 
     if (have_mem) {
@@ -208,8 +264,8 @@ void dram_scheduler::update_mode() {
           }
 
           // 2) CAP is enabled and has been exceeded
-          else if ((m_config->frfcfs_cap > 0) && \
-                   (m_num_bypasses > m_config->frfcfs_cap)) {
+          else if ((m_thr.frfcfs_cap > 0) && \
+                   (m_num_bypasses > m_thr.frfcfs_cap)) {
             switch_to_mem = true;
             m_pim2mem_switch_reason[FRFCFS_CAP_EXCEEDED]++;
           }
@@ -226,8 +282,8 @@ void dram_scheduler::update_mode() {
       m_curr_pim_row = 0;
       m_num_bypasses = 0;
 
-      m_dram->mode = READ_MODE;
-      m_dram->pim2nonpimswitches++;
+      m_dram->set_mode(READ_MODE);
+      m_dram->count_pim2mem_switch();
 
 #ifdef DRAM_SCHED_VERIFY
       printf("DRAM %d: Switching to non-PIM mode\n", m_dram->id);
@@ -261,8 +317,8 @@ void dram_scheduler::update_mode() {
             // requests to the bank.
             m_bank_ready_to_switch[b] = (m_queue[b].size() == 0) || \
                 (m_bank_issued_mem_req[b] && \
-                 !is_next_req_hit(b, m_dram->bk[b]->curr_row,
-                                  m_dram->mode) && \
+                 !is_next_req_hit(b, m_dram->bank(b).curr_row,
+                                  m_dram->get_mode()) && \
                  (m_queue[b].back()->timestamp > \
                   m_pim_queue->front()->timestamp));
           }
@@ -276,8 +332,8 @@ void dram_scheduler::update_mode() {
 
         if (is_pim_oldest) { m_num_bypasses++; }
 
-        if ((m_config->frfcfs_cap > 0) && \
-            (m_num_bypasses > m_config->frfcfs_cap)) {
+        if ((m_thr.frfcfs_cap > 0) && \
+            (m_num_bypasses > m_thr.frfcfs_cap)) {
           switch_to_pim = true;
           m_mem2pim_switch_reason[FRFCFS_CAP_EXCEEDED]++;
         }
@@ -296,8 +352,8 @@ void dram_scheduler::update_mode() {
           false);
       m_num_bypasses = 0;
 
-      m_dram->mode = PIM_MODE;
-      m_dram->nonpim2pimswitches++;
+      m_dram->set_mode(PIM_MODE);
+      m_dram->count_mem2pim_switch();
 
 #ifdef DRAM_SCHED_VERIFY
       printf("DRAM %d: Switching to PIM mode\n", m_dram->id);
@@ -313,18 +369,18 @@ void dram_scheduler::update_rw_mode() {
   bool have_writes = m_num_write_pending > 0;
   bool have_mem = have_reads || have_writes;
 
-  if (m_dram->mode != PIM_MODE) {
+  if (m_dram->get_mode() != PIM_MODE) {
     if (m_config->seperate_write_queue_enabled) {
-      if (m_dram->mode == READ_MODE &&
+      if (m_dram->get_mode() == READ_MODE &&
           ((m_num_write_pending >= m_config->write_high_watermark)
            || (!have_reads && have_writes)
            )) {
-        m_dram->mode = WRITE_MODE;
-      } else if (m_dram->mode == WRITE_MODE &&
+        m_dram->set_mode(WRITE_MODE);
+      } else if (m_dram->get_mode() == WRITE_MODE &&
                  ((m_num_write_pending < m_config->write_low_watermark)
                   || (have_reads && !have_writes)
                   )) {
-        m_dram->mode = READ_MODE;
+        m_dram->set_mode(READ_MODE);
       }
     }
   }
@@ -339,14 +395,13 @@ dram_req_t *dram_scheduler::schedule(unsigned bank, unsigned curr_row) {
   std::list<std::list<dram_req_t *>::iterator> **m_current_last_row =
       m_last_row;
 
-  if (m_dram->mode == WRITE_MODE) {
+  if (m_dram->mem_rw_mode(bank) == WRITE_MODE) {
     m_current_queue = m_write_queue;
     m_current_bins = m_write_bins;
     m_current_last_row = m_last_write_row;
   }
 
-  if ((m_config->scheduler_type == DRAM_FRFCFS) || \
-      (m_config->scheduler_type == DRAM_BLISS)) {
+  if (m_frfcfs_switching) {
     m_bank_issued_mem_req[bank] = true;
 
     if (m_bank_ready_to_switch[bank]) {
@@ -376,20 +431,7 @@ dram_req_t *dram_scheduler::schedule(unsigned bank, unsigned curr_row) {
   dram_req_t *req = (*next);
 
   // rowblp stats
-  m_dram->access_num++;
-  bool is_write = req->data->is_write();
-  if (is_write)
-    m_dram->write_num++;
-  else
-    m_dram->read_num++;
-
-  if (rowhit) {
-    m_dram->hits_num++;
-    if (is_write)
-      m_dram->hits_write_num++;
-    else
-      m_dram->hits_read_num++;
-  }
+  m_dram->count_mem_access(req->data->is_write(), rowhit);
 
   m_stats->concurrent_row_access[m_dram->id][bank]++;
   m_stats->row_access[m_dram->id][bank]++;
@@ -425,15 +467,13 @@ dram_req_t *dram_scheduler::schedule_pim() {
   m_pim_queue->pop_front();
   m_num_pim_pending--;
 
-  m_dram->access_num++;
-  m_dram->pim_num++;
+  m_dram->count_pim_access();
 
-  for (unsigned int b = 0; b < m_config->nbk; b++) {
-    bool rowhit = m_dram->bk[b]->curr_row == req->row;
+  for (unsigned b : m_dram->pim_banks(req)) {
+    bool rowhit = m_dram->bank(b).curr_row == req->row;
 
     if (rowhit) {
-      m_dram->hits_num++;
-      m_dram->hits_pim_num++;
+      m_dram->count_pim_row_hit();
     } else {
       data_collection(b);
     }
@@ -442,8 +482,7 @@ dram_req_t *dram_scheduler::schedule_pim() {
     m_stats->row_access[m_dram->id][b]++;
   }
 
-  if ((m_config->scheduler_type == DRAM_FRFCFS) || \
-      (m_config->scheduler_type == DRAM_BLISS)) {
+  if (m_frfcfs_switching) {
     m_curr_pim_row = req->row;
   }
 
@@ -456,6 +495,76 @@ void dram_scheduler::print(FILE *fp) {
   }
 }
 
+void dram_scheduler::print_stats(FILE *fp) {
+  if (!m_frfcfs_switching) return;
+
+  fprintf(fp, "\nMEM2PIM Switch Breakdown:\n");
+  for (int i = 0; i < FRFCFS_NUM_SWITCH_REASONS; i++) {
+    fprintf(fp, "  %s: %d\n", frfcfs_switch_reason_str[i].c_str(),
+            m_mem2pim_switch_reason[static_cast<frfcfs_switch_reason>(i)]);
+  }
+
+  fprintf(fp, "\nPIM2MEM Switch Breakdown:\n");
+  for (int i = 0; i < FRFCFS_NUM_SWITCH_REASONS; i++) {
+    fprintf(fp, "  %s: %d\n", frfcfs_switch_reason_str[i].c_str(),
+            m_pim2mem_switch_reason[static_cast<frfcfs_switch_reason>(i)]);
+  }
+}
+
+void dram_scheduler::register_stats(stats_registry &reg,
+                                    const std::string &prefix) const {
+  // only the FR-FCFS switching policy (FR-FCFS, BLISS) records these
+  if (!m_frfcfs_switching) return;
+  reg.add_map(prefix + "mem2pim_switch_reason", &m_mem2pim_switch_reason);
+  reg.add_map(prefix + "pim2mem_switch_reason", &m_pim2mem_switch_reason);
+}
+
+// While the channel is in PIM mode, the bank groups PIM does not occupy
+// switch between the read and write queues on their own, with the same
+// watermarks as the channel in update_rw_mode().
+void dram_t::update_bankgrp_rw_mode(unsigned bank) {
+  bankgrp_t *grp = bkgrp[get_bankgrp_number(bank)];
+  const unsigned writes = m_scheduler->num_write_pending();
+  const bool have_reads = m_scheduler->num_pending() > 0;
+
+  if (!m_config->seperate_write_queue_enabled) {
+    grp->mode = READ_MODE;
+  } else if (grp->mode == READ_MODE &&
+             ((writes >= m_config->write_high_watermark) ||
+              (!have_reads && writes > 0))) {
+    grp->mode = WRITE_MODE;
+  } else if (grp->mode == WRITE_MODE &&
+             ((writes < m_config->write_low_watermark) ||
+              (have_reads && writes == 0))) {
+    grp->mode = READ_MODE;
+  }
+}
+
+// Issue one MEM request to a free bank.  Banks of the bank group |pim_next|
+// is waiting for are skipped so that the PIM op is not starved.
+dram_req_t *dram_t::schedule_mem(const dram_req_t *pim_next) {
+  unsigned i;
+  for (i = 0; i < m_config->nbk; i++) {
+    unsigned b = (i + prio) % m_config->nbk;
+    if (bankgrp_mode(b) == PIM_MODE) continue;
+    if (pim_next &&
+        (get_bankgrp_number(b) == get_bankgrp_number(pim_next->bk)))
+      continue;
+    if (!bk[b]->mrq) {
+      if (mode == PIM_MODE) update_bankgrp_rw_mode(b);
+      dram_req_t *req = m_scheduler->schedule(b, bk[b]->curr_row);
+
+      if (req) {
+        prio = (prio + 1) % m_config->nbk;
+        bk[b]->mrq = req;
+
+        return req;
+      }
+    }
+  }
+  return NULL;
+}
+
 void dram_t::scheduler_frfcfs() {
   dram_req_t *req = NULL;
   dram_scheduler *sched = m_scheduler;
@@ -483,6 +592,7 @@ void dram_t::scheduler_frfcfs() {
 
   enum memory_mode prev_mode = mode;
 
+  sched->adapt_thresholds();
   sched->update_mode();
 
   if ((prev_mode != PIM_MODE) && (mode == PIM_MODE)) {
@@ -493,7 +603,7 @@ void dram_t::scheduler_frfcfs() {
 
       // Ensure we do not record row buffer hits after we switch back from PIM
       // to non-PIM
-      sched->m_last_row[b] = NULL;
+      sched->forget_last_row(b);
     }
   }
 
@@ -501,7 +611,15 @@ void dram_t::scheduler_frfcfs() {
     bool can_schedule = true;
     bool waiting_for_nonpim = false;
 
-    for (unsigned b = 0; b < m_config->nbk; b++) {
+    // in bank-group mode only the group of the next PIM op has to drain
+    const dram_req_t *pim_next = NULL;
+    const std::vector<unsigned> *banks = &m_all_banks;
+    if (m_config->dram_pim_bankgrp_mode) {
+      pim_next = sched->next_pim();
+      if (pim_next) banks = &pim_banks(pim_next);
+    }
+
+    for (unsigned b : *banks) {
       if (bk[b]->mrq) {
         can_schedule = false;
         waiting_for_nonpim = waiting_for_nonpim || !bk[b]->mrq->data->is_pim();
@@ -515,32 +633,23 @@ void dram_t::scheduler_frfcfs() {
       req = sched->schedule_pim();
 
       if (req) {
-        for (unsigned b = 0; b < m_config->nbk; b++) {
-          bk[b]->mrq = req;
-        }
+        assign_pim(req);
       }
     }
 
+    // MEM requests keep flowing to the bank groups PIM does not need
+    if (!req && m_config->dram_pim_bankgrp_mode) {
+      req = schedule_mem(pim_next);
+      if (req) mem_issued_in_pim_mode++;
+    }
+
     if ((sched->num_pending() + sched->num_write_pending()) > 0) {
       non_pim_queueing_delay++;
     }
   }
 
   else {
-    unsigned i;
-    for (i = 0; i < m_config->nbk; i++) {
-      unsigned b = (i + prio) % m_config->nbk;
-      if (!bk[b]->mrq) {
-        req = sched->schedule(b, bk[b]->curr_row);
-
-        if (req) {
-          prio = (prio + 1) % m_config->nbk;
-          bk[b]->mrq = req;
-
-          break;
-        }
-      }
-    }
+    req = schedule_mem(NULL);
 
     if (sched->num_pim_pending() > 0) {
       pim_queueing_delay++;
@@ -29,8 +29,10 @@
 #ifndef __DRAM_SCHED_H__
 #define __DRAM_SCHED_H__
 
+#include <cmath>
 #include <list>
 #include <map>
+#include <string>
 #include "dram.h"
 #include "gpu-misc.h"
 #include "gpu-sim.h"
@@ -46,20 +48,48 @@ enum frfcfs_switch_reason {
 const std::string frfcfs_switch_reason_str[] = {"OldestFirst", "OutOfRequests",
   "CapExceeded"};
 
+// Base DRAM scheduler (FR-FCFS).  Schedulers see the DRAM through the
+// scheduler interface of dram_t only: a read-only view of bank and bank group
+// state, the MEM/PIM mode and the row locality counters.
 class dram_scheduler {
  public:
+  // frfcfs_switching: banks stop taking MEM requests while they drain for a
+  // pending switch to PIM mode (FR-FCFS, BLISS)
   dram_scheduler(const memory_config *config, dram_t *dm,
-                   memory_stats_t *stats);
+                 memory_stats_t *stats, bool frfcfs_switching = false);
+  virtual ~dram_scheduler();
   virtual void add_req(dram_req_t *req);
   void data_collection(unsigned bank);
   bool is_next_req_hit(unsigned bank, unsigned curr_row,
       enum memory_mode mode);
 
   virtual void update_mode();
+  // lets the -dram_sched_tuner retune m_thr, called before update_mode()
+  void adapt_thresholds() {
+    if (m_tuner) m_tuner->cycle();
+  }
+  const dram_sched_tuner *tuner() const { return m_tuner; }
   virtual dram_req_t *schedule(unsigned bank, unsigned curr_row);
   virtual dram_req_t *schedule_pim();
+  // PIM request schedule_pim() would return next, or NULL
+  virtual dram_req_t *next_pim() const {
+    return m_pim_queue->empty() ? NULL : m_pim_queue->front();
+  }
 
   void print(FILE *fp);
+  // policy specific statistics, in the stats registry under
+  // dram[<id>].<name>.
+  virtual void print_stats(FILE *fp);
+  // closes the open batch of the batch statistics at the end of a kernel
+  virtual void finalize_stats() {}
+  virtual void register_stats(class stats_registry &reg,
+                              const std::string &prefix) const;
+  const std::string &name() const { return m_name; }
+
+  // rows opened before a MEM -> PIM switch no longer count as hits
+  void forget_last_row(unsigned bank) {
+    m_last_row[bank] = NULL;
+  }
   unsigned num_pending() const { return m_num_pending; }
   unsigned num_write_pending() const { return m_num_write_pending; }
   unsigned num_pim_pending() const { return m_num_pim_pending; }
@@ -77,7 +107,13 @@ class dram_scheduler {
  protected:
   void update_rw_mode();
 
+  bool m_frfcfs_switching;
+  std::string m_name;
   const memory_config *m_config;
+  // switching thresholds of this channel, the configured ones unless
+  // -dram_sched_tuner is on
+  dram_sched_thresholds m_thr;
+  dram_sched_tuner *m_tuner;
   dram_t *m_dram;
   unsigned m_num_pending;
   unsigned m_num_write_pending;
@@ -98,7 +134,75 @@ class dram_scheduler {
 
   memory_stats_t *m_stats;
 
-  friend class dram_t;
+  friend class dram_scheduler_registry;
 };
 
+typedef dram_scheduler *(*dram_scheduler_factory)(const memory_config *config,
+                                                  dram_t *dm,
+                                                  memory_stats_t *stats);
+
+// Schedulers selected by name with -gpgpu_dram_scheduler.  The numeric ids the
+// option used to take are accepted as aliases.  A NULL scheduler is
+// the built-in FIFO scheduler of dram_t.
+class dram_scheduler_registry {
+ public:
+  static void add(const char *name, int legacy_id,
+                  dram_scheduler_factory factory);
+  static bool exists(const char *name);
+  static dram_scheduler *create(const char *name, const memory_config *config,
+                                dram_t *dm, memory_stats_t *stats);
+  static void print(FILE *fp);
+
+ private:
+  struct entry {
+    std::string name;
+    int legacy_id;
+    dram_scheduler_factory factory;
+  };
+  static std::vector<entry> &entries();
+  static const entry *find(const char *name);
+};
+
+struct dram_scheduler_registrar {
+  dram_scheduler_registrar(const char *name, int legacy_id,
+                           dram_scheduler_factory factory) {
+    dram_scheduler_registry::add(name, legacy_id, factory);
+  }
+};
+
+// Registers CLASS under NAME; use once in the scheduler's .cc file.
+#define REGISTER_DRAM_SCHEDULER(NAME, LEGACY_ID, CLASS)                    \
+  static dram_scheduler *create_##CLASS(const memory_config *config,       \
+                                        dram_t *dm, memory_stats_t *stats) { \
+    return new CLASS(config, dm, stats);                                   \
+  }                                                                        \
+  static dram_scheduler_registrar register_##CLASS(NAME, LEGACY_ID,        \
+                                                   create_##CLASS)
+
+// mean, standard deviation and maximum of v
+template <class T>
+std::vector<T> get_stats(std::vector<T> *v) {
+  double sum = 0;
+  double mean = 0;
+  double sq = 0;
+  double stdev = 0;
+  double max = 0;
+  unsigned long long len = v->size();
+
+  if (len > 0) {
+    sum = std::accumulate(v->begin(), v->end(), 0.0);
+    mean = sum / len;
+    sq = std::inner_product(v->begin(), v->end(), v->begin(), 0.0);
+    stdev = std::sqrt(sq / len - mean * mean);
+    max = *std::max_element(std::begin(*v), std::end(*v));
+  }
+
+  std::vector<T> retval;
+  retval.push_back((T) mean);
+  retval.push_back((T) stdev);
+  retval.push_back((T) max);
+
+  return retval;
+}
+
 #endif
@@ -4,9 +4,10 @@
 #include "gpu-misc.h"
 #include "gpu-sim.h"
 #include "mem_latency_stat.h"
+#include "stats_registry.h"
 
 bliss_scheduler::bliss_scheduler(const memory_config *config,
-    dram_t *dm, memory_stats_t *stats) : dram_scheduler(config, dm, stats) {
+    dram_t *dm, memory_stats_t *stats) : dram_scheduler(config, dm, stats, true) {
   m_pim_queue_it =
       new std::list<std::list<dram_req_t *>::iterator>[m_config->nbk];
 
@@ -30,7 +31,7 @@ bliss_scheduler::bliss_scheduler(const memory_config *config,
 }
 
 void bliss_scheduler::update_mode() {
-  if ((m_dram->m_dram_cycle % m_config->bliss_clearing_interval) == 0) {
+  if ((m_dram->dram_cycle() % m_config->bliss_clearing_interval) == 0) {
     m_requests_served = 0;
     m_prev_request_type = REQ_NONE;
     is_pim_blacklisted = false;
@@ -42,29 +43,29 @@ void bliss_scheduler::update_mode() {
   }
 
   if (is_pim_blacklisted != is_mem_blacklisted) {
-    enum memory_mode prev_mode = m_dram->mode;
+    enum memory_mode prev_mode = m_dram->get_mode();
 
     if (is_pim_blacklisted) {
-      if (m_num_pending > 0)          { m_dram->mode = READ_MODE; }
-      else if (m_num_pim_pending > 0) { m_dram->mode = PIM_MODE; }
+      if (m_num_pending > 0)          { m_dram->set_mode(READ_MODE); }
+      else if (m_num_pim_pending > 0) { m_dram->set_mode(PIM_MODE); }
 
       m_cycles_pim_blacklisted++;
     }
 
     else {
-      if (m_num_pim_pending > 0)  { m_dram->mode = PIM_MODE; }
-      else if (m_num_pending > 0) { m_dram->mode = READ_MODE; }
+      if (m_num_pim_pending > 0)  { m_dram->set_mode(PIM_MODE); }
+      else if (m_num_pending > 0) { m_dram->set_mode(READ_MODE); }
 
       m_cycles_mem_blacklisted++;
     }
 
-    if (prev_mode != m_dram->mode) {
+    if (prev_mode != m_dram->get_mode()) {
       if (prev_mode == PIM_MODE) {
         // Reset FR-FCFS state
         m_curr_pim_row = 0;
         m_num_bypasses = 0;
 
-        m_dram->pim2nonpimswitches++;
+        m_dram->count_pim2mem_switch();
 
 #ifdef DRAM_SCHED_VERIFY
         printf("DRAM: Switching to non-PIM mode\n");
@@ -77,7 +78,7 @@ void bliss_scheduler::update_mode() {
             false);
         m_num_bypasses = 0;
 
-        m_dram->nonpim2pimswitches++;
+        m_dram->count_mem2pim_switch();
 
 #ifdef DRAM_SCHED_VERIFY
         printf("DRAM: Switching to PIM mode\n");
@@ -155,3 +156,27 @@ void bliss_scheduler::update_blacklist(request_type req_type)
     m_requests_served = 0;
   }
 }
+
+void bliss_scheduler::print_stats(FILE *fp) {
+  fprintf(fp, "\nBlacklist statistics\n");
+  fprintf(fp, "Total cycles = %llu\n", m_dram->dram_cycle());
+  fprintf(fp, "Cycles none blacklisted = %llu\n",
+      m_cycles_none_blacklisted);
+  fprintf(fp, "Cycles both blacklisted = %llu\n",
+      m_cycles_both_blacklisted);
+  fprintf(fp, "Cycles PIM blacklisted = %llu\n",
+      m_cycles_pim_blacklisted);
+  fprintf(fp, "Cycles MEM blacklisted = %llu\n",
+      m_cycles_mem_blacklisted);
+}
+
+void bliss_scheduler::register_stats(stats_registry &reg,
+                                     const std::string &prefix) const {
+  dram_scheduler::register_stats(reg, prefix);
+  reg.add(prefix + "cycles_none_blacklisted", &m_cycles_none_blacklisted);
+  reg.add(prefix + "cycles_both_blacklisted", &m_cycles_both_blacklisted);
+  reg.add(prefix + "cycles_pim_blacklisted", &m_cycles_pim_blacklisted);
+  reg.add(prefix + "cycles_mem_blacklisted", &m_cycles_mem_blacklisted);
+}
+
+REGISTER_DRAM_SCHEDULER("bliss", 7, bliss_scheduler);
@@ -15,6 +15,9 @@ class bliss_scheduler : public dram_scheduler {
  public:
   bliss_scheduler(const memory_config *config, dram_t *dm,
                    memory_stats_t *stats);
+  void print_stats(FILE *fp) override;
+  void register_stats(class stats_registry &reg,
+                      const std::string &prefix) const override;
   void update_mode() override;
   dram_req_t *schedule(unsigned bank, unsigned curr_row) override;
   dram_req_t *schedule_pim() override;
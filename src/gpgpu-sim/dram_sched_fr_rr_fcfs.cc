@@ -4,6 +4,7 @@
 #include "gpu-misc.h"
 #include "gpu-sim.h"
 #include "mem_latency_stat.h"
+#include "stats_registry.h"
 
 fr_rr_fcfs_scheduler::fr_rr_fcfs_scheduler(const memory_config *config,
         dram_t *dm, memory_stats_t *stats) :
@@ -26,29 +27,29 @@ void fr_rr_fcfs_scheduler::add_req(dram_req_t *req) {
 }
 
 void fr_rr_fcfs_scheduler::update_mode() {
-  enum memory_mode prev_mode = m_dram->mode;
+  enum memory_mode prev_mode = m_dram->get_mode();
 
   // Switch to MEM mode if
-  if ((m_dram->mode == PIM_MODE) && (m_num_pending > 0)) {
+  if ((m_dram->get_mode() == PIM_MODE) && (m_num_pending > 0)) {
     if (m_num_pim_pending == 0) {
       // 1) There are no more PIM requests
-      m_dram->mode = READ_MODE;
+      m_dram->set_mode(READ_MODE);
       m_pim2mem_switch_reason.push_back(FR_RR_FCFS_OUT_OF_REQUESTS);
     } else {
       // 2) PIM has row buffer conflict
       dram_req_t *req = m_pim_queue->front();
       if ((m_last_pim_row != 0) && (req->row != m_last_pim_row)) {
-        m_dram->mode = READ_MODE;
+        m_dram->set_mode(READ_MODE);
         m_pim2mem_switch_reason.push_back(FR_RR_FCFS_ROW_BUFFER_CONFLICT);
       }
     }
   }
 
   // Switch to PIM mode if
-  else if ((m_dram->mode != PIM_MODE) && (m_num_pim_pending > 0)) {
+  else if ((m_dram->get_mode() != PIM_MODE) && (m_num_pim_pending > 0)) {
     if (m_num_pending == 0) {
       // 1) There are no more MEM requests
-      m_dram->mode = PIM_MODE;
+      m_dram->set_mode(PIM_MODE);
       m_mem2pim_switch_reason.push_back(FR_RR_FCFS_OUT_OF_REQUESTS);
     } else {
       // 2) Every bank has had a row buffer conflict
@@ -63,9 +64,9 @@ void fr_rr_fcfs_scheduler::update_mode() {
           // Otherwise, we perform the row buffer hit test once a request has
           // been issued
           if ((m_bank_pending_mem_requests[b] > 0) && \
-              (m_dram->bk[b]->mrq != NULL)) {
-            can_bank_switch = !is_next_req_hit(b, m_dram->bk[b]->curr_row,
-                                               m_dram->mode);
+              (m_dram->bank(b).mrq != NULL)) {
+            can_bank_switch = !is_next_req_hit(b, m_dram->bank(b).curr_row,
+                                               m_dram->get_mode());
           }
 
           m_bank_switch_to_pim[b] = can_bank_switch;
@@ -75,15 +76,15 @@ void fr_rr_fcfs_scheduler::update_mode() {
       }
 
       if (switch_to_pim) {
-        m_dram->mode = PIM_MODE;
+        m_dram->set_mode(PIM_MODE);
         m_mem2pim_switch_reason.push_back(FR_RR_FCFS_ROW_BUFFER_CONFLICT);
       }
     }
   }
 
-  if (m_dram->mode != prev_mode) {
+  if (m_dram->get_mode() != prev_mode) {
     if (prev_mode == PIM_MODE) {
-      m_dram->pim2nonpimswitches++;
+      m_dram->count_pim2mem_switch();
 
       m_pim_requests_issued.push_back(m_num_exec_pim);  // Stat
 
@@ -93,7 +94,7 @@ void fr_rr_fcfs_scheduler::update_mode() {
       printf("DRAM: Switching to non-PIM mode\n");
 #endif
     } else {
-      m_dram->nonpim2pimswitches++;
+      m_dram->count_mem2pim_switch();
 
       m_max_mem_requests_issued_at_any_bank.push_back(*max_element(
                   m_num_exec_mem_per_bank.begin(),
@@ -141,3 +142,45 @@ dram_req_t *fr_rr_fcfs_scheduler::schedule_pim() {
 
   return req;
 }
+
+void fr_rr_fcfs_scheduler::print_stats(FILE *fp) {
+  std::vector<unsigned> stats = get_stats<unsigned>(
+      &(m_max_mem_requests_issued_at_any_bank));
+
+  fprintf(fp, "\nAvgMemRequestsIssuedPerBank = %u", stats[0]);
+  fprintf(fp, "\nMaxMemRequestsIssuedPerBank = %u", stats[2]);
+  fprintf(fp, "\nStDevMemRequestsIssuedPerBank = %u", stats[1]);
+
+  stats = get_stats<unsigned>(&(m_pim_requests_issued));
+
+  fprintf(fp, "\nAvgPimRequestsIssued = %u", stats[0]);
+  fprintf(fp, "\nMaxPimRequestsIssued = %u", stats[2]);
+  fprintf(fp, "\nStDevPimRequestsIssued = %u", stats[1]);
+
+  fprintf(fp, "\nMEM2PIM Switch Breakdown:\n");
+  for (int i = 0; i < FR_RR_FCFS_NUM_SWITCH_REASONS; i++) {
+    unsigned count = std::count(m_mem2pim_switch_reason.begin(),
+        m_mem2pim_switch_reason.end(), i);
+    fprintf(fp, "  %s: %u\n", fr_rr_fcfs_switch_reason_str[i].c_str(), count);
+  }
+
+  fprintf(fp, "\nPIM2MEM Switch Breakdown:\n");
+  for (int i = 0; i < FR_RR_FCFS_NUM_SWITCH_REASONS; i++) {
+    unsigned count = std::count(m_pim2mem_switch_reason.begin(),
+        m_pim2mem_switch_reason.end(), i);
+    fprintf(fp, "  %s: %u\n", fr_rr_fcfs_switch_reason_str[i].c_str(), count);
+  }
+}
+
+void fr_rr_fcfs_scheduler::register_stats(stats_registry &reg,
+                                          const std::string &prefix) const {
+  reg.add_series(prefix + "mem_requests_issued_per_bank",
+                 &m_max_mem_requests_issued_at_any_bank);
+  reg.add_series(prefix + "pim_requests_issued", &m_pim_requests_issued);
+  reg.add_histogram(prefix + "mem2pim_switch_reason", &m_mem2pim_switch_reason,
+                    FR_RR_FCFS_NUM_SWITCH_REASONS);
+  reg.add_histogram(prefix + "pim2mem_switch_reason", &m_pim2mem_switch_reason,
+                    FR_RR_FCFS_NUM_SWITCH_REASONS);
+}
+
+REGISTER_DRAM_SCHEDULER("fr_rr_fcfs", 8, fr_rr_fcfs_scheduler);
@@ -22,6 +22,9 @@ class fr_rr_fcfs_scheduler : public dram_scheduler {
  public:
   fr_rr_fcfs_scheduler(const memory_config *config, dram_t *dm,
           memory_stats_t *stats);
+  void print_stats(FILE *fp) override;
+  void register_stats(class stats_registry &reg,
+                      const std::string &prefix) const override;
   void add_req(dram_req_t *req) override;
   void update_mode() override;
   dram_req_t *schedule(unsigned bank, unsigned curr_row) override;
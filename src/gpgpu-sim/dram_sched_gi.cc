@@ -21,23 +21,23 @@ void gi_scheduler::update_mode() {
 
   bool have_pim = !m_pim_queue->empty();
 
-  if (m_dram->mode == PIM_MODE) {
-    if ((m_num_pim_pending < m_config->pim_low_watermark)
+  if (m_dram->get_mode() == PIM_MODE) {
+    if ((m_num_pim_pending < m_thr.pim_low_watermark)
         && (have_reads || have_writes)) {
       // Just switch to READ_MODE. The following code sequence will take care
       // of deciding whether we stay in READ_MODE or switch to WRITE_MODE.
-      m_dram->mode = READ_MODE;
-      m_dram->pim2nonpimswitches++;
+      m_dram->set_mode(READ_MODE);
+      m_dram->count_pim2mem_switch();
 
 #ifdef DRAM_SCHED_VERIFY
       printf("DRAM: Switching to non-PIM mode\n");
 #endif
     }
   } else {
-    if ((m_num_pim_pending >= m_config->pim_high_watermark)
+    if ((m_num_pim_pending >= m_thr.pim_high_watermark)
         || (!have_reads && !have_writes && have_pim)) {
-      m_dram->mode = PIM_MODE;
-      m_dram->nonpim2pimswitches++;
+      m_dram->set_mode(PIM_MODE);
+      m_dram->count_mem2pim_switch();
 
 #ifdef DRAM_SCHED_VERIFY
       printf("DRAM: Switching to PIM mode\n");
@@ -47,3 +47,5 @@ void gi_scheduler::update_mode() {
 
   update_rw_mode();
 }
+
+REGISTER_DRAM_SCHEDULER("gi", 5, gi_scheduler);
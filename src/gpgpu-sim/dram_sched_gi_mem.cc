@@ -20,12 +20,12 @@ void gi_mem_scheduler::update_mode() {
 
   bool have_pim = !m_pim_queue->empty();
 
-  if (m_dram->mode == PIM_MODE) {
+  if (m_dram->get_mode() == PIM_MODE) {
     if ((m_num_pending >= m_config->queue_high_watermark) || \
         (m_num_write_pending >= m_config->write_high_watermark) || \
         (!have_pim && have_mem)) {
-      m_dram->mode = READ_MODE;
-      m_dram->pim2nonpimswitches++;
+      m_dram->set_mode(READ_MODE);
+      m_dram->count_pim2mem_switch();
 
 #ifdef DRAM_SCHED_VERIFY
       printf("DRAM: Switching to non-PIM mode\n");
@@ -35,8 +35,8 @@ void gi_mem_scheduler::update_mode() {
     if (((m_num_pending < m_config->queue_low_watermark) && \
          (m_num_write_pending < m_config->write_high_watermark)) || \
         (have_pim && !have_mem)) {
-      m_dram->mode = PIM_MODE;
-      m_dram->nonpim2pimswitches++;
+      m_dram->set_mode(PIM_MODE);
+      m_dram->count_mem2pim_switch();
 
 #ifdef DRAM_SCHED_VERIFY
       printf("DRAM: Switching to PIM mode\n");
@@ -46,3 +46,5 @@ void gi_mem_scheduler::update_mode() {
 
   update_rw_mode();
 }
+
+REGISTER_DRAM_SCHEDULER("gi_mem", 6, gi_mem_scheduler);
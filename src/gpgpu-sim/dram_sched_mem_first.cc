@@ -13,18 +13,20 @@ void mem_first_scheduler::update_mode() {
   bool have_mem = (m_num_pending + m_num_write_pending) > 0;
   bool have_pim = m_num_pim_pending > 0;
 
-  if (m_dram->mode == PIM_MODE) {
+  if (m_dram->get_mode() == PIM_MODE) {
     if (have_mem) {
-      m_dram->mode = READ_MODE;
-      m_dram->pim2nonpimswitches++;
+      m_dram->set_mode(READ_MODE);
+      m_dram->count_pim2mem_switch();
       update_rw_mode();
     }
   }
 
   else {
     if (!have_mem && have_pim) {
-      m_dram->mode = PIM_MODE;
-      m_dram->nonpim2pimswitches++;
+      m_dram->set_mode(PIM_MODE);
+      m_dram->count_mem2pim_switch();
     }
   }
 }
+
+REGISTER_DRAM_SCHEDULER("mem_first", 3, mem_first_scheduler);
@@ -1,9 +1,12 @@
+#include <algorithm>
+#include <numeric>
 #include "dram_sched.h"
 #include "dram_sched_paws.h"
 #include "../abstract_hardware_model.h"
 #include "gpu-misc.h"
 #include "gpu-sim.h"
 #include "mem_latency_stat.h"
+#include "stats_registry.h"
 
 paws_scheduler::paws_scheduler(const memory_config *config, dram_t *dm,
         memory_stats_t *stats) : dram_scheduler(config, dm, stats) {
@@ -34,10 +37,7 @@ void paws_scheduler::add_req(dram_req_t *req) {
       m_pim_queue_it[b].push_front(ptr);
     }
 
-    if (m_dram->first_pim_insert_timestamp == 0) {
-      m_dram->first_pim_insert_timestamp = m_dram->m_gpu->gpu_sim_cycle +
-                                           m_dram->m_gpu->gpu_tot_sim_cycle;
-    }
+    m_dram->count_insert(req);
   }
 
   else {
@@ -50,30 +50,27 @@ void paws_scheduler::add_req(dram_req_t *req) {
 
     m_bank_pending_mem_requests[req->bk]++;
 
-    if (m_dram->first_non_pim_insert_timestamp == 0) {
-      m_dram->first_non_pim_insert_timestamp = m_dram->m_gpu->gpu_sim_cycle +
-                                              m_dram->m_gpu->gpu_tot_sim_cycle;
-    }
+    m_dram->count_insert(req);
   }
 }
 
 void paws_scheduler::update_mode() {
-  enum memory_mode prev_mode = m_dram->mode;
+  enum memory_mode prev_mode = m_dram->get_mode();
 
   // Switch to MEM mode if
-  if (m_dram->mode == PIM_MODE) {
-    bool threshold_exceeded = (m_config->frfcfs_cap > 0) && \
-                              (m_num_exec_pim > m_config->frfcfs_cap);
+  if (m_dram->get_mode() == PIM_MODE) {
+    bool threshold_exceeded = (m_thr.frfcfs_cap > 0) && \
+                              (m_num_exec_pim > m_thr.frfcfs_cap);
 
     if (threshold_exceeded && (m_num_pending > 0)) {
       // 1) Executed PIM requests have crossed a threshold, or
-      m_dram->mode = READ_MODE;
+      m_dram->set_mode(READ_MODE);
       m_pim2mem_switch_reason.push_back(PAWS_CAP_EXCEEDED);
     } else {
       if (m_num_pim_pending == 0) {
         // 2) There are no more PIM requests and there are MEM requests, or
         if (m_num_pending > 0) {
-          m_dram->mode = READ_MODE;
+          m_dram->set_mode(READ_MODE);
           m_pim2mem_switch_reason.push_back(PAWS_OUT_OF_REQUESTS);
         }
       } else {
@@ -82,7 +79,7 @@ void paws_scheduler::update_mode() {
           for (unsigned b = 0; b < m_config->nbk; b++) {
             if (!m_queue[b].empty() && !m_queue[b].back()->data->is_pim()) {
               // 3) PIM has row buffer miss and the oldest request is MEM
-              m_dram->mode = READ_MODE;
+              m_dram->set_mode(READ_MODE);
               m_pim2mem_switch_reason.push_back(PAWS_OLDEST_FIRST);
               break;
             }
@@ -107,13 +104,13 @@ void paws_scheduler::update_mode() {
 
     if (threshold_exceeded && (m_num_pim_pending > 0)) {
       // 1) Executed MEM requests have crossed a threshold, or
-      m_dram->mode = PIM_MODE;
+      m_dram->set_mode(PIM_MODE);
       m_mem2pim_switch_reason.push_back(PAWS_CAP_EXCEEDED);
     } else {
       if (m_num_pending == 0) {
         // 2) There are no more MEM requests and there are PIM requests, or
         if (m_num_pim_pending > 0) {
-          m_dram->mode = PIM_MODE;
+          m_dram->set_mode(PIM_MODE);
           m_mem2pim_switch_reason.push_back(PAWS_OUT_OF_REQUESTS);
         }
       } else {
@@ -131,9 +128,9 @@ void paws_scheduler::update_mode() {
           // Otherwise, we perform the row buffer hit test once a request has
           // been issued
           if ((m_bank_pending_mem_requests[b] > 0) && \
-              (m_dram->bk[b]->mrq != NULL)) {
-            can_bank_switch = !is_next_req_hit(b, m_dram->bk[b]->curr_row,
-                                               m_dram->mode) && \
+              (m_dram->bank(b).mrq != NULL)) {
+            can_bank_switch = !is_next_req_hit(b, m_dram->bank(b).curr_row,
+                                               m_dram->get_mode()) && \
                               m_queue[b].back()->data->is_pim();
           }
 
@@ -144,7 +141,7 @@ void paws_scheduler::update_mode() {
         }
 
         if (switch_to_pim) {
-            m_dram->mode = PIM_MODE;
+            m_dram->set_mode(PIM_MODE);
             m_mem2pim_switch_reason.push_back(PAWS_OLDEST_FIRST);
         }
 
@@ -167,9 +164,9 @@ void paws_scheduler::update_mode() {
     }
   }
 
-  if (m_dram->mode != prev_mode) {
+  if (m_dram->get_mode() != prev_mode) {
     if (prev_mode == PIM_MODE) {
-      m_dram->pim2nonpimswitches++;
+      m_dram->count_pim2mem_switch();
 
       m_pim_requests_issued.push_back(m_num_exec_pim);  // Stat
 
@@ -179,7 +176,7 @@ void paws_scheduler::update_mode() {
       printf("DRAM: Switching to non-PIM mode\n");
 #endif
     } else {
-      m_dram->nonpim2pimswitches++;
+      m_dram->count_mem2pim_switch();
 
       m_max_mem_requests_issued_at_any_bank.push_back(*max_element(
                   m_num_exec_mem_per_bank.begin(),
@@ -189,8 +186,8 @@ void paws_scheduler::update_mode() {
           false);
 
       m_max_exec_mem_per_bank = \
-          std::min(m_config->frfcfs_cap, m_num_exec_pim) * \
-          m_config->max_pim_slowdown;
+          std::min(m_thr.frfcfs_cap, m_num_exec_pim) * \
+          m_thr.max_pim_slowdown;
       std::fill(m_num_exec_mem_per_bank.begin(), m_num_exec_mem_per_bank.end(),
           0);
 
@@ -259,20 +256,7 @@ dram_req_t *paws_scheduler::schedule(unsigned bank, unsigned curr_row) {
   m_num_exec_mem_per_bank[bank]++;
 
   // rowblp stats
-  m_dram->access_num++;
-  bool is_write = req->data->is_write();
-  if (is_write)
-    m_dram->write_num++;
-  else
-    m_dram->read_num++;
-
-  if (rowhit) {
-    m_dram->hits_num++;
-    if (is_write)
-      m_dram->hits_write_num++;
-    else
-      m_dram->hits_read_num++;
-  }
+  m_dram->count_mem_access(req->data->is_write(), rowhit);
 
   m_stats->concurrent_row_access[m_dram->id][bank]++;
   m_stats->row_access[m_dram->id][bank]++;
@@ -308,7 +292,7 @@ dram_req_t *paws_scheduler::schedule_pim() {
   dram_req_t *req = *(m_pim_queue_it[0].back());
 
   for (unsigned int bank = 0; bank < m_config->nbk; bank++) {
-    unsigned curr_row = m_dram->bk[bank]->curr_row;
+    unsigned curr_row = m_dram->bank(bank).curr_row;
 
     std::list<dram_req_t *>::iterator next = m_pim_queue_it[bank].back();
     dram_req_t *bank_req = *(next);
@@ -317,13 +301,8 @@ dram_req_t *paws_scheduler::schedule_pim() {
     if (!rowhit) { data_collection(bank); }
 
     // rowblp stats
-    m_dram->access_num++;
-    m_dram->pim_num++;
-
-    if (rowhit) {
-      m_dram->hits_num++;
-      m_dram->hits_pim_num++;
-    }
+    m_dram->count_pim_access();
+    if (rowhit) { m_dram->count_pim_row_hit(); }
 
     m_stats->concurrent_row_access[m_dram->id][bank]++;
     m_stats->row_access[m_dram->id][bank]++;
@@ -345,3 +324,105 @@ dram_req_t *paws_scheduler::schedule_pim() {
 
   return req;
 }
+
+void paws_scheduler::print_stats(FILE *fp) {
+  fprintf(fp, "\nBank stall time for PIM:\n");
+  for (unsigned b = 0; b < m_config->nbk; b++) {
+    fprintf(fp, "Bank_%d_stall_time = %llu\n", b,m_bank_pim_stall_time[b]);
+  }
+
+  fprintf(fp, "\nBank waste time for PIM:\n");
+  for (unsigned b = 0; b < m_config->nbk; b++) {
+    fprintf(fp, "Bank_%d_waste_time = %llu\n", b,m_bank_pim_waste_time[b]);
+  }
+
+  fprintf(fp, "\nMEM2PIM switch readiness latency:\n");
+
+  double sum = 0;
+  double mean = 0;
+  double sq = 0;
+  double stdev = 0;
+  double max = 0;
+  unsigned long long len = m_mem2pim_switch_latency.size();
+
+  if (len > 0) {
+    sum = std::accumulate(m_mem2pim_switch_latency.begin(),
+        m_mem2pim_switch_latency.end(), 0.0);
+    mean = sum / len;
+    sq = std::inner_product(m_mem2pim_switch_latency.begin(),
+        m_mem2pim_switch_latency.end(),
+        m_mem2pim_switch_latency.begin(), 0.0);
+    stdev = std::sqrt(sq / len - mean * mean);
+    max = *std::max_element(std::begin(m_mem2pim_switch_latency),
+        std::end(m_mem2pim_switch_latency));
+  }
+
+  fprintf(fp, "\nAvgSwitchReadinessLatency = %.6f", mean);
+  fprintf(fp, "\nMaxSwitchReadinessLatency = %.6f", max);
+  fprintf(fp, "\nStDevSwitchReadinessLatency = %.6f", stdev);
+
+  unsigned long long len_non_zeros = len -
+      std::count(m_mem2pim_switch_latency.begin(),
+              m_mem2pim_switch_latency.end(), 0);
+
+  if (len_non_zeros > 0) {
+    mean = sum / len_non_zeros;
+    stdev = std::sqrt(sq / len_non_zeros - mean * mean);
+  }
+
+  fprintf(fp, "\nAvgNonZeroSwitchReadinessLatency = %.6f", mean);
+  fprintf(fp, "\nStDevNonZeroSwitchReadinessLatency = %.6f\n", stdev);
+
+  std::vector<unsigned> stats = get_stats<unsigned>(
+      &(m_mem_cap));
+
+  fprintf(fp, "\nAvgMemCap = %u", stats[0]);
+  fprintf(fp, "\nMaxMemCap = %u", stats[2]);
+  fprintf(fp, "\nStDevMemCap = %u", stats[1]);
+
+  stats = get_stats<unsigned>(
+      &(m_max_mem_requests_issued_at_any_bank));
+
+  fprintf(fp, "\nAvgMemRequestsIssuedPerBank = %u", stats[0]);
+  fprintf(fp, "\nMaxMemRequestsIssuedPerBank = %u", stats[2]);
+  fprintf(fp, "\nStDevMemRequestsIssuedPerBank = %u", stats[1]);
+
+  stats = get_stats<unsigned>(&(m_pim_requests_issued));
+
+  fprintf(fp, "\nAvgPimRequestsIssued = %u", stats[0]);
+  fprintf(fp, "\nMaxPimRequestsIssued = %u", stats[2]);
+  fprintf(fp, "\nStDevPimRequestsIssued = %u", stats[1]);
+
+  fprintf(fp, "\nMEM2PIM Switch Breakdown:\n");
+  for (int i = 0; i < PAWS_NUM_SWITCH_REASONS; i++) {
+    unsigned count = std::count(m_mem2pim_switch_reason.begin(),
+        m_mem2pim_switch_reason.end(), i);
+    fprintf(fp, "  %s: %u\n", paws_switch_reason_str[i].c_str(), count);
+  }
+
+  fprintf(fp, "\nPIM2MEM Switch Breakdown:\n");
+  for (int i = 0; i < PAWS_NUM_SWITCH_REASONS; i++) {
+    unsigned count = std::count(m_pim2mem_switch_reason.begin(),
+        m_pim2mem_switch_reason.end(), i);
+    fprintf(fp, "  %s: %u\n", paws_switch_reason_str[i].c_str(), count);
+  }
+}
+
+void paws_scheduler::register_stats(stats_registry &reg,
+                                    const std::string &prefix) const {
+  reg.add(prefix + "bank_pim_stall_time", &m_bank_pim_stall_time[0],
+          m_config->nbk);
+  reg.add(prefix + "bank_pim_waste_time", &m_bank_pim_waste_time[0],
+          m_config->nbk);
+  reg.add_series(prefix + "mem2pim_switch_latency", &m_mem2pim_switch_latency);
+  reg.add_series(prefix + "mem_cap", &m_mem_cap);
+  reg.add_series(prefix + "mem_requests_issued_per_bank",
+                 &m_max_mem_requests_issued_at_any_bank);
+  reg.add_series(prefix + "pim_requests_issued", &m_pim_requests_issued);
+  reg.add_histogram(prefix + "mem2pim_switch_reason", &m_mem2pim_switch_reason,
+                    PAWS_NUM_SWITCH_REASONS);
+  reg.add_histogram(prefix + "pim2mem_switch_reason", &m_pim2mem_switch_reason,
+                    PAWS_NUM_SWITCH_REASONS);
+}
+
+REGISTER_DRAM_SCHEDULER("paws", 12, paws_scheduler);
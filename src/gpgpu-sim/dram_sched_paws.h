@@ -23,6 +23,9 @@ class paws_scheduler : public dram_scheduler {
  public:
   paws_scheduler(const memory_config *config, dram_t *dm,
           memory_stats_t *stats);
+  void print_stats(FILE *fp) override;
+  void register_stats(class stats_registry &reg,
+                      const std::string &prefix) const override;
   void add_req(dram_req_t *req) override;
   void update_mode() override;
   dram_req_t *schedule(unsigned bank, unsigned curr_row) override;
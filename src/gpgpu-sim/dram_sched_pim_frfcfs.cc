@@ -4,12 +4,12 @@
 #include "gpu-misc.h"
 #include "gpu-sim.h"
 #include "mem_latency_stat.h"
+#include "stats_registry.h"
 
 pim_frfcfs_scheduler::pim_frfcfs_scheduler(const memory_config *config,
     dram_t *dm, memory_stats_t *stats) : dram_scheduler(config, dm, stats)
 {
   m_num_bypasses = 0;
-  m_pim_cap = m_config->frfcfs_cap * m_config->max_pim_slowdown;
 }
 
 void pim_frfcfs_scheduler::update_mode() {
@@ -18,10 +18,11 @@ void pim_frfcfs_scheduler::update_mode() {
   bool have_mem = have_reads || have_writes;
   bool have_pim = m_num_pim_pending > 0;
 
-  if (m_dram->mode == PIM_MODE) {
+  if (m_dram->get_mode() == PIM_MODE) {
     bool cap_exceeded = false;
+    const unsigned pim_cap = m_thr.frfcfs_cap * m_thr.max_pim_slowdown;
 
-    if ((m_pim_cap > 0) && have_mem && have_pim) {
+    if ((pim_cap > 0) && have_mem && have_pim) {
       for (unsigned int b = 0; b < m_config->nbk; b++) {
         if (m_queue[b].size() == 0) { continue; }
 
@@ -35,12 +36,12 @@ void pim_frfcfs_scheduler::update_mode() {
         }
       }
 
-      cap_exceeded = m_num_bypasses > m_pim_cap;
+      cap_exceeded = m_num_bypasses > pim_cap;
     }
 
     if ((have_mem && !have_pim) || cap_exceeded) {
-      m_dram->mode = READ_MODE;
-      m_dram->pim2nonpimswitches++;
+      m_dram->set_mode(READ_MODE);
+      m_dram->count_pim2mem_switch();
       m_num_bypasses = 0;
 
       if (cap_exceeded) {
@@ -58,7 +59,7 @@ void pim_frfcfs_scheduler::update_mode() {
   else {
     bool cap_exceeded = false;
 
-    if ((m_config->frfcfs_cap > 0) && have_mem && have_pim) {
+    if ((m_thr.frfcfs_cap > 0) && have_mem && have_pim) {
       bool is_pim_oldest = true;
 
       for (unsigned int b = 0; b < m_config->nbk; b++) {
@@ -76,12 +77,12 @@ void pim_frfcfs_scheduler::update_mode() {
 
       if (is_pim_oldest) { m_num_bypasses++; }
 
-      cap_exceeded = m_num_bypasses > m_config->frfcfs_cap;
+      cap_exceeded = m_num_bypasses > m_thr.frfcfs_cap;
     }
 
     if ((!have_mem && have_pim) || cap_exceeded) {
-      m_dram->mode = PIM_MODE;
-      m_dram->nonpim2pimswitches++;
+      m_dram->set_mode(PIM_MODE);
+      m_dram->count_mem2pim_switch();
       m_num_bypasses = 0;
 
       if (cap_exceeded) {
@@ -98,3 +99,27 @@ void pim_frfcfs_scheduler::update_mode() {
 
   update_rw_mode();
 }
+
+void pim_frfcfs_scheduler::print_stats(FILE *fp) {
+  fprintf(fp, "\nMEM2PIM Switch Breakdown:\n");
+  for (int i = 0; i < PIM_FRFCFS_NUM_SWITCH_REASONS; i++) {
+    fprintf(fp, "  %s: %d\n", pim_frfcfs_switch_reason_str[i].c_str(),
+        m_mem2pim_switch_reason[
+          static_cast<pim_frfcfs_switch_reason>(i)]);
+  }
+
+  fprintf(fp, "\nPIM2MEM Switch Breakdown:\n");
+  for (int i = 0; i < PIM_FRFCFS_NUM_SWITCH_REASONS; i++) {
+    fprintf(fp, "  %s: %d\n", pim_frfcfs_switch_reason_str[i].c_str(),
+        m_pim2mem_switch_reason[
+          static_cast<pim_frfcfs_switch_reason>(i)]);
+  }
+}
+
+void pim_frfcfs_scheduler::register_stats(stats_registry &reg,
+                                          const std::string &prefix) const {
+  reg.add_map(prefix + "mem2pim_switch_reason", &m_mem2pim_switch_reason);
+  reg.add_map(prefix + "pim2mem_switch_reason", &m_pim2mem_switch_reason);
+}
+
+REGISTER_DRAM_SCHEDULER("pim_frfcfs", 2, pim_frfcfs_scheduler);
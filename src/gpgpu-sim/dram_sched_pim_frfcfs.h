@@ -22,6 +22,9 @@ class pim_frfcfs_scheduler : public dram_scheduler {
  public:
   pim_frfcfs_scheduler(const memory_config *config, dram_t *dm,
          memory_stats_t *stats);
+  void print_stats(FILE *fp) override;
+  void register_stats(class stats_registry &reg,
+                      const std::string &prefix) const override;
   void update_mode() override;
 
   // Stats
@@ -29,7 +32,6 @@ class pim_frfcfs_scheduler : public dram_scheduler {
   std::map<pim_frfcfs_switch_reason, unsigned> m_pim2mem_switch_reason;
 
  private:
-  unsigned m_pim_cap;
   unsigned m_num_bypasses;  // Used to enforce CAP
 };
 
@@ -4,6 +4,7 @@
 #include "gpu-misc.h"
 #include "gpu-sim.h"
 #include "mem_latency_stat.h"
+#include "stats_registry.h"
 
 rr_batch_cap_scheduler::rr_batch_cap_scheduler(const memory_config *config,
     dram_t *dm, memory_stats_t *stats) : dram_scheduler(config, dm, stats) {
@@ -32,13 +33,13 @@ void rr_batch_cap_scheduler::update_mode() {
 
   bool have_pim = !m_pim_queue->empty();
 
-  if (m_dram->mode == PIM_MODE) {
+  if (m_dram->get_mode() == PIM_MODE) {
     // Transaction is over if the next PIM request will access a new row
     bool is_batch_over = (m_pim_batch_start_time > 0) && (!have_pim ||
                           (m_pim_queue->front()->row != m_last_pim_row));
 
     if (is_batch_over) {
-      unsigned long long batch_exec_time = m_dram->m_dram_cycle - \
+      unsigned long long batch_exec_time = m_dram->dram_cycle() - \
                                            m_pim_batch_start_time;
       m_pim_batch_start_time = 0;
       m_pim_batch_exec_time.push_back(batch_exec_time);
@@ -51,19 +52,19 @@ void rr_batch_cap_scheduler::update_mode() {
         printf("DRAM (%d): Batch over; no more requests\n", m_dram->id);
       }
       printf("           Batch execution time = %lld\n", batch_exec_time);
-      printf("           Batch size = %d\n", m_dram->pim_num - prev_pim_num);
+      printf("           Batch size = %d\n", m_dram->pim_accesses() - prev_pim_num);
 #endif
 
       m_finished_batches++;
-      prev_pim_num = m_dram->pim_num;
+      prev_pim_num = m_dram->pim_accesses();
 
-      if (m_finished_batches <= m_config->min_pim_batches) {
-        m_non_pim_to_pim_switch_cycle = m_dram->m_dram_cycle + \
-            (m_config->max_pim_slowdown * m_pim_batch_dur);
+      if (m_finished_batches <= m_thr.min_pim_batches) {
+        m_non_pim_to_pim_switch_cycle = m_dram->dram_cycle() + \
+            (m_thr.max_pim_slowdown * m_pim_batch_dur);
       }
     }
 
-    if (((m_finished_batches >= m_config->min_pim_batches) || !have_pim) && \
+    if (((m_finished_batches >= m_thr.min_pim_batches) || !have_pim) && \
             (have_reads || have_writes)) {
 #ifdef DRAM_SCHED_VERIFY
       printf("DRAM (%d): Switching to non-PIM mode\n", m_dram->id);
@@ -74,25 +75,25 @@ void rr_batch_cap_scheduler::update_mode() {
       m_pim_batch_dur = 0;
       m_finished_batches = 0;
 
-      m_dram->mode = READ_MODE;
-      m_dram->pim2nonpimswitches++;
+      m_dram->set_mode(READ_MODE);
+      m_dram->count_pim2mem_switch();
     }
   }
 
   else {
     if (have_pim) {
-      if ((m_dram->m_dram_cycle > m_non_pim_to_pim_switch_cycle) || \
+      if ((m_dram->dram_cycle() > m_non_pim_to_pim_switch_cycle) || \
           !(have_reads || have_writes)) {
-        m_dram->mode = PIM_MODE;
-        m_dram->nonpim2pimswitches++;
+        m_dram->set_mode(PIM_MODE);
+        m_dram->count_mem2pim_switch();
 
-        m_mem_batch_exec_time.push_back(m_dram->m_dram_cycle - \
+        m_mem_batch_exec_time.push_back(m_dram->dram_cycle() - \
             m_mem_batch_start_time);
         m_mem_batch_start_time = 0;
 
-        if (m_dram->m_dram_cycle < m_non_pim_to_pim_switch_cycle) {
+        if (m_dram->dram_cycle() < m_non_pim_to_pim_switch_cycle) {
           m_mem_wasted_cycles.push_back(m_non_pim_to_pim_switch_cycle - \
-              m_dram->m_dram_cycle);
+              m_dram->dram_cycle());
         }
 
 #ifdef DRAM_SCHED_VERIFY
@@ -109,7 +110,7 @@ dram_req_t *rr_batch_cap_scheduler::schedule(unsigned bank, unsigned curr_row) {
   dram_req_t *req = dram_scheduler::schedule(bank, curr_row);
 
   if (req && (m_mem_batch_start_time == 0)) {
-    m_mem_batch_start_time = m_dram->m_dram_cycle;
+    m_mem_batch_start_time = m_dram->dram_cycle();
   }
 
   return req;
@@ -120,7 +121,7 @@ dram_req_t *rr_batch_cap_scheduler::schedule_pim() {
 
   if (req) {
     if (m_pim_batch_start_time == 0) {
-      m_pim_batch_start_time = m_dram->m_dram_cycle;
+      m_pim_batch_start_time = m_dram->dram_cycle();
     }
 
     m_last_pim_row = req->row;
@@ -131,19 +132,56 @@ dram_req_t *rr_batch_cap_scheduler::schedule_pim() {
 
 void rr_batch_cap_scheduler::finalize_stats()
 {
-  if (m_dram->mode == PIM_MODE) {
-    unsigned long long batch_exec_time = m_dram->m_dram_cycle - \
+  if (m_dram->get_mode() == PIM_MODE) {
+    unsigned long long batch_exec_time = m_dram->dram_cycle() - \
                                          m_pim_batch_start_time;
     m_pim_batch_exec_time.push_back(batch_exec_time);
   }
 
   else {
-    m_mem_batch_exec_time.push_back(m_dram->m_dram_cycle - \
+    m_mem_batch_exec_time.push_back(m_dram->dram_cycle() - \
         m_mem_batch_start_time);
 
-    if (m_dram->m_dram_cycle < m_non_pim_to_pim_switch_cycle) {
+    if (m_dram->dram_cycle() < m_non_pim_to_pim_switch_cycle) {
       m_mem_wasted_cycles.push_back(m_non_pim_to_pim_switch_cycle - \
-          m_dram->m_dram_cycle);
+          m_dram->dram_cycle());
     }
   }
 }
+
+void rr_batch_cap_scheduler::print_stats(FILE *fp) {
+  std::vector<unsigned long long> stats = get_stats<unsigned long long>(
+      &(m_pim_batch_exec_time));
+
+  fprintf(fp, "\nAvgPimBatchExecTime = %llu", stats[0]);
+  fprintf(fp, "\nMaxPimBatchExecTime = %llu", stats[2]);
+  fprintf(fp, "\nStDevPimBatchExecTime = %llu", stats[1]);
+
+  unsigned len = m_pim_batch_exec_time.size();
+  double avg_batch_size = 0;
+  if (len > 0) { avg_batch_size = m_dram->pim_requests() / len; }
+  fprintf(fp, "\nAvgPimBatchSize = %.6f\n", avg_batch_size);
+
+  // MEM batch execution time
+  stats = get_stats<unsigned long long>(&(m_mem_batch_exec_time));
+
+  fprintf(fp, "\nAvgMemBatchExecTime = %llu", stats[0]);
+  fprintf(fp, "\nMaxMemBatchExecTime = %llu", stats[2]);
+  fprintf(fp, "\nStDevMemBatchExecTime = %llu\n", stats[1]);
+
+  // Wasted MEM batch cycles
+  stats = get_stats<unsigned long long>(&(m_mem_wasted_cycles));
+
+  fprintf(fp, "\nAvgMemWastedCycles = %llu", stats[0]);
+  fprintf(fp, "\nMaxMemWastedCycles = %llu", stats[2]);
+  fprintf(fp, "\nStDevMemWastedCycles = %llu\n", stats[1]);
+}
+
+void rr_batch_cap_scheduler::register_stats(stats_registry &reg,
+                                            const std::string &prefix) const {
+  reg.add_series(prefix + "pim_batch_exec_time", &m_pim_batch_exec_time);
+  reg.add_series(prefix + "mem_batch_exec_time", &m_mem_batch_exec_time);
+  reg.add_series(prefix + "mem_wasted_cycles", &m_mem_wasted_cycles);
+}
+
+REGISTER_DRAM_SCHEDULER("rr_batch_cap", 9, rr_batch_cap_scheduler);
@@ -12,11 +12,14 @@ class rr_batch_cap_scheduler : public dram_scheduler {
  public:
   rr_batch_cap_scheduler(const memory_config *config, dram_t *dm,
       memory_stats_t *stats);
+  void print_stats(FILE *fp) override;
+  void register_stats(class stats_registry &reg,
+                      const std::string &prefix) const override;
   void update_mode() override;
   dram_req_t *schedule(unsigned bank, unsigned curr_row) override;
   dram_req_t *schedule_pim() override;
 
-  void finalize_stats();
+  void finalize_stats() override;
 
   // Additional stats for research
   std::vector<unsigned long long> m_pim_batch_exec_time;
@@ -26,7 +26,7 @@ void rr_mem_scheduler::update_mode() {
   bool have_mem = have_reads || have_writes;
   bool have_pim = !m_pim_queue->empty();
 
-  if (m_dram->mode == PIM_MODE) {
+  if (m_dram->get_mode() == PIM_MODE) {
     if (have_mem && ((m_num_pim_executed > m_pim_cap) || !have_pim)) {
       m_num_pim_executed = 0;
       m_pim_cap = 0;
@@ -35,24 +35,24 @@ void rr_mem_scheduler::update_mode() {
       printf("DRAM (%d): Switching to MEM mode\n", m_dram->id);
 #endif
 
-      m_dram->mode = READ_MODE;
-      m_dram->pim2nonpimswitches++;
+      m_dram->set_mode(READ_MODE);
+      m_dram->count_pim2mem_switch();
     }
   }
 
   else {
-    if (have_pim && ((m_num_mem_executed > m_config->frfcfs_cap) || \
+    if (have_pim && ((m_num_mem_executed > m_thr.frfcfs_cap) || \
           !have_mem)) {
       // Use the minimum of executed requests and CAP to set the PIM cap
       m_pim_cap = std::min(m_num_mem_executed,
-          (unsigned long long) m_config->frfcfs_cap);
+          (unsigned long long) m_thr.frfcfs_cap);
 
       // Round the CAP up to the nearest multiple of PIM_GRANULARITY
       m_pim_cap = ((m_pim_cap + RR_MEM_PIM_GRANULARITY - 1) / \
           RR_MEM_PIM_GRANULARITY) * RR_MEM_PIM_GRANULARITY;
 
       // Scale the cap according to the QoS specification
-      m_pim_cap *= m_config->max_pim_slowdown;
+      m_pim_cap *= m_thr.max_pim_slowdown;
 
       m_num_mem_executed = 0;
 
@@ -60,8 +60,8 @@ void rr_mem_scheduler::update_mode() {
       printf("DRAM (%d): Switching to PIM mode\n", m_dram->id);
 #endif
 
-      m_dram->mode = PIM_MODE;
-      m_dram->nonpim2pimswitches++;
+      m_dram->set_mode(PIM_MODE);
+      m_dram->count_mem2pim_switch();
     }
   }
 
@@ -87,3 +87,5 @@ dram_req_t *rr_mem_scheduler::schedule_pim() {
 
   return req;
 }
+
+REGISTER_DRAM_SCHEDULER("rr_mem", 11, rr_mem_scheduler);
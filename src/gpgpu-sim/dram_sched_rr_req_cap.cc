@@ -4,6 +4,7 @@
 #include "gpu-misc.h"
 #include "gpu-sim.h"
 #include "mem_latency_stat.h"
+#include "stats_registry.h"
 
 rr_req_cap_scheduler::rr_req_cap_scheduler(const memory_config *config,
     dram_t *dm, memory_stats_t *stats) : dram_scheduler(config, dm, stats) {
@@ -29,18 +30,18 @@ void rr_req_cap_scheduler::update_mode() {
   bool have_mem = have_reads || have_writes;
   bool have_pim = !m_pim_queue->empty();
 
-  if (m_dram->mode == PIM_MODE) {
-    if (m_num_pim_executed <= m_config->min_pim_batches) {
-      m_pim_batch_dur = m_dram->m_dram_cycle - m_pim_batch_start_time;
+  if (m_dram->get_mode() == PIM_MODE) {
+    if (m_num_pim_executed <= m_thr.min_pim_batches) {
+      m_pim_batch_dur = m_dram->dram_cycle() - m_pim_batch_start_time;
     }
 
-    if (((m_num_pim_executed >= m_config->min_pim_batches) || !have_pim) && \
+    if (((m_num_pim_executed >= m_thr.min_pim_batches) || !have_pim) && \
         have_mem) {
-      unsigned long long tot_pim_exec_time = m_dram->m_dram_cycle - \
+      unsigned long long tot_pim_exec_time = m_dram->dram_cycle() - \
                                              m_pim_batch_start_time;
 
-      m_non_pim_to_pim_switch_cycle = m_dram->m_dram_cycle + \
-          (m_config->max_pim_slowdown * m_pim_batch_dur);
+      m_non_pim_to_pim_switch_cycle = m_dram->dram_cycle() + \
+          (m_thr.max_pim_slowdown * m_pim_batch_dur);
 
       m_num_pim_executed = 0;
       m_pim_batch_start_time = 0;
@@ -59,24 +60,24 @@ void rr_req_cap_scheduler::update_mode() {
       printf("           Requests executed = %d\n", m_num_pim_executed);
 #endif
 
-      m_dram->mode = READ_MODE;
-      m_dram->pim2nonpimswitches++;
+      m_dram->set_mode(READ_MODE);
+      m_dram->count_pim2mem_switch();
     }
   }
 
   else {
-    if (((m_dram->m_dram_cycle > m_non_pim_to_pim_switch_cycle) || \
+    if (((m_dram->dram_cycle() > m_non_pim_to_pim_switch_cycle) || \
          !have_mem) && have_pim) {
-      m_dram->mode = PIM_MODE;
-      m_dram->nonpim2pimswitches++;
+      m_dram->set_mode(PIM_MODE);
+      m_dram->count_mem2pim_switch();
 
-      m_mem_batch_exec_time.push_back(m_dram->m_dram_cycle - \
+      m_mem_batch_exec_time.push_back(m_dram->dram_cycle() - \
           m_mem_batch_start_time);
       m_mem_batch_start_time = 0;
 
-      if (m_dram->m_dram_cycle < m_non_pim_to_pim_switch_cycle) {
+      if (m_dram->dram_cycle() < m_non_pim_to_pim_switch_cycle) {
         m_mem_wasted_cycles.push_back(m_non_pim_to_pim_switch_cycle - \
-            m_dram->m_dram_cycle);
+            m_dram->dram_cycle());
       }
 
 #ifdef DRAM_SCHED_VERIFY
@@ -94,7 +95,7 @@ dram_req_t *rr_req_cap_scheduler::schedule(unsigned bank, unsigned curr_row) {
   dram_req_t *req = dram_scheduler::schedule(bank, curr_row);
 
   if (req && (m_mem_batch_start_time == 0)) {
-    m_mem_batch_start_time = m_dram->m_dram_cycle;
+    m_mem_batch_start_time = m_dram->dram_cycle();
   }
 
   return req;
@@ -105,7 +106,7 @@ dram_req_t *rr_req_cap_scheduler::schedule_pim() {
 
   if (req) {
     if (m_pim_batch_start_time == 0) {
-      m_pim_batch_start_time = m_dram->m_dram_cycle;
+      m_pim_batch_start_time = m_dram->dram_cycle();
     }
 
     m_num_pim_executed++;
@@ -116,19 +117,56 @@ dram_req_t *rr_req_cap_scheduler::schedule_pim() {
 
 void rr_req_cap_scheduler::finalize_stats()
 {
-  if (m_dram->mode == PIM_MODE) {
-    unsigned long long tot_pim_exec_time = m_dram->m_dram_cycle - \
+  if (m_dram->get_mode() == PIM_MODE) {
+    unsigned long long tot_pim_exec_time = m_dram->dram_cycle() - \
                                            m_pim_batch_start_time;
     m_pim_batch_exec_time.push_back(tot_pim_exec_time);
   }
 
   else {
-    m_mem_batch_exec_time.push_back(m_dram->m_dram_cycle - \
+    m_mem_batch_exec_time.push_back(m_dram->dram_cycle() - \
         m_mem_batch_start_time);
 
-    if (m_dram->m_dram_cycle < m_non_pim_to_pim_switch_cycle) {
+    if (m_dram->dram_cycle() < m_non_pim_to_pim_switch_cycle) {
       m_mem_wasted_cycles.push_back(m_non_pim_to_pim_switch_cycle - \
-          m_dram->m_dram_cycle);
+          m_dram->dram_cycle());
     }
   }
 }
+
+void rr_req_cap_scheduler::print_stats(FILE *fp) {
+  std::vector<unsigned long long> stats = get_stats<unsigned long long>(
+      &(m_pim_batch_exec_time));
+
+  fprintf(fp, "\nAvgPimBatchExecTime = %llu", stats[0]);
+  fprintf(fp, "\nMaxPimBatchExecTime = %llu", stats[2]);
+  fprintf(fp, "\nStDevPimBatchExecTime = %llu", stats[1]);
+
+  unsigned len = m_pim_batch_exec_time.size();
+  double avg_batch_size = 0;
+  if (len > 0) { avg_batch_size = m_dram->pim_requests() / len; }
+  fprintf(fp, "\nAvgPimBatchSize = %.6f\n", avg_batch_size);
+
+  // MEM batch execution time
+  stats = get_stats<unsigned long long>(&(m_mem_batch_exec_time));
+
+  fprintf(fp, "\nAvgMemBatchExecTime = %llu", stats[0]);
+  fprintf(fp, "\nMaxMemBatchExecTime = %llu", stats[2]);
+  fprintf(fp, "\nStDevMemBatchExecTime = %llu\n", stats[1]);
+
+  // Wasted MEM batch cycles
+  stats = get_stats<unsigned long long>(&(m_mem_wasted_cycles));
+
+  fprintf(fp, "\nAvgMemWastedCycles = %llu", stats[0]);
+  fprintf(fp, "\nMaxMemWastedCycles = %llu", stats[2]);
+  fprintf(fp, "\nStDevMemWastedCycles = %llu\n", stats[1]);
+}
+
+void rr_req_cap_scheduler::register_stats(stats_registry &reg,
+                                          const std::string &prefix) const {
+  reg.add_series(prefix + "pim_batch_exec_time", &m_pim_batch_exec_time);
+  reg.add_series(prefix + "mem_batch_exec_time", &m_mem_batch_exec_time);
+  reg.add_series(prefix + "mem_wasted_cycles", &m_mem_wasted_cycles);
+}
+
+REGISTER_DRAM_SCHEDULER("rr_req_cap", 10, rr_req_cap_scheduler);
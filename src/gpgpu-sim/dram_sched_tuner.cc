@@ -0,0 +1,261 @@
+#include "dram_sched_tuner.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dram.h"
+#include "gpu-sim.h"
+
+#define DRAM_TUNER_DEFAULT_EPOCH 10000
+
+// threshold scalings the bandit chooses from, arm 2 is the configuration
+static const double bandit_scales[] = {0.25, 0.5, 1.0, 2.0, 4.0};
+static const unsigned n_bandit_arms =
+    sizeof(bandit_scales) / sizeof(bandit_scales[0]);
+
+// hill climbing knobs, each one a scaling of a configured threshold
+enum dram_tuner_knob {
+  KNOB_FRFCFS_CAP = 0,
+  KNOB_PIM_HIGH_WATERMARK,
+  KNOB_PIM_LOW_WATERMARK,
+  KNOB_MIN_PIM_BATCHES,
+  KNOB_MAX_PIM_SLOWDOWN,
+  NUM_KNOBS
+};
+static const char *knob_str[] = {"frfcfs_cap", "pim_high_watermark",
+                                 "pim_low_watermark", "min_pim_batches",
+                                 "max_pim_slowdown"};
+#define HILL_STEP 1.25
+#define HILL_MAX_SCALE 16.0
+
+static FILE *tuner_log = NULL;
+
+void dram_sched_tuner_config::init(const char *opt, const char *log) {
+  char name[16];
+  unsigned e = DRAM_TUNER_DEFAULT_EPOCH;
+  log_file = log;
+  int n = sscanf(opt, "%15[^:]:%u", name, &e);
+  if (n < 1 || strcmp(name, "none") == 0) {
+    policy = DRAM_TUNER_NONE;
+    return;
+  }
+  if (strcmp(name, "bandit") == 0) {
+    policy = DRAM_TUNER_BANDIT;
+  } else if (strcmp(name, "hill") == 0) {
+    policy = DRAM_TUNER_HILL;
+  } else {
+    printf("GPGPU-Sim uArch: invalid -dram_sched_tuner \"%s\"\n", opt);
+    abort();
+  }
+  if (e == 0) {
+    printf("GPGPU-Sim uArch: -dram_sched_tuner epoch must be > 0\n");
+    abort();
+  }
+  epoch = e;
+}
+
+dram_sched_tuner::dram_sched_tuner(const dram_sched_tuner_config *config,
+                                   const dram_t *dram,
+                                   dram_sched_thresholds *thresholds) {
+  m_config = config;
+  m_dram = dram;
+  m_thr = thresholds;
+  m_base = *thresholds;
+  m_epoch_cycle = 0;
+  memset(&m_last, 0, sizeof(m_last));
+
+  m_arm = 2;
+  m_arm_pulls.resize(n_bandit_arms, 0);
+  m_arm_reward.resize(n_bandit_arms, 0.0);
+
+  m_scale.resize(NUM_KNOBS, 1.0);
+  m_dir.resize(NUM_KNOBS, 1);
+  m_knob = 0;
+  m_last_cost = 0.0;
+  m_moved = false;
+
+  n_epochs = 0;
+  n_changes = 0;
+
+  if (!tuner_log) {
+    tuner_log = fopen(m_config->log_file, "w");
+    if (!tuner_log) {
+      printf("GPGPU-Sim uArch: cannot open -dram_sched_tuner_log \"%s\"\n",
+             m_config->log_file);
+      abort();
+    }
+    fprintf(tuner_log,
+            "# dram_cycle channel policy cost decision frfcfs_cap "
+            "pim_high_watermark pim_low_watermark min_pim_batches "
+            "max_pim_slowdown\n");
+  }
+}
+
+void dram_sched_tuner::cycle() {
+  if (++m_epoch_cycle < m_config->epoch) return;
+  m_epoch_cycle = 0;
+
+  double cost;
+  if (!epoch_cost(cost)) return;
+  n_epochs++;
+  if (m_config->policy == DRAM_TUNER_BANDIT)
+    bandit_step(cost);
+  else
+    hill_step(cost);
+}
+
+// Stall cycles per serviced request over the last epoch.  Epochs without
+// both MEM and PIM traffic say nothing about the switching thresholds and
+// are skipped.
+bool dram_sched_tuner::epoch_cost(double &cost) {
+  dram_sample_counters c;
+  m_dram->get_sample_counters(c);
+  const dram_sample_counters &l = m_last;
+  unsigned long long n_mem = (c.n_rd - l.n_rd) + (c.n_wr - l.n_wr);
+  unsigned long long n_pim = c.n_pim - l.n_pim;
+  unsigned long long stall =
+      (c.mem_queueing_delay - l.mem_queueing_delay) +
+      (c.pim_queueing_delay - l.pim_queueing_delay) +
+      (c.mem2pim_switch_latency - l.mem2pim_switch_latency) +
+      (c.mem2pim_switch_conflicts - l.mem2pim_switch_conflicts);
+  m_last = c;
+  if (n_mem == 0 || n_pim == 0) return false;
+  cost = (double)stall / (n_mem + n_pim);
+  return true;
+}
+
+// Derives the thresholds from the configured ones and the knob scalings.
+// Thresholds configured as 0 (disabled) stay disabled.
+void dram_sched_tuner::set_scale(unsigned knob, double scale) {
+  if (scale > HILL_MAX_SCALE) scale = HILL_MAX_SCALE;
+  if (scale < 1.0 / HILL_MAX_SCALE) scale = 1.0 / HILL_MAX_SCALE;
+  m_scale[knob] = scale;
+
+  const unsigned queue_size =
+      m_dram->m_config->gpgpu_frfcfs_dram_pim_queue_size;
+  dram_sched_thresholds &t = *m_thr;
+  const dram_sched_thresholds &b = m_base;
+  if (b.frfcfs_cap) {
+    t.frfcfs_cap = (unsigned)(b.frfcfs_cap * m_scale[KNOB_FRFCFS_CAP] + 0.5);
+    if (t.frfcfs_cap < 1) t.frfcfs_cap = 1;
+  }
+  if (b.pim_high_watermark) {
+    t.pim_high_watermark = (unsigned)(
+        b.pim_high_watermark * m_scale[KNOB_PIM_HIGH_WATERMARK] + 0.5);
+    if (queue_size && t.pim_high_watermark > queue_size)
+      t.pim_high_watermark = queue_size;
+    if (t.pim_high_watermark < 2) t.pim_high_watermark = 2;
+  }
+  if (b.pim_low_watermark) {
+    t.pim_low_watermark = (unsigned)(
+        b.pim_low_watermark * m_scale[KNOB_PIM_LOW_WATERMARK] + 0.5);
+    if (t.pim_high_watermark && t.pim_low_watermark >= t.pim_high_watermark)
+      t.pim_low_watermark = t.pim_high_watermark - 1;
+    if (t.pim_low_watermark < 1) t.pim_low_watermark = 1;
+  }
+  if (b.min_pim_batches) {
+    t.min_pim_batches = (unsigned)(
+        b.min_pim_batches * m_scale[KNOB_MIN_PIM_BATCHES] + 0.5);
+    if (t.min_pim_batches < 1) t.min_pim_batches = 1;
+  }
+  if (b.max_pim_slowdown > 0) {
+    t.max_pim_slowdown =
+        b.max_pim_slowdown * m_scale[KNOB_MAX_PIM_SLOWDOWN];
+    if (t.max_pim_slowdown < 1.0) t.max_pim_slowdown = 1.0;
+  }
+}
+
+// UCB1: every arm is tried once, then the arm with the best mean reward plus
+// exploration bonus is played for the next epoch.
+void dram_sched_tuner::bandit_step(double cost) {
+  m_arm_pulls[m_arm]++;
+  m_arm_reward[m_arm] += (1.0 / (1.0 + cost) - m_arm_reward[m_arm]) /
+                         m_arm_pulls[m_arm];
+
+  unsigned next = n_bandit_arms;
+  unsigned long long total = 0;
+  for (unsigned a = 0; a < n_bandit_arms; a++) {
+    total += m_arm_pulls[a];
+    if (m_arm_pulls[a] == 0 && next == n_bandit_arms) next = a;
+  }
+  if (next == n_bandit_arms) {
+    double best = -1.0;
+    for (unsigned a = 0; a < n_bandit_arms; a++) {
+      double ucb = m_arm_reward[a] + sqrt(2.0 * log((double)total) /
+                                          m_arm_pulls[a]);
+      if (ucb > best) {
+        best = ucb;
+        next = a;
+      }
+    }
+  }
+
+  if (next != m_arm) n_changes++;
+  m_arm = next;
+  for (unsigned k = 0; k < NUM_KNOBS; k++)
+    set_scale(k, bandit_scales[m_arm]);
+
+  char what[32];
+  snprintf(what, sizeof(what), "arm=%g", bandit_scales[m_arm]);
+  log_decision(what, cost);
+}
+
+// Moves one threshold per epoch by HILL_STEP.  A move that raised the cost
+// is undone and the knob's direction reversed; knobs are visited in turn.
+void dram_sched_tuner::hill_step(double cost) {
+  if (m_moved && cost > m_last_cost) {
+    set_scale(m_knob, m_dir[m_knob] > 0 ? m_scale[m_knob] / HILL_STEP
+                                        : m_scale[m_knob] * HILL_STEP);
+    m_dir[m_knob] = -m_dir[m_knob];
+    char what[48];
+    snprintf(what, sizeof(what), "revert=%s", knob_str[m_knob]);
+    log_decision(what, cost);
+  } else {
+    m_last_cost = cost;
+  }
+
+  // next knob whose threshold is enabled
+  const float base[NUM_KNOBS] = {
+      (float)m_base.frfcfs_cap, (float)m_base.pim_high_watermark,
+      (float)m_base.pim_low_watermark, (float)m_base.min_pim_batches,
+      m_base.max_pim_slowdown};
+  unsigned k = m_moved ? (m_knob + 1) % NUM_KNOBS : m_knob;
+  unsigned tries = 0;
+  while (base[k] == 0 && tries++ < NUM_KNOBS) k = (k + 1) % NUM_KNOBS;
+  m_moved = (base[k] != 0);
+  if (!m_moved) return;
+
+  m_knob = k;
+  set_scale(k, m_dir[k] > 0 ? m_scale[k] * HILL_STEP : m_scale[k] / HILL_STEP);
+  n_changes++;
+  char what[48];
+  snprintf(what, sizeof(what), "%s%s", m_dir[k] > 0 ? "+" : "-",
+           knob_str[k]);
+  log_decision(what, cost);
+}
+
+void dram_sched_tuner::log_decision(const char *what, double cost) const {
+  const dram_sched_thresholds &t = *m_thr;
+  fprintf(tuner_log, "%llu %u %s %.4f %s %u %u %u %u %.3f\n",
+          m_dram->dram_cycle(), m_dram->id,
+          m_config->policy == DRAM_TUNER_BANDIT ? "bandit" : "hill", cost,
+          what, t.frfcfs_cap, t.pim_high_watermark, t.pim_low_watermark,
+          t.min_pim_batches, t.max_pim_slowdown);
+}
+
+void dram_sched_tuner::print(FILE *fp) const {
+  const dram_sched_thresholds &t = *m_thr;
+  fprintf(fp,
+          "\nScheduler tuner (%s): epochs = %llu, changes = %llu\n"
+          "  frfcfs_cap = %u, pim_watermarks = %u:%u, min_pim_batches = %u, "
+          "max_pim_slowdown = %.3f\n",
+          m_config->policy == DRAM_TUNER_BANDIT ? "bandit" : "hill", n_epochs,
+          n_changes, t.frfcfs_cap, t.pim_high_watermark, t.pim_low_watermark,
+          t.min_pim_batches, t.max_pim_slowdown);
+  if (m_config->policy == DRAM_TUNER_BANDIT) {
+    for (unsigned a = 0; a < n_bandit_arms; a++)
+      fprintf(fp, "  arm %g: pulls = %u, mean reward = %.4f\n",
+              bandit_scales[a], m_arm_pulls[a], m_arm_reward[a]);
+  }
+  fflush(tuner_log);
+}
@@ -0,0 +1,92 @@
+#ifndef __DRAM_SCHED_TUNER_H__
+#define __DRAM_SCHED_TUNER_H__
+
+#include <stdio.h>
+#include <vector>
+#include "mem_timeseries.h"
+
+class dram_t;
+
+// PIM/MEM switching thresholds a DRAM scheduler works with.  They start out
+// as -frfcfs_cap, -dram_pim_queue_size, -dram_min_pim_batches and
+// -dram_max_pim_slowdown and are retuned at run time when -dram_sched_tuner
+// is set.
+struct dram_sched_thresholds {
+  unsigned frfcfs_cap;
+  unsigned pim_high_watermark;
+  unsigned pim_low_watermark;
+  unsigned min_pim_batches;
+  float max_pim_slowdown;
+};
+
+enum dram_sched_tuner_policy {
+  DRAM_TUNER_NONE = 0,
+  DRAM_TUNER_BANDIT,  // UCB1 over scalings of the configured thresholds
+  DRAM_TUNER_HILL     // coordinate hill climbing, one threshold per epoch
+};
+
+// -dram_sched_tuner <none|bandit|hill>[:<epoch>]
+struct dram_sched_tuner_config {
+  dram_sched_tuner_config() {
+    policy = DRAM_TUNER_NONE;
+    epoch = 0;
+    log_file = NULL;
+  }
+  void init(const char *opt, const char *log);
+
+  enum dram_sched_tuner_policy policy;
+  unsigned epoch;  // DRAM cycles between decisions
+  const char *log_file;
+};
+
+// Online controller of one channel's dram_sched_thresholds.
+//
+// Every epoch it scores the thresholds in use by the stall cycles the
+// channel accumulated per serviced access: MEM requests waiting in PIM mode
+// (non_pim_queueing_delay), PIM requests waiting in MEM mode
+// (pim_queueing_delay), banks draining for a MEM->PIM switch
+// (nonpim2pimswitchlatency) and row hits lost to switches
+// (nonpim2pimswitchconflicts).  The bandit policy picks one of a few
+// scalings of the configured thresholds with UCB1; the hill policy nudges
+// one threshold at a time and undoes moves that raised the cost.  Every
+// decision is appended to the -dram_sched_tuner_log file.
+class dram_sched_tuner {
+ public:
+  dram_sched_tuner(const dram_sched_tuner_config *config, const dram_t *dram,
+                   dram_sched_thresholds *thresholds);
+
+  // called every DRAM cycle before the scheduler's update_mode()
+  void cycle();
+  void print(FILE *fp) const;
+
+ private:
+  bool epoch_cost(double &cost);
+  void bandit_step(double cost);
+  void hill_step(double cost);
+  void set_scale(unsigned knob, double scale);
+  void log_decision(const char *what, double cost) const;
+
+  const dram_sched_tuner_config *m_config;
+  const dram_t *m_dram;
+  dram_sched_thresholds *m_thr;
+  dram_sched_thresholds m_base;
+  unsigned m_epoch_cycle;
+  dram_sample_counters m_last;
+
+  // bandit: one arm per threshold scaling
+  unsigned m_arm;
+  std::vector<unsigned> m_arm_pulls;
+  std::vector<double> m_arm_reward;
+
+  // hill: per knob scaling of the configured value and direction
+  std::vector<double> m_scale;
+  std::vector<int> m_dir;
+  unsigned m_knob;
+  double m_last_cost;
+  bool m_moved;
+
+  unsigned long long n_epochs;
+  unsigned long long n_changes;
+};
+
+#endif
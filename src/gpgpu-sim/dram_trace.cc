@@ -0,0 +1,123 @@
+#include "dram_trace.h"
+
+#include <stdlib.h>
+#include "gpu-sim.h"
+#include "mem_fetch.h"
+#include "shader.h"
+
+dram_trace_recorder::dram_trace_recorder(const char *filename) {
+  m_fp = fopen(filename, "w");
+  if (m_fp == NULL) {
+    printf("GPGPU-Sim uArch: cannot open DRAM trace file %s\n", filename);
+    abort();
+  }
+  fprintf(m_fp,
+          "# cycle sub_partition R|W M|P access_type addr data_size "
+          "ctrl_size sid tpc wid\n");
+}
+
+dram_trace_recorder::~dram_trace_recorder() { fclose(m_fp); }
+
+void dram_trace_recorder::record(mem_fetch *mf, unsigned long long cycle) {
+  fprintf(m_fp, "%llu %u %c %c %u 0x%llx %u %u %d %d %d\n", cycle,
+          mf->get_sub_partition_id(), mf->get_is_write() ? 'W' : 'R',
+          mf->is_pim() ? 'P' : 'M', (unsigned)mf->get_access_type(),
+          (unsigned long long)mf->get_addr(), mf->get_data_size(),
+          mf->get_ctrl_size(), (int)mf->get_sid(), (int)mf->get_tpc(),
+          (int)mf->get_wid());
+}
+
+void dram_trace_recorder::record_pim_region(new_addr_type start,
+                                            new_addr_type size) {
+  fprintf(m_fp, "@pim_region 0x%llx %llu\n", (unsigned long long)start,
+          (unsigned long long)size);
+}
+
+dram_trace_reader::dram_trace_reader(const char *filename,
+                                     const memory_config *mem_config) {
+  m_fp = fopen(filename, "r");
+  if (m_fp == NULL) {
+    printf("GPGPU-Sim uArch: cannot open DRAM trace file %s\n", filename);
+    abort();
+  }
+  m_filename = filename;
+  m_mem_config = mem_config;
+  m_line = 0;
+  m_n_records = 0;
+  read_next();
+}
+
+dram_trace_reader::~dram_trace_reader() { fclose(m_fp); }
+
+void dram_trace_reader::read_next() {
+  char buf[256];
+  m_valid = false;
+  while (fgets(buf, sizeof(buf), m_fp)) {
+    m_line++;
+    if (buf[0] == '#' || buf[0] == '\n') continue;
+    if (buf[0] == '@') {
+      unsigned long long start, size;
+      if (sscanf(buf, "@pim_region %llx %llu", &start, &size) != 2) {
+        printf("GPGPU-Sim uArch: %s:%u: malformed DRAM trace directive\n",
+               m_filename, m_line);
+        abort();
+      }
+      m_mem_config->m_address_mapping.add_pim_region(start, size);
+      continue;
+    }
+    char rw, pim;
+    unsigned type;
+    unsigned long long addr;
+    int sid, tpc, wid;
+    int n = sscanf(buf, "%llu %u %c %c %u %llx %u %u %d %d %d",
+                   &m_next.cycle, &m_next.sub_partition, &rw, &pim, &type,
+                   &addr, &m_next.data_size, &m_next.ctrl_size, &sid, &tpc,
+                   &wid);
+    if (n != 11 || (rw != 'R' && rw != 'W') || (pim != 'M' && pim != 'P') ||
+        type >= NUM_MEM_ACCESS_TYPE) {
+      printf("GPGPU-Sim uArch: %s:%u: malformed DRAM trace record\n",
+             m_filename, m_line);
+      abort();
+    }
+    m_next.is_write = (rw == 'W');
+    m_next.is_pim = (pim == 'P');
+    m_next.type = (enum mem_access_type)type;
+    m_next.addr = addr;
+    m_next.sid = sid;
+    m_next.tpc = tpc;
+    m_next.wid = wid;
+    m_valid = true;
+    m_n_records++;
+    return;
+  }
+}
+
+mem_fetch *dram_trace_reader::create_mem_fetch(
+    const dram_trace_record &r, const memory_config *mem_config,
+    const shader_core_config *shader_config, unsigned long long cycle) const {
+  mem_access_t access(r.type, r.addr, r.data_size, r.is_write,
+                      mem_config->gpgpu_ctx);
+  mem_fetch *mf;
+  if (r.is_pim) {
+    // PIM requests are told apart by the cache operator of their instruction
+    warp_inst_t inst(shader_config);
+    inst.cache_op = CACHE_STREAMING;
+    inst.data_size = r.data_size / 8;
+    active_mask_t mask;
+    mask.set(0);
+    inst.issue(mask, r.wid, cycle, r.wid, 0);
+    mf = new mem_fetch(access, &inst, r.ctrl_size, r.wid, r.sid, r.tpc,
+                       mem_config, cycle);
+  } else {
+    mf = new mem_fetch(access, NULL, r.ctrl_size, r.wid, r.sid, r.tpc,
+                       mem_config, cycle);
+  }
+  if (mf->get_sub_partition_id() != r.sub_partition) {
+    printf("GPGPU-Sim uArch: %s: address 0x%llx maps to sub partition %u, "
+           "recorded as %u; replay with the recording's address mapping\n",
+           m_filename, (unsigned long long)r.addr, mf->get_sub_partition_id(),
+           r.sub_partition);
+    abort();
+  }
+  return mf;
+}
@@ -0,0 +1,79 @@
+#ifndef __DRAM_TRACE_H__
+#define __DRAM_TRACE_H__
+
+#include <stdio.h>
+#include "../abstract_hardware_model.h"
+
+class mem_fetch;
+class memory_config;
+class shader_core_config;
+
+// One request entering a memory_sub_partition's L2->DRAM queue.
+//
+// Trace files hold one record per line, in core cycle order:
+//   <cycle> <sub partition> <R|W> <M|P> <access type> <addr> <data size>
+//   <ctrl size> <sid> <tpc> <wid>
+// where M/P tells non-PIM from PIM requests.  Lines starting with '#' are
+// comments.  Regions allocated with cudaMallocPIM are announced by
+//   @pim_region <start> <size>
+// lines ahead of the records that access them.
+struct dram_trace_record {
+  unsigned long long cycle;
+  unsigned sub_partition;
+  bool is_write;
+  bool is_pim;
+  enum mem_access_type type;
+  new_addr_type addr;
+  unsigned data_size;
+  unsigned ctrl_size;
+  unsigned sid;
+  unsigned tpc;
+  unsigned wid;
+};
+
+// Opt-in recorder of the L2->DRAM request stream (-gpgpu_dram_trace_file),
+// replayed by the standalone dram_replay simulator.
+class dram_trace_recorder {
+ public:
+  dram_trace_recorder(const char *filename);
+  ~dram_trace_recorder();
+
+  void record(mem_fetch *mf, unsigned long long cycle);
+  void record_pim_region(new_addr_type start, new_addr_type size);
+  void flush() { fflush(m_fp); }
+
+ private:
+  FILE *m_fp;
+};
+
+class dram_trace_reader {
+ public:
+  // PIM regions of the trace are added to mem_config's address mapping
+  dram_trace_reader(const char *filename, const memory_config *mem_config);
+  ~dram_trace_reader();
+
+  // next record, NULL at the end of the trace
+  const dram_trace_record *top() const { return m_valid ? &m_next : NULL; }
+  void pop() { read_next(); }
+
+  // builds the mem_fetch the recorded request stands for
+  mem_fetch *create_mem_fetch(const dram_trace_record &r,
+                              const memory_config *mem_config,
+                              const shader_core_config *shader_config,
+                              unsigned long long cycle) const;
+
+  unsigned long long n_records() const { return m_n_records; }
+
+ private:
+  void read_next();
+
+  FILE *m_fp;
+  const char *m_filename;
+  const memory_config *m_mem_config;
+  unsigned m_line;
+  bool m_valid;
+  dram_trace_record m_next;
+  unsigned long long m_n_records;
+};
+
+#endif
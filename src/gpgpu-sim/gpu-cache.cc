@@ -168,6 +168,7 @@ tag_array::~tag_array() {
   unsigned cache_lines_num = m_config.get_max_num_lines();
   for (unsigned i = 0; i < cache_lines_num; ++i) delete m_lines[i];
   delete[] m_lines;
+  delete m_policy;
 }
 
 tag_array::tag_array(cache_config &config, int core_id, int type_id,
@@ -178,6 +179,8 @@ tag_array::tag_array(cache_config &config, int core_id, int type_id,
 
 void tag_array::update_cache_parameters(cache_config &config) {
   m_config = config;
+  delete m_policy;
+  m_policy = replacement_policy::create(m_config);
 }
 
 tag_array::tag_array(cache_config &config, int core_id, int type_id)
@@ -210,6 +213,15 @@ void tag_array::init(int core_id, int type_id) {
   m_core_id = core_id;
   m_type_id = type_id;
   is_used = false;
+  m_prefetcher = NULL;
+  m_policy = replacement_policy::create(m_config);
+}
+
+// streaming (.cs) and last-use (.lu) accesses are not expected to be reused
+static bool is_streaming_access(mem_fetch *mf) {
+  if (mf == NULL) return false;
+  enum cache_operator_type op = mf->get_inst().cache_op;
+  return op == CACHE_STREAMING || op == CACHE_LAST_USE;
 }
 
 void tag_array::add_pending_line(mem_fetch *mf) {
@@ -246,9 +258,6 @@ enum cache_request_status tag_array::probe(new_addr_type addr, unsigned &idx,
   new_addr_type tag = m_config.tag(addr);
 
   unsigned invalid_line = (unsigned)-1;
-  unsigned valid_line = (unsigned)-1;
-  unsigned long long valid_timestamp = (unsigned)-1;
-
   bool all_reserved = true;
 
   // check for hit or pending hit
@@ -280,22 +289,7 @@ enum cache_request_status tag_array::probe(new_addr_type addr, unsigned &idx,
     }
     if (!line->is_reserved_line()) {
       all_reserved = false;
-      if (line->is_invalid_line()) {
-        invalid_line = index;
-      } else {
-        // valid line : keep track of most appropriate replacement candidate
-        if (m_config.m_replacement_policy == LRU) {
-          if (line->get_last_access_time() < valid_timestamp) {
-            valid_timestamp = line->get_last_access_time();
-            valid_line = index;
-          }
-        } else if (m_config.m_replacement_policy == FIFO) {
-          if (line->get_alloc_time() < valid_timestamp) {
-            valid_timestamp = line->get_alloc_time();
-            valid_line = index;
-          }
-        }
-      }
+      if (line->is_invalid_line()) invalid_line = index;
     }
   }
   if (all_reserved) {
@@ -306,11 +300,10 @@ enum cache_request_status tag_array::probe(new_addr_type addr, unsigned &idx,
 
   if (invalid_line != (unsigned)-1) {
     idx = invalid_line;
-  } else if (valid_line != (unsigned)-1) {
-    idx = valid_line;
-  } else
-    abort();  // if an unreserved block exists, it is either invalid or
-              // replaceable
+  } else {
+    // an unreserved block exists and is valid: let the policy pick
+    idx = m_policy->victim(set_index, m_lines);
+  }
 
   if (probe_mode && m_config.is_streaming()) {
     line_table::const_iterator i =
@@ -346,16 +339,22 @@ enum cache_request_status tag_array::access(new_addr_type addr, unsigned time,
       m_pending_hit++;
     case HIT:
       m_lines[idx]->set_last_access_time(time, mf->get_access_sector_mask());
+      m_policy->touch(idx, is_streaming_access(mf));
       break;
     case MISS:
       m_miss++;
       shader_cache_access_log(m_core_id, m_type_id, 1);  // log cache misses
       if (m_config.m_alloc_policy == ON_MISS) {
+        if (m_prefetcher && !m_lines[idx]->is_invalid_line())
+          m_prefetcher->evicted(m_lines[idx]->m_block_addr,
+                                m_prefetcher->is_prefetch(mf));
         if (m_lines[idx]->is_modified_line()) {
           wb = true;
           evicted.set_info(m_lines[idx]->m_block_addr,
                            m_lines[idx]->get_modified_size());
         }
+        m_policy->insert(idx, !m_lines[idx]->is_invalid_line(),
+                         is_streaming_access(mf));
         m_lines[idx]->allocate(m_config.tag(addr), m_config.block_addr(addr),
                                time, mf->get_access_sector_mask());
       }
@@ -367,6 +366,7 @@ enum cache_request_status tag_array::access(new_addr_type addr, unsigned time,
       if (m_config.m_alloc_policy == ON_MISS) {
         ((sector_cache_block *)m_lines[idx])
             ->allocate_sector(time, mf->get_access_sector_mask());
+        m_policy->touch(idx, is_streaming_access(mf));
       }
       break;
     case RESERVATION_FAIL:
@@ -384,22 +384,29 @@ enum cache_request_status tag_array::access(new_addr_type addr, unsigned time,
 }
 
 void tag_array::fill(new_addr_type addr, unsigned time, mem_fetch *mf) {
-  fill(addr, time, mf->get_access_sector_mask());
+  fill(addr, time, mf->get_access_sector_mask(), mf);
 }
 
 void tag_array::fill(new_addr_type addr, unsigned time,
-                     mem_access_sector_mask_t mask) {
+                     mem_access_sector_mask_t mask, mem_fetch *mf) {
   // assert( m_config.m_alloc_policy == ON_FILL );
   unsigned idx;
   enum cache_request_status status = probe(addr, idx, mask);
   // assert(status==MISS||status==SECTOR_MISS); // MSHR should have prevented
   // redundant memory request
-  if (status == MISS)
+  if (status == MISS && m_prefetcher && mf &&
+      !m_lines[idx]->is_invalid_line())
+    m_prefetcher->evicted(m_lines[idx]->m_block_addr,
+                          m_prefetcher->is_prefetch(mf));
+  if (status == MISS) {
+    m_policy->insert(idx, !m_lines[idx]->is_invalid_line(),
+                     is_streaming_access(mf));
     m_lines[idx]->allocate(m_config.tag(addr), m_config.block_addr(addr), time,
                            mask);
-  else if (status == SECTOR_MISS) {
+  } else if (status == SECTOR_MISS) {
     assert(m_config.m_cache_type == SECTOR);
     ((sector_cache_block *)m_lines[idx])->allocate_sector(time, mask);
+    m_policy->touch(idx, is_streaming_access(mf));
   }
 
   m_lines[idx]->fill(time, mask);
@@ -575,6 +582,21 @@ mem_fetch *mshr_table::next_access() {
   return result;
 }
 
+/// Drop a filled prefetch from the head of its ready entry
+unsigned mshr_table::remove_prefetch(new_addr_type block_addr, mem_fetch *mf) {
+  assert(access_ready() && m_current_response.back() == block_addr);
+  table::iterator a = m_data.find(block_addr);
+  assert(a != m_data.end() && a->second.m_list.front() == mf);
+  a->second.m_list.pop_front();
+  unsigned merged = a->second.m_list.size();
+  if (merged == 0) {
+    // release entry
+    m_data.erase(a);
+    m_current_response.pop_back();
+  }
+  return merged;
+}
+
 void mshr_table::display(FILE *fp) const {
   fprintf(fp, "MSHR contents\n");
   for (table::const_iterator e = m_data.begin(); e != m_data.end(); ++e) {
@@ -1022,6 +1044,7 @@ void baseline_cache::cycle() {
       m_memport->push(mf);
     }
   }
+  if (m_prefetcher) issue_prefetch();
   bool data_port_busy = !m_bandwidth_management.data_port_free();
   bool fill_port_busy = !m_bandwidth_management.fill_port_free();
   m_stats.sample_cache_port_utility(data_port_busy, fill_port_busy);
@@ -1070,8 +1093,15 @@ void baseline_cache::fill(mem_fetch *mf, unsigned time) {
                       mf->get_access_sector_mask());  // mark line as dirty for
                                                       // atomic operation
   }
+  new_addr_type block_addr = e->second.m_block_addr;
   m_extra_mf_fields.erase(mf);
   m_bandwidth_management.use_fill_port(mf);
+  if (m_prefetcher && m_prefetcher->is_prefetch(mf)) {
+    // nobody waits for a prefetch; hand the entry to the demands merged
+    // into it, if any
+    m_prefetcher->filled(block_addr, m_mshrs.remove_prefetch(block_addr, mf));
+    delete mf;
+  }
 }
 
 /// Checks if mf is waiting to be filled by lower memory level
@@ -1084,6 +1114,7 @@ void baseline_cache::print(FILE *fp, unsigned &accesses,
                            unsigned &misses) const {
   fprintf(fp, "Cache %s:\t", m_name.c_str());
   m_tag_array->print(fp, accesses, misses);
+  if (m_prefetcher) m_prefetcher->print(fp);
 }
 
 void baseline_cache::display_state(FILE *fp) const {
@@ -1666,9 +1697,108 @@ enum cache_request_status data_cache::access(new_addr_type addr, mem_fetch *mf,
                     m_stats.select_stats_status(probe_status, access_status));
   m_stats.inc_stats_pw(mf->get_access_type(), m_stats.select_stats_status(
                                                   probe_status, access_status));
+  if (m_prefetcher && !wr && access_status != RESERVATION_FAIL)
+    train_prefetcher(addr, mf, probe_status);
   return access_status;
 }
 
+void data_cache::init_prefetcher(mem_access_type pref_type) {
+  m_pref_type = pref_type;
+  m_pref_wid = 0;
+  m_pref_sid = 0;
+  m_pref_tpc = 0;
+  m_pref_ctrl_size = 0;
+  m_pref_mem_config = NULL;
+  if (!m_config.m_prefetch.enabled()) return;
+
+  if (m_config.m_mshr_type == SECTOR_ASSOC) {
+    printf("GPGPU-Sim uArch: %s: prefetching is not supported with sector "
+           "MSHRs (S)\n",
+           m_name.c_str());
+    abort();
+  }
+  m_prefetcher =
+      new prefetch_engine(m_config.m_prefetch, m_config.get_atom_sz(),
+                          m_config.get_line_sz(), pref_type);
+  m_tag_array->set_prefetcher(m_prefetcher);
+}
+
+void data_cache::train_prefetcher(new_addr_type addr, mem_fetch *mf,
+                                  enum cache_request_status probe_status) {
+  if (mf->is_pim()) return;
+  m_pref_wid = mf->get_wid();
+  m_pref_sid = mf->get_sid();
+  m_pref_tpc = mf->get_tpc();
+  m_pref_ctrl_size = mf->get_ctrl_size();
+  m_pref_mem_config = mf->get_mem_config();
+
+  // an L2 bank only prefetches the blocks it owns
+  unsigned home =
+      (m_pref_type == L2_PREF_R) ? mf->get_sub_partition_id() : (unsigned)-1;
+  m_prefetcher->demand(mf->get_pc(), addr, m_config.mshr_addr(addr),
+                       probe_status == HIT,
+                       probe_status == MISS || probe_status == SECTOR_MISS,
+                       home);
+}
+
+/// Sends the oldest prefetch candidate to the lower level if the data port,
+/// the miss queue and the MSHRs have room for it
+void data_cache::issue_prefetch() {
+  if (m_prefetcher->empty() || !m_bandwidth_management.data_port_free() ||
+      miss_queue_full(1) || !m_prefetcher->may_issue(m_config.m_mshr_entries))
+    return;
+  const prefetch_engine::candidate_t c = m_prefetcher->front();
+  m_prefetcher->pop_front();
+
+  if (c.home != (unsigned)-1) {
+    addrdec_t tlx;
+    m_pref_mem_config->m_address_mapping.addrdec_tlx(c.block, &tlx);
+    if (tlx.sub_partition != c.home) return;
+  }
+
+  mem_access_sector_mask_t sector_mask;
+  const unsigned first = (c.block & (m_config.get_line_sz() - 1)) / SECTOR_SIZE;
+  for (unsigned i = 0; i < m_config.get_atom_sz() / SECTOR_SIZE; i++)
+    sector_mask.set(first + i);
+
+  new_addr_type block_addr = m_config.block_addr(c.block);
+  unsigned cache_index = (unsigned)-1;
+  enum cache_request_status probe_status =
+      m_tag_array->probe(block_addr, cache_index, sector_mask, true);
+  if (probe_status == HIT || probe_status == HIT_RESERVED ||
+      m_mshrs.probe(c.block)) {
+    m_prefetcher->redundant();
+    return;
+  }
+  if (probe_status == RESERVATION_FAIL || m_mshrs.full(c.block)) return;
+
+  unsigned long long time = m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle;
+  mem_access_t access(m_pref_type, c.block, m_config.get_atom_sz(), false,
+                      active_mask_t(), mem_access_byte_mask_t(), sector_mask,
+                      m_gpu->gpgpu_ctx);
+  mem_fetch *mf =
+      new mem_fetch(access, NULL, m_pref_ctrl_size, m_pref_wid, m_pref_sid,
+                    m_pref_tpc, m_pref_mem_config, time);
+
+  std::list<cache_event> events;
+  bool do_miss = false;
+  bool wb = false;
+  evicted_block_info evicted;
+  send_read_request(c.block, block_addr, cache_index, mf, time, do_miss, wb,
+                    evicted, events, false, true);
+  assert(do_miss);
+  if (wb && (m_config.m_write_policy != WRITE_THROUGH)) {
+    mem_fetch *wb = m_memfetch_creator->alloc(
+        evicted.m_block_addr, m_wrbk_type, evicted.m_modified_size, true, time);
+    wb->set_chip(mf->get_tlx_addr().chip);
+    wb->set_parition(mf->get_tlx_addr().sub_partition);
+    send_write_request(wb, cache_event(WRITE_BACK_REQUEST_SENT, evicted), time,
+                       events);
+  }
+  m_prefetcher->issued();
+  m_stats.inc_stats(m_pref_type, MISS);
+}
+
 /// This is meant to model the first level data cache in Fermi.
 /// It is write-evict (global) or write-back (local) at the
 /// granularity of individual blocks (Set by GPGPU-Sim configuration file)
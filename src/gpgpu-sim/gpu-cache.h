@@ -35,6 +35,8 @@
 #include "../tr1_hash_map.h"
 #include "gpu-misc.h"
 #include "mem_fetch.h"
+#include "prefetcher.h"
+#include "replacement_policy.h"
 
 #include <iostream>
 #include "addrdec.h"
@@ -410,7 +412,15 @@ struct sector_cache_block : public cache_block_t {
   }
 };
 
-enum replacement_policy_t { LRU, FIFO };
+enum replacement_policy_t {
+  LRU,
+  FIFO,
+  PLRU,
+  SRRIP,
+  BRRIP,
+  DRRIP,
+  STREAM_BYPASS
+};
 
 enum write_policy_t {
   READ_ONLY,
@@ -460,6 +470,7 @@ class cache_config {
     m_config_string = NULL;  // set by option parser
     m_config_stringPrefL1 = NULL;
     m_config_stringPrefShared = NULL;
+    m_prefetch_string = NULL;
     m_data_port_width = 0;
     m_set_index_function = LINEAR_SET_FUNCTION;
     m_is_streaming = false;
@@ -500,15 +511,20 @@ class cache_config {
       case 'F':
         m_replacement_policy = FIFO;
         break;
-      default:
-        exit_parse_error();
-    }
-    switch (rp) {
-      case 'L':
-        m_replacement_policy = LRU;
+      case 'P':
+        m_replacement_policy = PLRU;
         break;
-      case 'F':
-        m_replacement_policy = FIFO;
+      case 'S':
+        m_replacement_policy = SRRIP;
+        break;
+      case 'B':
+        m_replacement_policy = BRRIP;
+        break;
+      case 'D':
+        m_replacement_policy = DRRIP;
+        break;
+      case 'Y':
+        m_replacement_policy = STREAM_BYPASS;
         break;
       default:
         exit_parse_error();
@@ -587,6 +603,7 @@ class cache_config {
     m_atom_sz = (m_cache_type == SECTOR) ? SECTOR_SIZE : m_line_sz;
     m_sector_sz_log2 = LOGB2(SECTOR_SIZE);
     original_m_assoc = m_assoc;
+    m_prefetch.init(m_prefetch_string);
 
     // For more details about difference between FETCH_ON_WRITE and WRITE
     // VALIDAE policies Read: Jouppi, Norman P. "Cache write policies and
@@ -681,6 +698,13 @@ class cache_config {
     assert(m_valid);
     return MAX_DEFAULT_CACHE_SIZE_MULTIBLIER * original_m_assoc;
   }
+  unsigned get_assoc() const {
+    assert(m_valid);
+    return m_assoc;
+  }
+  enum replacement_policy_t get_replacement_policy() const {
+    return m_replacement_policy;
+  }
   void print(FILE *fp) const {
     fprintf(fp, "Size = %d B (%d Set x %d-way x %d byte line)\n",
             m_line_sz * m_nset * m_assoc, m_nset, m_assoc, m_line_sz);
@@ -725,6 +749,7 @@ class cache_config {
   char *m_config_string;
   char *m_config_stringPrefL1;
   char *m_config_stringPrefShared;
+  char *m_prefetch_string;
   FuncCache cache_status;
 
  protected:
@@ -746,7 +771,10 @@ class cache_config {
   unsigned original_m_assoc;
   bool m_is_streaming;
 
-  enum replacement_policy_t m_replacement_policy;  // 'L' = LRU, 'F' = FIFO
+  enum replacement_policy_t
+      m_replacement_policy;  // 'L' = LRU, 'F' = FIFO, 'P' = tree PLRU,
+                             // 'S' = SRRIP, 'B' = BRRIP, 'D' = DRRIP,
+                             // 'Y' = SRRIP with streaming bypass
   enum write_policy_t
       m_write_policy;  // 'T' = write through, 'B' = write back, 'R' = read only
   enum allocation_policy_t
@@ -773,6 +801,7 @@ class cache_config {
   unsigned m_data_port_width;  //< number of byte the cache can access per cycle
   enum set_index_function
       m_set_index_function;  // Hash, linear, or custom set index function
+  prefetch_config m_prefetch;
 
   friend class tag_array;
   friend class baseline_cache;
@@ -831,7 +860,8 @@ class tag_array {
 
   void fill(new_addr_type addr, unsigned time, mem_fetch *mf);
   void fill(unsigned idx, unsigned time, mem_fetch *mf);
-  void fill(new_addr_type addr, unsigned time, mem_access_sector_mask_t mask);
+  void fill(new_addr_type addr, unsigned time, mem_access_sector_mask_t mask,
+            mem_fetch *mf = NULL);
 
   unsigned size() const { return m_config.get_num_lines(); }
   cache_block_t *get_block(unsigned idx) { return m_lines[idx]; }
@@ -849,6 +879,10 @@ class tag_array {
   void update_cache_parameters(cache_config &config);
   void add_pending_line(mem_fetch *mf);
   void remove_pending_line(mem_fetch *mf);
+  // told about every line the tag array replaces
+  void set_prefetcher(prefetch_engine *prefetcher) {
+    m_prefetcher = prefetcher;
+  }
 
  protected:
   // This constructor is intended for use only from derived classes that wish to
@@ -883,6 +917,9 @@ class tag_array {
 
   typedef tr1_hash_map<new_addr_type, unsigned> line_table;
   line_table pending_lines;
+
+  prefetch_engine *m_prefetcher;
+  replacement_policy *m_policy;
 };
 
 class mshr_table {
@@ -911,6 +948,9 @@ class mshr_table {
   bool access_ready() const { return !m_current_response.empty(); }
   /// Returns next ready access
   mem_fetch *next_access();
+  /// Drop a filled prefetch from the head of its ready entry, returns the
+  /// number of accesses still merged into the entry
+  unsigned remove_prefetch(new_addr_type block_addr, mem_fetch *mf);
   void display(FILE *fp) const;
   // Returns true if there is a pending read after write
   bool is_read_after_write_pending(new_addr_type block_addr);
@@ -1149,9 +1189,13 @@ class baseline_cache : public cache_t {
     assert(config.m_mshr_type == ASSOC || config.m_mshr_type == SECTOR_ASSOC);
     m_memport = memport;
     m_miss_queue_status = status;
+    m_prefetcher = NULL;
   }
 
-  virtual ~baseline_cache() { delete m_tag_array; }
+  virtual ~baseline_cache() {
+    delete m_tag_array;
+    delete m_prefetcher;
+  }
 
   void update_cache_parameters(cache_config &config) {
     m_config = config;
@@ -1237,6 +1281,10 @@ class baseline_cache : public cache_t {
   std::list<mem_fetch *> m_miss_queue;
   enum mem_fetch_status m_miss_queue_status;
   mem_fetch_interface *m_memport;
+  prefetch_engine *m_prefetcher;  // NULL unless the cache prefetches
+
+  /// Sends at most one prefetch to the lower level, called every cycle
+  virtual void issue_prefetch() {}
 
   struct extra_mf_fields {
     extra_mf_fields() { m_valid = false; }
@@ -1348,12 +1396,14 @@ class data_cache : public baseline_cache {
   data_cache(const char *name, cache_config &config, int core_id, int type_id,
              mem_fetch_interface *memport, mem_fetch_allocator *mfcreator,
              enum mem_fetch_status status, mem_access_type wr_alloc_type,
-             mem_access_type wrbk_type, class gpgpu_sim *gpu)
+             mem_access_type wrbk_type, mem_access_type pref_type,
+             class gpgpu_sim *gpu)
       : baseline_cache(name, config, core_id, type_id, memport, status) {
     init(mfcreator);
     m_wr_alloc_type = wr_alloc_type;
     m_wrbk_type = wrbk_type;
     m_gpu = gpu;
+    init_prefetcher(pref_type);
   }
 
   virtual ~data_cache() {}
@@ -1419,21 +1469,38 @@ class data_cache : public baseline_cache {
              mem_fetch_interface *memport, mem_fetch_allocator *mfcreator,
              enum mem_fetch_status status, tag_array *new_tag_array,
              mem_access_type wr_alloc_type, mem_access_type wrbk_type,
-             class gpgpu_sim *gpu)
+             mem_access_type pref_type, class gpgpu_sim *gpu)
       : baseline_cache(name, config, core_id, type_id, memport, status,
                        new_tag_array) {
     init(mfcreator);
     m_wr_alloc_type = wr_alloc_type;
     m_wrbk_type = wrbk_type;
     m_gpu = gpu;
+    init_prefetcher(pref_type);
   }
 
   mem_access_type m_wr_alloc_type;  // Specifies type of write allocate request
                                     // (e.g., L1 or L2)
   mem_access_type
       m_wrbk_type;  // Specifies type of writeback request (e.g., L1 or L2)
+  mem_access_type m_pref_type;  // Specifies type of prefetch request
   class gpgpu_sim *m_gpu;
 
+  /// Creates the prefetch engine when the config asks for one
+  void init_prefetcher(mem_access_type pref_type);
+  /// Trains the prefetch engine on an accepted demand read
+  void train_prefetcher(new_addr_type addr, mem_fetch *mf,
+                        enum cache_request_status probe_status);
+  virtual void issue_prefetch();
+
+  // the last demand that trained the prefetch engine; prefetches are sent
+  // on its behalf
+  unsigned m_pref_wid;
+  unsigned m_pref_sid;
+  unsigned m_pref_tpc;
+  unsigned m_pref_ctrl_size;
+  const memory_config *m_pref_mem_config;
+
   //! A general function that takes the result of a tag_array probe
   //  and performs the correspding functions based on the cache configuration
   //  The access fucntion calls this function
@@ -1540,7 +1607,7 @@ class l1_cache : public data_cache {
            mem_fetch_interface *memport, mem_fetch_allocator *mfcreator,
            enum mem_fetch_status status, class gpgpu_sim *gpu)
       : data_cache(name, config, core_id, type_id, memport, mfcreator, status,
-                   L1_WR_ALLOC_R, L1_WRBK_ACC, gpu) {}
+                   L1_WR_ALLOC_R, L1_WRBK_ACC, L1_PREF_R, gpu) {}
 
   virtual ~l1_cache() {}
 
@@ -1554,7 +1621,8 @@ class l1_cache : public data_cache {
            enum mem_fetch_status status, tag_array *new_tag_array,
            class gpgpu_sim *gpu)
       : data_cache(name, config, core_id, type_id, memport, mfcreator, status,
-                   new_tag_array, L1_WR_ALLOC_R, L1_WRBK_ACC, gpu) {}
+                   new_tag_array, L1_WR_ALLOC_R, L1_WRBK_ACC, L1_PREF_R,
+                   gpu) {}
 };
 
 /// Models second level shared cache with global write-back
@@ -1565,7 +1633,7 @@ class l2_cache : public data_cache {
            mem_fetch_interface *memport, mem_fetch_allocator *mfcreator,
            enum mem_fetch_status status, class gpgpu_sim *gpu)
       : data_cache(name, config, core_id, type_id, memport, mfcreator, status,
-                   L2_WR_ALLOC_R, L2_WRBK_ACC, gpu) {}
+                   L2_WR_ALLOC_R, L2_WRBK_ACC, L2_PREF_R, gpu) {}
 
   virtual ~l2_cache() {}
 
@@ -42,6 +42,8 @@
 
 #include <time.h>
 #include "addrdec.h"
+#include "chrome_trace.h"
+#include "dram_trace.h"
 #include "delayqueue.h"
 #include "dram.h"
 #include "gpu-cache.h"
@@ -62,9 +64,14 @@
 #include "../statwrapper.h"
 #include "../trace.h"
 #include "mem_latency_stat.h"
+#include "mem_timeseries.h"
+#include "pim_broadcast.h"
 #include "power_stat.h"
+#include "sim_prof.h"
+#include "stats_registry.h"
 #include "stats.h"
 #include "visualizer.h"
+#include "write_combining.h"
 
 #ifdef GPGPUSIM_POWER_MODEL
 #include "power_interface.h"
@@ -135,9 +142,12 @@ void memory_config::reg_options(class OptionParser *opp) {
   option_parser_register(opp, "-gpgpu_simple_dram_model", OPT_BOOL,
                          &simple_dram_model,
                          "simple_dram_model with fixed latency and BW", "0");
-  option_parser_register(opp, "-gpgpu_dram_scheduler", OPT_INT32,
-                         &scheduler_type, "0 = fifo, 1 = FR-FCFS (defaul)",
-                         "1");
+  option_parser_register(
+      opp, "-gpgpu_dram_scheduler", OPT_CSTR, &dram_scheduler_name,
+      "DRAM scheduler: fifo, frfcfs (default), pim_frfcfs, mem_first, "
+      "pim_first, gi, gi_mem, bliss, fr_rr_fcfs, rr_batch_cap, rr_req_cap, "
+      "rr_mem, paws, paws_new; the former numeric ids 0-13 are accepted too",
+      "frfcfs");
   option_parser_register(opp, "-gpgpu_dram_partition_queues", OPT_CSTR,
                          &gpgpu_L2_queue_config, "i2$:$2d:d2$:$2i", "8:8:8:8");
 
@@ -149,6 +159,11 @@ void memory_config::reg_options(class OptionParser *opp) {
                          " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_"
                          "alloc>,<mshr>:<N>:<merge>,<mq>}",
                          "64:128:8,L:B:m:N,A:16:4,4");
+  option_parser_register(
+      opp, "-gpgpu_l2_prefetcher", OPT_CSTR, &m_L2_config.m_prefetch_string,
+      "L2 data cache prefetcher {<policy S=stride, L=stream, B=both>:<table>:"
+      "<degree>:<distance>:<throttle interval> | none}",
+      "none");
   option_parser_register(opp, "-gpgpu_cache:dl2_texture_only", OPT_BOOL,
                          &m_L2_texure_only, "L2 cache used for texture only",
                          "1");
@@ -225,6 +240,50 @@ void memory_config::reg_options(class OptionParser *opp) {
       &min_pim_batches, "PIM_Batches", "1");
   option_parser_register(opp, "-dram_max_pim_slowdown", OPT_FLOAT,
       &max_pim_slowdown, "Max_PIM_Slowdown", "2");
+  option_parser_register(opp, "-dram_sched_tuner", OPT_CSTR,
+      &dram_sched_tuner_opt,
+      "online tuning of -frfcfs_cap, the -dram_pim_queue_size watermarks, "
+      "-dram_min_pim_batches and -dram_max_pim_slowdown per channel "
+      "<none|bandit|hill>[:<epoch in DRAM cycles>]", "none");
+  option_parser_register(opp, "-dram_sched_tuner_log", OPT_CSTR,
+      &dram_sched_tuner_log,
+      "file every -dram_sched_tuner decision is written to",
+      "dram_sched_tuner.log");
+  option_parser_register(opp, "-dram_pim_bankgrp_mode", OPT_BOOL,
+      &dram_pim_bankgrp_mode,
+      "PIM ops occupy only the bank group holding their operands instead of "
+      "all banks, MEM requests keep using the other groups", "0");
+  option_parser_register(opp, "-dram_pim_unit", OPT_CSTR, &dram_pim_unit_opt,
+      "in-DRAM PIM compute unit <N|B|G>:<regs>:<mac_lat>,<mac_ii>:"
+      "<add_lat>,<add_ii>:<reduce_lat>,<reduce_ii> (N = not modelled, "
+      "B = per bank, G = per bank group)", "N:0:0,1:0,1:0,1");
+  option_parser_register(opp, "-dram_pim_op_bit", OPT_UINT32,
+      &dram_pim_op_bit,
+      "lowest of the two address bits that select the op class of a PIM "
+      "write (MAC, add, reduce), 0 = every PIM write is a MAC", "0");
+  option_parser_register(opp, "-dram_pim_broadcast_bit", OPT_UINT32,
+      &dram_pim_broadcast_bit,
+      "address bit that marks a PIM write as a broadcast to all channels of "
+      "-dram_pim_broadcast_channels, 0 = disabled", "0");
+  option_parser_register(opp, "-dram_pim_broadcast_channels", OPT_CSTR,
+      &dram_pim_broadcast_channels,
+      "channels a broadcast PIM write is replicated to (all or a comma "
+      "separated list)", "all");
+  option_parser_register(opp, "-dram_pim_broadcast_latency", OPT_UINT32,
+      &dram_pim_broadcast_latency,
+      "cycles from the home channel to the replicas of a broadcast PIM write",
+      "0");
+  option_parser_register(opp, "-gpgpu_l2_wcb_entries", OPT_UINT32,
+      &l2_wcb_entries,
+      "open blocks in the write-combining buffer that merges PIM and "
+      "streaming writes in front of each L2->DRAM queue, 0 = disabled", "0");
+  option_parser_register(opp, "-gpgpu_l2_wcb_block_size", OPT_UINT32,
+      &l2_wcb_block_size,
+      "bytes of a write-combining block (power of two)", "128");
+  option_parser_register(opp, "-gpgpu_l2_wcb_timeout", OPT_UINT32,
+      &l2_wcb_timeout,
+      "L2 cycles a write-combining block stays open before it is flushed",
+      "32");
 
   option_parser_register(opp, "-bliss_clearing_interval", OPT_UINT32,
       &bliss_clearing_interval, "BLISS Clearing Interval", "10000");
@@ -269,6 +328,11 @@ void shader_core_config::reg_options(class OptionParser *opp) {
                          " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_"
                          "alloc>,<mshr>:<N>:<merge>,<mq> | none}",
                          "none");
+  option_parser_register(
+      opp, "-gpgpu_l1d_prefetcher", OPT_CSTR, &m_L1D_config.m_prefetch_string,
+      "per-shader L1 data cache prefetcher {<policy S=stride, L=stream, "
+      "B=both>:<table>:<degree>:<distance>:<throttle interval> | none}",
+      "none");
   option_parser_register(opp, "-gpgpu_l1_banks", OPT_UINT32,
                          &m_L1D_config.l1_banks, "The number of L1 cache banks",
                          "1");
@@ -358,6 +422,10 @@ void shader_core_config::reg_options(class OptionParser *opp) {
                          &gpgpu_shmem_sizePrefShared,
                          "Size of shared memory per shader core (default 16kB)",
                          "16384");
+  option_parser_register(
+      opp, "-gpgpu_local_mem_size_max", OPT_UINT32, &gpgpu_local_mem_size_max,
+      "Size of the generic local memory window of each thread (default 16kB)",
+      "16384");
   option_parser_register(
       opp, "-gpgpu_shmem_num_banks", OPT_UINT32, &num_shmem_bank,
       "Number of banks in the shared memory in each shader core (default 16)",
@@ -532,7 +600,9 @@ void shader_core_config::reg_options(class OptionParser *opp) {
       "1");
   option_parser_register(
       opp, "-gpgpu_scheduler", OPT_CSTR, &gpgpu_scheduler_string,
-      "Scheduler configuration: < lrr | gto | two_level_active > "
+      "Scheduler configuration: < lrr | gto | old | two_level_active | "
+      "warp_limiting | ccws | criticality | pim_balance > "
+      "ccws:<base_score>:<miss_score>, pim_balance:<pim_store_percent> "
       "If "
       "two_level_active:<num_active_warps>:<inner_prioritization>:<outer_"
       "prioritization>"
@@ -569,6 +639,16 @@ void shader_core_config::reg_options(class OptionParser *opp) {
 
   option_parser_register(opp, "-gpgpu_pim_fence", OPT_BOOL, &gpgpu_pim_fence,
       "Enable percolating fence for PIM", "0");
+  option_parser_register(opp, "-gpgpu_pim_throttle", OPT_FLOAT,
+      &gpgpu_pim_throttle,
+      "DRAM PIM queue occupancy (fraction of -dram_pim_queue_size) above "
+      "which warp schedulers deprioritize warps about to issue a PIM store, "
+      "0 = disabled", "0");
+  option_parser_register(opp, "-gpgpu_pim_throttle_schedulers", OPT_CSTR,
+      &gpgpu_pim_throttle_schedulers,
+      "warp scheduler policies that act on -gpgpu_pim_throttle (comma "
+      "separated list of -gpgpu_scheduler policy names)",
+      "lrr,gto,two_level_active");
 }
 
 void gpgpu_sim_config::reg_options(option_parser_t opp) {
@@ -640,6 +720,44 @@ void gpgpu_sim_config::reg_options(option_parser_t opp) {
       opp, "-visualizer_zlevel", OPT_INT32, &g_visualizer_zlevel,
       "Compression level of the visualizer output log (0=no comp, 9=highest)",
       "6");
+  option_parser_register(opp, "-gpgpu_stats_text", OPT_BOOL,
+                         &gpgpu_stats_text,
+                         "Print the text statistics dump at the end of each "
+                         "kernel (1=On, 0=Off)",
+                         "1");
+  option_parser_register(opp, "-gpgpu_stats_binary_file", OPT_CSTR,
+                         &gpgpu_stats_binary_file,
+                         "Write registered statistics as binary records to "
+                         "this file (convert with scripts/stats_bin_convert.py)",
+                         "");
+  option_parser_register(opp, "-gpgpu_stats_binary_sample", OPT_BOOL,
+                         &gpgpu_stats_binary_sample,
+                         "Also write a binary stats record every "
+                         "-gpgpu_runtime_stat sampling interval",
+                         "0");
+  option_parser_register(opp, "-gpgpu_mem_sample_interval", OPT_UINT32,
+                         &gpgpu_mem_sample_interval,
+                         "Sample per-channel DRAM/PIM metrics every this many "
+                         "core cycles (0 = off)",
+                         "0");
+  option_parser_register(opp, "-gpgpu_mem_sample_file", OPT_CSTR,
+                         &gpgpu_mem_sample_file,
+                         "Output file of the DRAM/PIM time series",
+                         "mem_timeseries.bin");
+  option_parser_register(opp, "-gpgpu_chrome_trace_file", OPT_CSTR,
+                         &gpgpu_chrome_trace_file,
+                         "Export sampled memory request lifecycles, kernels "
+                         "and DRAM mode phases as a Chrome trace (JSON) to "
+                         "this file",
+                         "");
+  option_parser_register(opp, "-gpgpu_chrome_trace_sample", OPT_UINT32,
+                         &gpgpu_chrome_trace_sample,
+                         "Trace one of every N memory requests", "100");
+  option_parser_register(opp, "-gpgpu_dram_trace_file", OPT_CSTR,
+                         &gpgpu_dram_trace_file,
+                         "Record the requests entering the L2->DRAM queues "
+                         "to this file, for replay with dram_replay",
+                         "");
   option_parser_register(opp, "-gpgpu_stack_size_limit", OPT_INT32,
                          &stack_size_limit, "GPU thread stack size", "1024");
   option_parser_register(opp, "-gpgpu_heap_size_limit", OPT_INT32,
@@ -724,6 +842,8 @@ void gpgpu_sim::launch(kernel_info_t *kinfo) {
     }
   }
   assert(n < m_running_kernels.size());
+  if (g_chrome_trace)
+    g_chrome_trace->kernel_launch(kinfo->get_uid(), kinfo->name());
 }
 
 bool gpgpu_sim::can_start_kernel() {
@@ -821,13 +941,14 @@ void gpgpu_sim::set_kernel_done(kernel_info_t *kernel) {
   for (k = m_running_kernels.begin(); k != m_running_kernels.end(); k++) {
     if (*k == kernel) {
       kernel->end_cycle = gpu_sim_cycle + gpu_tot_sim_cycle;
+      if (g_chrome_trace) g_chrome_trace->kernel_done(uid, kernel->name());
       *k = NULL;
       break;
     }
   }
 
   if (k != m_running_kernels.end()) {
-    gpu_print_stat(uid);
+    report_kernel_stats(uid);
   }
 }
 
@@ -880,6 +1001,8 @@ gpgpu_sim::gpgpu_sim(const gpgpu_sim_config &config, gpgpu_context *ctx)
   gpu_deadlock = false;
 
   gpu_stall_dramfull = 0;
+  gpu_pim_backpressure_cycles = 0;
+  m_pim_congested_channels = 0;
   gpu_stall_icnt2sh = 0;
   partiton_reqs_in_parallel = 0;
   partiton_reqs_in_parallel_total = 0;
@@ -890,6 +1013,11 @@ gpgpu_sim::gpgpu_sim(const gpgpu_sim_config &config, gpgpu_context *ctx)
   partiton_replys_in_parallel = 0;
   partiton_replys_in_parallel_total = 0;
 
+  m_wcb_drain_requested = false;
+  m_pim_broadcast_hub = NULL;
+  if (m_memory_config->dram_pim_broadcast_bit)
+    m_pim_broadcast_hub = new pim_broadcast_hub(m_memory_config);
+
   m_memory_partition_unit =
       new memory_partition_unit *[m_memory_config->m_n_mem];
   m_memory_sub_partition =
@@ -910,9 +1038,32 @@ gpgpu_sim::gpgpu_sim(const gpgpu_sim_config &config, gpgpu_context *ctx)
   icnt_create(m_shader_config->n_simt_clusters,
               m_memory_config->m_n_mem_sub_partition);
 
+  m_stats_registry = new stats_registry();
+  m_stats_registry->set_output(m_config.gpgpu_stats_binary_file);
+  register_stats();
+
+  m_mem_timeseries = NULL;
+  if (m_config.gpgpu_mem_sample_interval)
+    m_mem_timeseries = new mem_timeseries(m_config.gpgpu_mem_sample_file,
+                                          m_memory_config->m_n_mem);
+
+  if (m_config.gpgpu_chrome_trace_file &&
+      m_config.gpgpu_chrome_trace_file[0] != '\0')
+    g_chrome_trace = new chrome_trace(m_config.gpgpu_chrome_trace_file,
+                                      m_config.gpgpu_chrome_trace_sample,
+                                      m_memory_config->m_n_mem);
+
+  m_dram_trace_recorder = NULL;
+  if (m_config.gpgpu_dram_trace_file && m_config.gpgpu_dram_trace_file[0])
+    m_dram_trace_recorder =
+        new dram_trace_recorder(m_config.gpgpu_dram_trace_file);
+
   time_vector_create(NUM_MEM_REQ_STAT);
+  SimProf::init();
   fprintf(stdout,
           "GPGPU-Sim uArch: performance model initialization complete.\n");
+  // tools time the start-up by this line, even when stdout is a pipe
+  fflush(stdout);
 
   m_running_kernels.resize(config.max_concurrent_kernel, NULL);
   m_last_issued_kernel = 0;
@@ -928,6 +1079,7 @@ gpgpu_sim::gpgpu_sim(const gpgpu_sim_config &config, gpgpu_context *ctx)
   m_functional_sim_kernel = NULL;
 
   m_prev_icnt_L2_vc.resize(m_memory_config->m_n_mem_sub_partition, 0);
+  m_icnt_L2_vc_stall.resize(m_memory_config->m_n_mem_sub_partition * 2, 0);
 }
 
 int gpgpu_sim::shared_mem_size() const {
@@ -1020,6 +1172,7 @@ bool gpgpu_sim::active() {
   for (unsigned i = 0; i < m_memory_config->m_n_mem; i++)
     if (m_memory_partition_unit[i]->busy() > 0) return true;
   ;
+  if (m_pim_broadcast_hub && m_pim_broadcast_hub->busy()) return true;
   if (icnt_busy()) return true;
   if (get_more_cta_left()) return true;
   return false;
@@ -1094,9 +1247,63 @@ void gpgpu_sim::update_stats() {
   gpu_occupancy = occupancy_stats();
 }
 
+void gpgpu_sim::register_stats() {
+  stats_registry &reg = *m_stats_registry;
+  reg.add("gpu_sim_cycle", &gpu_sim_cycle);
+  reg.add("gpu_sim_insn", &gpu_sim_insn);
+  reg.add("gpu_tot_sim_cycle", &gpu_tot_sim_cycle);
+  reg.add("gpu_tot_sim_insn", &gpu_tot_sim_insn);
+  reg.add("gpu_tot_issued_cta", &gpu_tot_issued_cta);
+  reg.add("gpu_total_cta_launched", &m_total_cta_launched);
+  reg.add("gpu_completed_cta", &gpu_completed_cta);
+  reg.add("gpu_stall_dramfull", &gpu_stall_dramfull);
+  reg.add("gpu_pim_backpressure_cycles", &gpu_pim_backpressure_cycles);
+  reg.add("gpu_stall_icnt2sh", &gpu_stall_icnt2sh);
+  reg.add("partiton_reqs_in_parallel", &partiton_reqs_in_parallel);
+  reg.add("partiton_reqs_in_parallel_total", &partiton_reqs_in_parallel_total);
+  reg.add("partiton_reqs_in_parallel_util", &partiton_reqs_in_parallel_util);
+  reg.add("partiton_reqs_in_parallel_util_total",
+          &partiton_reqs_in_parallel_util_total);
+  reg.add("gpu_sim_cycle_parition_util", &gpu_sim_cycle_parition_util);
+  reg.add("gpu_tot_sim_cycle_parition_util", &gpu_tot_sim_cycle_parition_util);
+  reg.add("partiton_replys_in_parallel", &partiton_replys_in_parallel);
+  reg.add("partiton_replys_in_parallel_total",
+          &partiton_replys_in_parallel_total);
+
+  m_shader_stats->register_stats(reg);
+  m_memory_stats->register_stats(reg);
+  for (unsigned i = 0; i < m_memory_config->m_n_mem; i++)
+    m_memory_partition_unit[i]->register_stats(reg);
+  if (m_pim_broadcast_hub) m_pim_broadcast_hub->register_stats(reg);
+}
+
+void gpgpu_sim::sample_mem_timeseries() {
+  const unsigned subs = m_memory_config->m_n_sub_partition_per_memory_channel;
+  for (unsigned i = 0; i < m_memory_config->m_n_mem; i++) {
+    dram_sample_counters c;
+    m_memory_partition_unit[i]->get_sample_counters(c);
+    c.icnt_stall[MEM_VC] = 0;
+    c.icnt_stall[PIM_VC] = 0;
+    for (unsigned p = 0; p < subs; p++) {
+      const unsigned submpid = i * subs + p;
+      c.icnt_stall[MEM_VC] += m_icnt_L2_vc_stall[submpid * 2 + MEM_VC];
+      c.icnt_stall[PIM_VC] += m_icnt_L2_vc_stall[submpid * 2 + PIM_VC];
+    }
+    m_mem_timeseries->sample(gpu_sim_cycle + gpu_tot_sim_cycle, i, c);
+  }
+}
+
 void gpgpu_sim::print_stats() {
   gpgpu_ctx->stats->ptx_file_line_stats_write_file();
-  gpu_print_stat(0);
+  report_kernel_stats(0);
+  m_stats_registry->dump(STAT_RECORD_KERNEL, gpu_tot_sim_cycle + gpu_sim_cycle,
+                         gpu_tot_sim_insn + gpu_sim_insn);
+  if (g_chrome_trace) g_chrome_trace->flush();
+  if (m_dram_trace_recorder) m_dram_trace_recorder->flush();
+#if SELF_PROF_ON
+  SimProf::print(stdout, gpu_tot_sim_cycle + gpu_sim_cycle,
+                 gpu_tot_sim_insn + gpu_sim_insn);
+#endif
 }
 
 void gpgpu_sim::deadlock_check() {
@@ -1281,6 +1488,37 @@ void gpgpu_sim::clear_executed_kernel_info(unsigned int kernel_uid) {
     }
   }
 }
+// Updates the statistics that are only folded in at the end of a kernel, so
+// that the text report and the stats registry see the same values.  The
+// text report itself only formats them.
+void gpgpu_sim::finalize_kernel_stats() {
+  for (unsigned i = 0; i < m_memory_config->m_n_mem; i++)
+    m_memory_partition_unit[i]->finalize_stats();
+  time_vector_calculate_dist();
+  if (g_network_mode) icnt_update_stats();
+#ifdef GPGPUSIM_POWER_MODEL
+  if (m_config.g_power_simulation_enabled) {
+    m_gpgpusim_wrapper->detect_print_steady_state(
+        1, gpu_tot_sim_insn + gpu_sim_insn);
+  }
+#endif
+}
+
+// The text report is optional (-gpgpu_stats_text); without it the kernel
+// info and the power counters are still reset for the next kernel.
+void gpgpu_sim::report_kernel_stats(unsigned int kernel_uid) {
+  finalize_kernel_stats();
+  if (m_config.gpgpu_stats_text) {
+    gpu_print_stat(kernel_uid);
+  } else {
+    clear_executed_kernel_info(kernel_uid);
+#ifdef GPGPUSIM_POWER_MODEL
+    if (m_config.g_power_simulation_enabled)
+      mcpat_reset_perf_count(m_gpgpusim_wrapper);
+#endif
+  }
+}
+
 void gpgpu_sim::gpu_print_stat(unsigned int kernel_uid) {
   FILE *statfout = stdout;
 
@@ -1306,6 +1544,9 @@ void gpgpu_sim::gpu_print_stat(unsigned int kernel_uid) {
   // performance counter for stalls due to congestion.
   printf("gpu_stall_dramfull = %d\n", gpu_stall_dramfull);
   printf("gpu_stall_icnt2sh    = %d\n", gpu_stall_icnt2sh);
+  if (m_shader_config->gpgpu_pim_throttle > 0)
+    printf("gpu_pim_backpressure_cycles = %llu\n",
+           gpu_pim_backpressure_cycles);
 
   // printf("partiton_reqs_in_parallel = %lld\n", partiton_reqs_in_parallel);
   // printf("partiton_reqs_in_parallel_total    = %lld\n",
@@ -1379,6 +1620,7 @@ void gpgpu_sim::gpu_print_stat(unsigned int kernel_uid) {
                                    m_memory_config->nbk);
   for (unsigned i = 0; i < m_memory_config->m_n_mem; i++)
     m_memory_partition_unit[i]->print(stdout);
+  if (m_pim_broadcast_hub) m_pim_broadcast_hub->print(stdout);
 
   // L2 cache stats
   if (!m_memory_config->m_L2_config.disabled()) {
@@ -1433,13 +1675,6 @@ void gpgpu_sim::gpu_print_stat(unsigned int kernel_uid) {
                  [gpgpu_ctx->func_sim->g_ptx_kernel_count]);
   }
 
-#ifdef GPGPUSIM_POWER_MODEL
-  if (m_config.g_power_simulation_enabled) {
-    m_gpgpusim_wrapper->detect_print_steady_state(
-        1, gpu_tot_sim_insn + gpu_sim_insn);
-  }
-#endif
-
   // Interconnect power stat print
   long total_simt_to_mem = 0;
   long total_mem_to_simt = 0;
@@ -1795,14 +2030,101 @@ void gpgpu_sim::issue_block2core() {
   }
 }
 
+// Memory-only simulation: requests recorded at the L2->DRAM queues
+// (-gpgpu_dram_trace_file) enter the same queues at their recorded core
+// cycle, or as soon as the queue has room.  Replies leave the partitions as
+// if the interconnect always had room for them.
+void gpgpu_sim::replay_dram_trace(dram_trace_reader &trace) {
+  gpu_sim_cycle = 0;
+  reinit_clock_domains();
+  const unsigned n_sub = m_memory_config->m_n_mem_sub_partition;
+  bool partitions_busy = false;
+
+  while (trace.top() || partitions_busy ||
+         (m_pim_broadcast_hub && m_pim_broadcast_hub->busy())) {
+    if (cycle_insn_cta_max_hit()) break;
+    int clock_mask = next_clock_domain();
+    const unsigned long long cycle = gpu_sim_cycle + gpu_tot_sim_cycle;
+    if (g_chrome_trace) g_chrome_trace->set_cycle(cycle);
+
+    if (clock_mask & ICNT) {
+      for (unsigned i = 0; i < n_sub; i++) {
+        mem_fetch *mf = m_memory_sub_partition[i]->top();
+        if (mf) {
+          mf->set_return_timestamp(cycle);
+          if (!mf->get_is_write()) m_memory_stats->memlatstat_read_done(mf);
+          m_memory_sub_partition[i]->pop();
+          partiton_replys_in_parallel++;
+          delete mf;
+        } else {
+          m_memory_sub_partition[i]->pop();
+        }
+      }
+    }
+
+    if (clock_mask & DRAM) {
+      for (unsigned i = 0; i < m_memory_config->m_n_mem; i++) {
+        if (m_memory_config->simple_dram_model)
+          m_memory_partition_unit[i]->simple_dram_model_cycle();
+        else
+          m_memory_partition_unit[i]->dram_cycle();
+      }
+    }
+
+    if (clock_mask & L2) {
+      // the trace is in cycle order, a full queue holds back later records
+      const dram_trace_record *r;
+      while ((r = trace.top()) && r->cycle <= cycle) {
+        unsigned vc = 0;
+        if (m_config.shader_to_mem_vcs > 1) vc = r->is_pim ? PIM_VC : MEM_VC;
+        if (r->sub_partition >= n_sub) {
+          printf("GPGPU-Sim uArch: DRAM trace sub partition %u out of range\n",
+                 r->sub_partition);
+          abort();
+        }
+        memory_sub_partition *sub = m_memory_sub_partition[r->sub_partition];
+        if (sub->L2_dram_queue_full(vc)) break;
+        mem_fetch *mf = trace.create_mem_fetch(*r, m_memory_config,
+                                               m_shader_config, cycle);
+        sub->replay_push(mf, vc, cycle);
+        partiton_reqs_in_parallel++;
+        trace.pop();
+      }
+      for (unsigned i = 0; i < n_sub; i++)
+        m_memory_sub_partition[i]->cache_cycle(cycle);
+    }
+
+    if (clock_mask & CORE) gpu_sim_cycle++;
+
+    partitions_busy = false;
+    for (unsigned i = 0; i < m_memory_config->m_n_mem; i++)
+      if (m_memory_partition_unit[i]->busy()) partitions_busy = true;
+  }
+
+  printf("GPGPU-Sim uArch: DRAM trace replay: %llu requests in %llu cycles\n",
+         trace.n_records(), gpu_sim_cycle);
+  printf("gpu_sim_cycle = %lld\n", gpu_sim_cycle);
+  m_memory_stats->memlatstat_print(m_memory_config->m_n_mem,
+                                   m_memory_config->nbk);
+  for (unsigned i = 0; i < m_memory_config->m_n_mem; i++)
+    m_memory_partition_unit[i]->print(stdout);
+  if (m_pim_broadcast_hub) m_pim_broadcast_hub->print(stdout);
+  m_stats_registry->dump(STAT_RECORD_KERNEL, gpu_tot_sim_cycle + gpu_sim_cycle,
+                         0);
+  if (g_chrome_trace) g_chrome_trace->flush();
+}
+
 unsigned long long g_single_step =
     0;  // set this in gdb to single step the pipeline
 
 void gpgpu_sim::cycle() {
   int clock_mask = next_clock_domain();
+  if (g_chrome_trace)
+    g_chrome_trace->set_cycle(gpu_sim_cycle + gpu_tot_sim_cycle);
 
   if (clock_mask & CORE) {
     // shader core loading (pop from ICNT into core) follows CORE clock
+    SIM_PROF_SCOPE(ICNT_CYCLE);
     for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++)
       m_cluster[i]->icnt_cycle();
   }
@@ -1834,6 +2156,7 @@ void gpgpu_sim::cycle() {
   partiton_replys_in_parallel += partiton_replys_in_parallel_per_cycle;
 
   if (clock_mask & DRAM) {
+    SIM_PROF_SCOPE(DRAM_CYCLE);
     for (unsigned i = 0; i < m_memory_config->m_n_mem; i++) {
       if (m_memory_config->simple_dram_model)
         m_memory_partition_unit[i]->simple_dram_model_cycle();
@@ -1849,14 +2172,38 @@ void gpgpu_sim::cycle() {
           m_power_stats->pwr_mem_stat->n_pre[CURRENT_STAT_IDX][i],
           m_power_stats->pwr_mem_stat->n_rd[CURRENT_STAT_IDX][i],
           m_power_stats->pwr_mem_stat->n_wr[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_req[CURRENT_STAT_IDX][i]);
+          m_power_stats->pwr_mem_stat->n_req[CURRENT_STAT_IDX][i],
+          m_power_stats->pwr_mem_stat->n_pim_act[CURRENT_STAT_IDX][i],
+          m_power_stats->pwr_mem_stat->n_pim_alu[CURRENT_STAT_IDX][i],
+          m_power_stats->pwr_mem_stat->n_pim_reg[CURRENT_STAT_IDX][i]);
+    }
+
+    // PIM queue back-pressure seen by the warp schedulers next core cycle
+    const unsigned pim_queue_size =
+        m_memory_config->gpgpu_frfcfs_dram_pim_queue_size;
+    if (m_shader_config->gpgpu_pim_throttle > 0 && pim_queue_size > 0) {
+      m_pim_congested_channels = 0;
+      for (unsigned i = 0; i < m_memory_config->m_n_mem; i++) {
+        if (m_memory_partition_unit[i]->dram_pim_que_length() >=
+            m_shader_config->gpgpu_pim_throttle * pim_queue_size)
+          m_pim_congested_channels++;
+      }
+      if (m_pim_congested_channels) gpu_pim_backpressure_cycles++;
     }
   }
 
   // L2 operations follow L2 clock domain
   unsigned partiton_reqs_in_parallel_per_cycle = 0;
   if (clock_mask & L2) {
+    SIM_PROF_SCOPE(CACHE_CYCLE);
     m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX].clear();
+    if (m_wcb_drain_requested) {
+      for (unsigned i = 0; i < m_memory_config->m_n_mem_sub_partition; i++) {
+        write_combining_buffer *wcb = m_memory_sub_partition[i]->get_wcb();
+        if (wcb) wcb->drain();
+      }
+      m_wcb_drain_requested = false;
+    }
     for (unsigned i = 0; i < m_memory_config->m_n_mem_sub_partition; i++) {
       // move memory request from interconnect into memory partition (if not
       // backed up) Note:This needs to be called in DRAM clock domain if there
@@ -1882,6 +2229,9 @@ void gpgpu_sim::cycle() {
             m_prev_icnt_L2_vc[i] = vc;
             break;
           }
+        } else if (icnt_has_packet(m_shader_config->mem2device(i), vc)) {
+          // a request of this VC is waiting for the full L2 queue
+          m_icnt_L2_vc_stall[i * 2 + (vc == MEM_VC ? MEM_VC : PIM_VC)]++;
         }
       }
 
@@ -1900,14 +2250,19 @@ void gpgpu_sim::cycle() {
   }
 
   if (clock_mask & ICNT) {
+    SIM_PROF_SCOPE(ICNT_TRANSFER);
     icnt_transfer();
   }
 
   if (clock_mask & CORE) {
     // L1 cache + shader core pipeline stages
     m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX].clear();
+    // CTAs are only issued after the core cycle, so this holds for every
+    // cluster this cycle
+    const bool more_cta_left = get_more_cta_left();
     for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++) {
-      if (m_cluster[i]->get_not_completed() || get_more_cta_left()) {
+      if (more_cta_left || m_cluster[i]->get_not_completed()) {
+        SIM_PROF_SCOPE(CORE_CYCLE);
         m_cluster[i]->core_cycle();
         *active_sms += m_cluster[i]->get_n_active_sms();
       }
@@ -1941,6 +2296,7 @@ void gpgpu_sim::cycle() {
       // McPAT main cycle (interface with McPAT)
 #ifdef GPGPUSIM_POWER_MODEL
     if (m_config.g_power_simulation_enabled) {
+      SIM_PROF_SCOPE(MCPAT_CYCLE);
       mcpat_cycle(m_config, getShaderCoreConfig(), m_gpgpusim_wrapper,
                   m_power_stats, m_config.gpu_stat_sample_freq,
                   gpu_tot_sim_cycle, gpu_sim_cycle, gpu_tot_sim_insn,
@@ -1986,6 +2342,11 @@ void gpgpu_sim::cycle() {
       }
     }
 
+    if (m_mem_timeseries &&
+        !((gpu_sim_cycle + gpu_tot_sim_cycle) %
+          m_config.gpgpu_mem_sample_interval))
+      sample_mem_timeseries();
+
     if (!(gpu_sim_cycle % m_config.gpu_stat_sample_freq)) {
       time_t days, hrs, minutes, sec;
       time_t curr_time;
@@ -2017,6 +2378,10 @@ void gpgpu_sim::cycle() {
         last_liveness_message_time = elapsed_time;
       }
       visualizer_printstat();
+      if (m_config.gpgpu_stats_binary_sample)
+        m_stats_registry->dump(STAT_RECORD_SAMPLE,
+                               gpu_tot_sim_cycle + gpu_sim_cycle,
+                               gpu_tot_sim_insn + gpu_sim_insn);
       m_memory_stats->memlatstat_lat_pw();
       if (m_config.gpgpu_runtime_stat &&
           (m_config.gpu_runtime_stat_flag != 0)) {
@@ -2134,4 +2499,13 @@ const shader_core_config *gpgpu_sim::getShaderCoreConfig() {
 
 const memory_config *gpgpu_sim::getMemoryConfig() { return m_memory_config; }
 
+void *gpgpu_sim::gpu_malloc_pim(size_t size) {
+  void *ptr = gpu_malloc(size);
+  new_addr_type start = (new_addr_type)ptr;
+  m_memory_config->m_address_mapping.add_pim_region(start, size);
+  if (m_dram_trace_recorder)
+    m_dram_trace_recorder->record_pim_region(start, size);
+  return ptr;
+}
+
 simt_core_cluster *gpgpu_sim::getSIMTCluster() { return *m_cluster; }
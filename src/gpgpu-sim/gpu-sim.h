@@ -38,6 +38,8 @@
 #include "../trace.h"
 #include "addrdec.h"
 #include "gpu-cache.h"
+#include "dram_sched_tuner.h"
+#include "pim_unit.h"
 #include "shader.h"
 
 // constants for statistics printouts
@@ -66,24 +68,6 @@ class gpgpu_context;
 
 extern tr1_hash_map<new_addr_type, unsigned> address_random_interleaving;
 
-enum dram_ctrl_t {
-    DRAM_FIFO = 0,
-    DRAM_FRFCFS = 1,
-    DRAM_PIM_FRFCFS = 2,
-    DRAM_MEM_FIRST = 3,
-    DRAM_PIM_FIRST = 4,
-    DRAM_GI = 5,
-    DRAM_GI_MEM = 6,
-    DRAM_BLISS = 7,
-    DRAM_FR_RR_FCFS = 8,
-    DRAM_RR_BATCH_CAP = 9,
-    DRAM_RR_REQ_CAP = 10,
-    DRAM_RR_MEM = 11,
-    DRAM_PAWS = 12,
-    DRAM_PAWS_NEW = 13,
-    NUM_DRAM_POLICIES
-};
-
 enum request_vc_t { MEM_VC = 0, PIM_VC = 1 };
 
 struct power_config {
@@ -260,6 +244,9 @@ class memory_config {
     sscanf(pim_queue_size_opt, "%d:%d:%d",
            &gpgpu_frfcfs_dram_pim_queue_size, &pim_high_watermark,
            &pim_low_watermark);
+
+    m_pim_unit_config.init(dram_pim_unit_opt);
+    m_sched_tuner_config.init(dram_sched_tuner_opt, dram_sched_tuner_log);
   }
   void reg_options(class OptionParser *opp);
 
@@ -277,7 +264,7 @@ class memory_config {
   unsigned queue_low_watermark;
 
   unsigned gpgpu_dram_return_queue_size;
-  enum dram_ctrl_t scheduler_type;
+  char *dram_scheduler_name;
   bool gpgpu_memlatency_stat;
   unsigned m_n_mem;
   unsigned m_n_sub_partition_per_memory_channel;
@@ -353,6 +340,19 @@ class memory_config {
   unsigned pim_low_watermark;
   unsigned min_pim_batches;
   float max_pim_slowdown;
+  char *dram_sched_tuner_opt;
+  char *dram_sched_tuner_log;
+  dram_sched_tuner_config m_sched_tuner_config;
+  bool dram_pim_bankgrp_mode;
+  char *dram_pim_unit_opt;
+  pim_unit_config m_pim_unit_config;
+  unsigned dram_pim_op_bit;  // low bit of the op class field, 0 = all MAC
+  unsigned dram_pim_broadcast_bit;  // 0 = no broadcast PIM writes
+  char *dram_pim_broadcast_channels;
+  unsigned dram_pim_broadcast_latency;
+  unsigned l2_wcb_entries;  // 0 = no write combining of PIM writes
+  unsigned l2_wcb_block_size;
+  unsigned l2_wcb_timeout;
 
   unsigned bliss_clearing_interval;
   unsigned bliss_blacklisting_threshold;
@@ -380,6 +380,10 @@ class gpgpu_sim_config : public power_config,
            &gpu_runtime_stat_flag);
     m_shader_config.init();
     ptx_set_tex_cache_linesize(m_shader_config.m_L1T_config.get_line_sz());
+    g_generic_mem_layout.init(m_shader_config.num_shader(),
+                              m_shader_config.n_thread_per_shader,
+                              m_shader_config.max_shmem_size(),
+                              m_shader_config.gpgpu_local_mem_size_max);
     m_memory_config.init();
     init_clock_domains();
     power_config::init();
@@ -462,6 +466,14 @@ class gpgpu_sim_config : public power_config,
   // statistics collection
   int gpu_stat_sample_freq;
   int gpu_runtime_stat_flag;
+  bool gpgpu_stats_text;
+  char *gpgpu_stats_binary_file;
+  bool gpgpu_stats_binary_sample;
+  unsigned gpgpu_mem_sample_interval;
+  char *gpgpu_mem_sample_file;
+  char *gpgpu_chrome_trace_file;
+  unsigned gpgpu_chrome_trace_sample;
+  char *gpgpu_dram_trace_file;
 
   // Device Limits
   size_t stack_size_limit;
@@ -581,6 +593,28 @@ class gpgpu_sim : public gpgpu_t {
   void decrement_kernel_latency();
 
   const gpgpu_sim_config &get_config() const { return m_config; }
+  // NULL unless -dram_pim_broadcast_bit is set
+  class pim_broadcast_hub *get_pim_broadcast_hub() const {
+    return m_pim_broadcast_hub;
+  }
+  // NULL unless -gpgpu_dram_trace_file is set
+  class dram_trace_recorder *get_dram_trace_recorder() const {
+    return m_dram_trace_recorder;
+  }
+  // a warp waits at a PIM fence: flush the L2 write-combining buffers on the
+  // next L2 cycle instead of letting their blocks time out
+  void request_wcb_drain() { m_wcb_drain_requested = true; }
+  // set while the PIM queue of some DRAM channel is above
+  // -gpgpu_pim_throttle, read by the warp schedulers
+  bool pim_backpressure() const { return m_pim_congested_channels > 0; }
+  // device memory for cudaMallocPIM, laid out by -gpgpu_pim_addr_mapping
+  void *gpu_malloc_pim(size_t size);
+  // memory-only simulation driven by a recorded L2->DRAM request stream
+  void replay_dram_trace(class dram_trace_reader &trace);
+  // end-of-kernel statistics bookkeeping, with or without -gpgpu_stats_text
+  void finalize_kernel_stats();
+  // finalize_kernel_stats() and the text report if -gpgpu_stats_text
+  void report_kernel_stats(unsigned int kernel_uid);
   void gpu_print_stat(unsigned int kernel_uid);
   void dump_pipeline(int mask, int s, int m) const;
 
@@ -627,6 +661,8 @@ class gpgpu_sim : public gpgpu_t {
   void shader_print_cache_stats(FILE *fout) const;
   void shader_print_scheduler_stat(FILE *fout, bool print_dynamic_info) const;
   void visualizer_printstat();
+  void register_stats();
+  void sample_mem_timeseries();
   void print_shader_cycle_distro(FILE *fout) const;
 
   void gpgpu_debug();
@@ -670,6 +706,12 @@ class gpgpu_sim : public gpgpu_t {
   class shader_core_stats *m_shader_stats;
   class memory_stats_t *m_memory_stats;
   class power_stat_t *m_power_stats;
+  class stats_registry *m_stats_registry;
+  class mem_timeseries *m_mem_timeseries;
+  class pim_broadcast_hub *m_pim_broadcast_hub;
+  unsigned m_pim_congested_channels;
+  bool m_wcb_drain_requested;
+  class dram_trace_recorder *m_dram_trace_recorder;
   class gpgpu_sim_wrapper *m_gpgpusim_wrapper;
   unsigned long long last_gpu_sim_insn;
 
@@ -693,6 +735,9 @@ class gpgpu_sim : public gpgpu_t {
 
   // Interconnect virtual channel metadata
   std::vector<unsigned> m_prev_icnt_L2_vc;
+  // cycles a request waited in icnt for a full L2 queue,
+  // [sub partition][MEM_VC/PIM_VC]
+  std::vector<unsigned long long> m_icnt_L2_vc_stall;
 
  public:
   unsigned long long gpu_sim_insn;
@@ -705,6 +750,8 @@ class gpgpu_sim : public gpgpu_t {
   // performance counter for stalls due to congestion.
   unsigned int gpu_stall_dramfull;
   unsigned int gpu_stall_icnt2sh;
+  // DRAM cycles with a channel's PIM queue above -gpgpu_pim_throttle
+  unsigned long long gpu_pim_backpressure_cycles;
   unsigned long long partiton_reqs_in_parallel;
   unsigned long long partiton_reqs_in_parallel_total;
   unsigned long long partiton_reqs_in_parallel_util;
@@ -37,8 +37,10 @@ icnt_init_p icnt_init;
 icnt_has_buffer_p icnt_has_buffer;
 icnt_push_p icnt_push;
 icnt_pop_p icnt_pop;
+icnt_has_packet_p icnt_has_packet;
 icnt_transfer_p icnt_transfer;
 icnt_busy_p icnt_busy;
+icnt_update_stats_p icnt_update_stats;
 icnt_display_stats_p icnt_display_stats;
 icnt_display_overall_stats_p icnt_display_overall_stats;
 icnt_display_state_p icnt_display_state;
@@ -63,22 +65,28 @@ static void intersim2_init() { g_icnt_interface->Init(); }
 
 static bool intersim2_has_buffer(unsigned input, unsigned int size,
                                  bool is_pim) {
-  return g_icnt_interface->HasBuffer(input, size);
+  return g_icnt_interface->HasBuffer(input, size, is_pim);
 }
 
 static void intersim2_push(unsigned input, unsigned output, void* data,
                            unsigned int size, bool is_pim) {
-  g_icnt_interface->Push(input, output, data, size);
+  g_icnt_interface->Push(input, output, data, size, is_pim);
 }
 
 static void* intersim2_pop(unsigned output, unsigned vc) {
   return g_icnt_interface->Pop(output, vc);
 }
 
+static bool intersim2_has_packet(unsigned output, unsigned vc) {
+  return g_icnt_interface->HasPacket(output, vc);
+}
+
 static void intersim2_transfer() { g_icnt_interface->Advance(); }
 
 static bool intersim2_busy() { return g_icnt_interface->Busy(); }
 
+static void intersim2_update_stats() { g_icnt_interface->UpdateStats(); }
+
 static void intersim2_display_stats() { g_icnt_interface->DisplayStats(); }
 
 static void intersim2_display_overall_stats() {
@@ -116,10 +124,16 @@ static void* LocalInterconnect_pop(unsigned output, unsigned vc) {
   return g_localicnt_interface->Pop(output, vc);
 }
 
+static bool LocalInterconnect_has_packet(unsigned output, unsigned vc) {
+  return g_localicnt_interface->HasPacket(output, vc);
+}
+
 static void LocalInterconnect_transfer() { g_localicnt_interface->Advance(); }
 
 static bool LocalInterconnect_busy() { return g_localicnt_interface->Busy(); }
 
+static void LocalInterconnect_update_stats() {}
+
 static void LocalInterconnect_display_stats() {
   g_localicnt_interface->DisplayStats();
 }
@@ -166,14 +180,17 @@ void icnt_wrapper_init(unsigned shader_to_mem_vcs) {
   switch (g_network_mode) {
     case INTERSIM:
       // FIXME: delete the object: may add icnt_done wrapper
-      g_icnt_interface = InterconnectInterface::New(g_network_config_filename);
+      g_icnt_interface = InterconnectInterface::New(g_network_config_filename,
+                                                    shader_to_mem_vcs);
       icnt_create = intersim2_create;
       icnt_init = intersim2_init;
       icnt_has_buffer = intersim2_has_buffer;
       icnt_push = intersim2_push;
       icnt_pop = intersim2_pop;
+      icnt_has_packet = intersim2_has_packet;
       icnt_transfer = intersim2_transfer;
       icnt_busy = intersim2_busy;
+      icnt_update_stats = intersim2_update_stats;
       icnt_display_stats = intersim2_display_stats;
       icnt_display_overall_stats = intersim2_display_overall_stats;
       icnt_display_state = intersim2_display_state;
@@ -187,8 +204,10 @@ void icnt_wrapper_init(unsigned shader_to_mem_vcs) {
       icnt_has_buffer = LocalInterconnect_has_buffer;
       icnt_push = LocalInterconnect_push;
       icnt_pop = LocalInterconnect_pop;
+      icnt_has_packet = LocalInterconnect_has_packet;
       icnt_transfer = LocalInterconnect_transfer;
       icnt_busy = LocalInterconnect_busy;
+      icnt_update_stats = LocalInterconnect_update_stats;
       icnt_display_stats = LocalInterconnect_display_stats;
       icnt_display_overall_stats = LocalInterconnect_display_overall_stats;
       icnt_display_state = LocalInterconnect_display_state;
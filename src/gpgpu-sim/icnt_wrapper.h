@@ -40,9 +40,11 @@ typedef bool (*icnt_has_buffer_p)(unsigned input, unsigned int size,
 typedef void (*icnt_push_p)(unsigned input, unsigned output, void* data,
                             unsigned int size, bool is_pim);
 typedef void* (*icnt_pop_p)(unsigned output, unsigned vc);
+typedef bool (*icnt_has_packet_p)(unsigned output, unsigned vc);
 typedef void (*icnt_transfer_p)();
 typedef bool (*icnt_busy_p)();
 typedef void (*icnt_drain_p)();
+typedef void (*icnt_update_stats_p)();
 typedef void (*icnt_display_stats_p)();
 typedef void (*icnt_display_overall_stats_p)();
 typedef void (*icnt_display_state_p)(FILE* fp);
@@ -53,9 +55,13 @@ extern icnt_init_p icnt_init;
 extern icnt_has_buffer_p icnt_has_buffer;
 extern icnt_push_p icnt_push;
 extern icnt_pop_p icnt_pop;
+// icnt_pop(output, vc) would return a packet
+extern icnt_has_packet_p icnt_has_packet;
 extern icnt_transfer_p icnt_transfer;
 extern icnt_busy_p icnt_busy;
 extern icnt_drain_p icnt_drain;
+// end-of-kernel statistics update, called before icnt_display_stats
+extern icnt_update_stats_p icnt_update_stats;
 extern icnt_display_stats_p icnt_display_stats;
 extern icnt_display_overall_stats_p icnt_display_overall_stats;
 extern icnt_display_state_p icnt_display_state;
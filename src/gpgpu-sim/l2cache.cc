@@ -37,6 +37,7 @@
 #include "../option_parser.h"
 #include "../statwrapper.h"
 #include "dram.h"
+#include "dram_trace.h"
 #include "gpu-cache.h"
 #include "gpu-sim.h"
 #include "histogram.h"
@@ -44,7 +45,9 @@
 #include "l2cache_trace.h"
 #include "mem_fetch.h"
 #include "mem_latency_stat.h"
+#include "pim_broadcast.h"
 #include "shader.h"
+#include "write_combining.h"
 
 mem_fetch *partition_mf_allocator::alloc(new_addr_type addr,
                                          mem_access_type type, unsigned size,
@@ -324,10 +327,29 @@ void memory_partition_unit::simple_dram_model_cycle() {
 }
 
 void memory_partition_unit::dram_cycle() {
+  pim_broadcast_hub *hub = m_gpu->get_pim_broadcast_hub();
+  const unsigned long long cycle =
+      m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle;
+
+  // ack broadcast PIM writes once every channel has executed them
+  mem_fetch *mf_ack = hub ? hub->ack_top(m_id) : NULL;
+  if (mf_ack) {
+    unsigned dest_global_spid = mf_ack->get_sub_partition_id();
+    int dest_spid = global_sub_partition_id_to_local_id(dest_global_spid);
+    if (!m_sub_partition[dest_spid]->dram_L2_queue_full()) {
+      m_sub_partition[dest_spid]->dram_L2_queue_push(mf_ack);
+      mf_ack->set_status(IN_PARTITION_DRAM_TO_L2_QUEUE, cycle);
+      m_arbitration_metadata.return_credit(dest_spid);
+      hub->ack_pop(m_id);
+    }
+  }
+
   // pop completed memory request from dram and push it to dram-to-L2 queue
   // of the original sub partition
   mem_fetch *mf_return = m_dram->return_queue_top();
-  if (mf_return) {
+  if (mf_return && hub && hub->dram_done(mf_return)) {
+    m_dram->return_queue_pop();
+  } else if (mf_return) {
     unsigned dest_global_spid = mf_return->get_sub_partition_id();
     int dest_spid = global_sub_partition_id_to_local_id(dest_global_spid);
     assert(m_sub_partition[dest_spid]->get_id() == dest_global_spid);
@@ -375,6 +397,7 @@ void memory_partition_unit::dram_cycle() {
         if (m_dram->full(mf->is_write(), mf->is_pim())) continue;
 
         m_sub_partition[spid]->L2_dram_queue_pop(vc);
+        if (hub && hub->is_broadcast(mf)) hub->replicate(mf, cycle);
         MEMPART_DPRINTF(
             "Issue mem_fetch request %p from sub partition/vc %d/%u to dram\n",
             mf, spid, vc);
@@ -395,6 +418,15 @@ void memory_partition_unit::dram_cycle() {
     }
   }
 
+  // replicas of broadcast PIM writes from other channels go first, they
+  // hold back the ack of a request that is already done elsewhere
+  mem_fetch *replica = hub ? hub->replica_top(m_id, cycle) : NULL;
+  if (replica && !m_dram->full(true, true)) {
+    hub->replica_pop(m_id);
+    m_dram->push(replica);
+    return;
+  }
+
   // DRAM latency queue
   for (unsigned vc_iter = 0; vc_iter < shader_to_mem_vcs; vc_iter++) {
     unsigned vc = (vc_iter + m_prev_dram_latency_queue_vc + 1) % \
@@ -432,13 +464,28 @@ void memory_partition_unit::set_done(mem_fetch *mf) {
 
 void memory_partition_unit::set_dram_power_stats(
     unsigned &n_cmd, unsigned &n_activity, unsigned &n_nop, unsigned &n_act,
-    unsigned &n_pre, unsigned &n_rd, unsigned &n_wr, unsigned &n_req) const {
+    unsigned &n_pre, unsigned &n_rd, unsigned &n_wr, unsigned &n_req,
+    unsigned &n_pim_act, unsigned &n_pim_alu, unsigned &n_pim_reg) const {
   m_dram->set_dram_power_stats(n_cmd, n_activity, n_nop, n_act, n_pre, n_rd,
-                               n_wr, n_req);
+                               n_wr, n_req, n_pim_act, n_pim_alu, n_pim_reg);
+}
+
+void memory_partition_unit::register_stats(stats_registry &reg) const {
+  m_dram->register_stats(reg);
+  for (unsigned p = 0; p < m_config->m_n_sub_partition_per_memory_channel;
+       p++) {
+    write_combining_buffer *wcb = m_sub_partition[p]->get_wcb();
+    if (wcb) wcb->register_stats(reg, m_sub_partition[p]->get_id());
+  }
 }
 
 void memory_partition_unit::print(FILE *fp) const {
   fprintf(fp, "Memory Partition %u: \n", m_id);
+  for (unsigned p = 0; p < m_config->m_n_sub_partition_per_memory_channel;
+       p++) {
+    write_combining_buffer *wcb = m_sub_partition[p]->get_wcb();
+    if (wcb) wcb->print(fp, m_sub_partition[p]->get_id());
+  }
   // Sudhanshu: we don't need this much info!
   //for (unsigned p = 0; p < m_config->m_n_sub_partition_per_memory_channel;
   //     p++) {
@@ -513,6 +560,10 @@ memory_sub_partition::memory_sub_partition(unsigned sub_partition_id,
   m_prev_icnt_L2_vc = 0;
   m_prev_L2_dram_vc = 0;
 
+  m_wcb = NULL;
+  m_wcb_vc = (shader_to_mem_vcs > 1) ? PIM_VC : 0;
+  if (m_config->l2_wcb_entries) m_wcb = new write_combining_buffer(config);
+
   wb_addr = -1;
 }
 
@@ -525,6 +576,7 @@ memory_sub_partition::~memory_sub_partition() {
   delete m_L2_icnt_queue;
   delete m_L2cache;
   delete m_L2interface;
+  delete m_wcb;
 }
 
 void memory_sub_partition::cache_cycle(unsigned cycle) {
@@ -577,9 +629,28 @@ void memory_sub_partition::cache_cycle(unsigned cycle) {
     }
   }
 
+  // writes folded into a write-combining block are acked once the block's
+  // leader is back from DRAM
+  if (m_wcb && m_wcb->ack_top() && !m_L2_icnt_queue->full()) {
+    mem_fetch *mf = m_wcb->ack_top();
+    mf->set_status(IN_PARTITION_L2_TO_ICNT_QUEUE,
+                   m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
+    m_L2_icnt_queue->push(mf);
+    m_wcb->ack_pop();
+  }
+
   // prior L2 misses inserted into m_L2_dram_queue here
   if (!m_config->m_L2_config.disabled()) m_L2cache->cycle();
 
+  // complete, timed out or drained write-combining blocks
+  if (m_wcb && m_wcb->ready_top(cycle) &&
+      !m_L2_dram_queue[m_wcb_vc]->full()) {
+    mem_fetch *mf = m_wcb->pop(cycle);
+    mf->set_status(IN_PARTITION_L2_TO_DRAM_QUEUE,
+                   m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
+    L2_dram_queue_push(m_wcb_vc, mf);
+  }
+
   // new L2 texture accesses and/or non-texture accesses
   bool icnt_L2_queue_serviced = false;
 
@@ -649,11 +720,29 @@ void memory_sub_partition::cache_cycle(unsigned cycle) {
             // L2 cache lock-up: will try again next cycle
           }
         }
+      } else if (m_wcb && m_wcb->can_combine(mf)) {
+        // PIM / streaming write: fold it into an open block or open one,
+        // flushing the oldest block when all entries are taken
+        if (!m_wcb->merge(mf)) {
+          if (m_wcb->full()) {
+            mem_fetch *oldest = m_wcb->pop(cycle);
+            oldest->set_status(IN_PARTITION_L2_TO_DRAM_QUEUE,
+                               m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
+            L2_dram_queue_push(m_wcb_vc, oldest);
+          }
+          m_wcb->insert(mf, cycle);
+        }
+        m_icnt_L2_queue[vc]->pop();
+        icnt_L2_queue_serviced = true;
+      } else if (m_wcb && mf->is_pim() && !m_wcb->empty()) {
+        // other PIM requests (e.g. result reads) must not overtake buffered
+        // PIM writes: flush them and retry
+        m_wcb->drain();
       } else {
         // L2 is disabled or non-texture access to texture-only L2
         mf->set_status(IN_PARTITION_L2_TO_DRAM_QUEUE,
                        m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
-        m_L2_dram_queue[vc]->push(mf);
+        L2_dram_queue_push(vc, mf);
         m_icnt_L2_queue[vc]->pop();
         icnt_L2_queue_serviced = true;
       }
@@ -686,6 +775,24 @@ bool memory_sub_partition::full(unsigned vc, unsigned size) const {
   return m_icnt_L2_queue[vc]->is_avilable_size(size);
 }
 
+bool memory_sub_partition::L2_dram_queue_full(unsigned vc) const {
+  return m_L2_dram_queue[vc]->full();
+}
+
+void memory_sub_partition::L2_dram_queue_push(unsigned vc, mem_fetch *mf) {
+  dram_trace_recorder *recorder = m_gpu->get_dram_trace_recorder();
+  if (recorder)
+    recorder->record(mf, m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
+  m_L2_dram_queue[vc]->push(mf);
+}
+
+void memory_sub_partition::replay_push(mem_fetch *mf, unsigned vc,
+                                       unsigned long long cycle) {
+  m_request_tracker.insert(mf);
+  mf->set_status(IN_PARTITION_L2_TO_DRAM_QUEUE, cycle);
+  m_L2_dram_queue[vc]->push(mf);
+}
+
 bool memory_sub_partition::L2_dram_queue_empty(unsigned vc) const {
   return m_L2_dram_queue[vc]->empty();
 }
@@ -703,6 +810,7 @@ bool memory_sub_partition::dram_L2_queue_full() const {
 }
 
 void memory_sub_partition::dram_L2_queue_push(class mem_fetch *mf) {
+  if (m_wcb) m_wcb->dram_done(mf);
   m_dram_L2_queue->push(mf);
 }
 
@@ -755,6 +863,9 @@ void gpgpu_sim::print_dram_stats(FILE *fout) const {
   unsigned rd = 0;
   unsigned wr = 0;
   unsigned req = 0;
+  unsigned pim_act = 0;
+  unsigned pim_alu = 0;
+  unsigned pim_reg = 0;
   unsigned tot_cmd = 0;
   unsigned tot_nop = 0;
   unsigned tot_act = 0;
@@ -762,10 +873,13 @@ void gpgpu_sim::print_dram_stats(FILE *fout) const {
   unsigned tot_rd = 0;
   unsigned tot_wr = 0;
   unsigned tot_req = 0;
+  unsigned tot_pim_act = 0;
+  unsigned tot_pim_alu = 0;
+  unsigned tot_pim_reg = 0;
 
   for (unsigned i = 0; i < m_memory_config->m_n_mem; i++) {
-    m_memory_partition_unit[i]->set_dram_power_stats(cmd, activity, nop, act,
-                                                     pre, rd, wr, req);
+    m_memory_partition_unit[i]->set_dram_power_stats(
+        cmd, activity, nop, act, pre, rd, wr, req, pim_act, pim_alu, pim_reg);
     tot_cmd += cmd;
     tot_nop += nop;
     tot_act += act;
@@ -773,12 +887,18 @@ void gpgpu_sim::print_dram_stats(FILE *fout) const {
     tot_rd += rd;
     tot_wr += wr;
     tot_req += req;
+    tot_pim_act += pim_act;
+    tot_pim_alu += pim_alu;
+    tot_pim_reg += pim_reg;
   }
   fprintf(fout, "gpgpu_n_dram_reads = %d\n", tot_rd);
   fprintf(fout, "gpgpu_n_dram_writes = %d\n", tot_wr);
   fprintf(fout, "gpgpu_n_dram_activate = %d\n", tot_act);
   fprintf(fout, "gpgpu_n_dram_commands = %d\n", tot_cmd);
   fprintf(fout, "gpgpu_n_dram_noops = %d\n", tot_nop);
+  fprintf(fout, "gpgpu_n_dram_pim_act_banks = %u\n", tot_pim_act);
+  fprintf(fout, "gpgpu_n_dram_pim_alu_ops = %u\n", tot_pim_alu);
+  fprintf(fout, "gpgpu_n_dram_pim_reg_accesses = %u\n", tot_pim_reg);
   fprintf(fout, "gpgpu_n_dram_precharges = %d\n", tot_pre);
   fprintf(fout, "gpgpu_n_dram_requests = %d\n", tot_req);
 }
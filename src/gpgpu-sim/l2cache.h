@@ -77,7 +77,13 @@ class memory_partition_unit {
   void visualizer_print(gzFile visualizer_file) const;
   void print_stat(FILE *fp) { m_dram->print_stat(fp); }
   void visualize() const { m_dram->visualize(); }
+  void register_stats(class stats_registry &reg) const;
+  void get_sample_counters(struct dram_sample_counters &c) const {
+    m_dram->get_sample_counters(c);
+  }
+  unsigned dram_pim_que_length() const { return m_dram->pim_que_length(); }
   void print(FILE *fp) const;
+  void finalize_stats() { m_dram->finalize_stats(); }
   void handle_memcpy_to_gpu(size_t dst_start_addr, unsigned subpart_id,
                             mem_access_sector_mask_t mask);
 
@@ -88,8 +94,9 @@ class memory_partition_unit {
   // Power model
   void set_dram_power_stats(unsigned &n_cmd, unsigned &n_activity,
                             unsigned &n_nop, unsigned &n_act, unsigned &n_pre,
-                            unsigned &n_rd, unsigned &n_wr,
-                            unsigned &n_req) const;
+                            unsigned &n_rd, unsigned &n_wr, unsigned &n_req,
+                            unsigned &n_pim_act, unsigned &n_pim_alu,
+                            unsigned &n_pim_reg) const;
 
   int global_sub_partition_id_to_local_id(int global_sub_partition_id) const;
 
@@ -174,6 +181,7 @@ class memory_sub_partition {
   unsigned invalidateL2();
 
   // interface to L2_dram_queue
+  bool L2_dram_queue_full(unsigned vc) const;
   bool L2_dram_queue_empty(unsigned vc) const;
   class mem_fetch *L2_dram_queue_top(unsigned vc) const;
   void L2_dram_queue_pop(unsigned vc);
@@ -202,7 +210,16 @@ class memory_sub_partition {
   unsigned get_prev_L2_dram_vc() { return m_prev_L2_dram_vc; }
   void set_prev_L2_dram_vc(unsigned vc) { m_prev_L2_dram_vc = vc; }
 
+  // trace replay: a recorded L2 miss enters the L2->DRAM queue directly
+  void replay_push(class mem_fetch *mf, unsigned vc,
+                   unsigned long long cycle);
+
+  // NULL unless -gpgpu_l2_wcb_entries is set
+  class write_combining_buffer *get_wcb() const { return m_wcb; }
+
  private:
+  void L2_dram_queue_push(unsigned vc, class mem_fetch *mf);
+
   // data
   unsigned m_id;  //< the global sub partition ID
   const memory_config *m_config;
@@ -229,6 +246,9 @@ class memory_sub_partition {
   fifo_pipeline<mem_fetch> *m_dram_L2_queue;
   fifo_pipeline<mem_fetch> *m_L2_icnt_queue;  // L2 cache hit response queue
 
+  class write_combining_buffer *m_wcb;
+  unsigned m_wcb_vc;  // L2->DRAM queue the buffer flushes into
+
   class mem_fetch *L2dramout;
   unsigned long long int wb_addr;
 
@@ -269,11 +289,11 @@ class L2interface : public mem_fetch_interface {
   virtual void push(mem_fetch *mf) {
     mf->set_status(IN_PARTITION_L2_TO_DRAM_QUEUE, 0 /*FIXME*/);
     if (m_num_vcs > 1) {
-      if (mf->is_pim()) { m_unit->m_L2_dram_queue[PIM_VC]->push(mf); }
-      else              { m_unit->m_L2_dram_queue[MEM_VC]->push(mf); }
+      if (mf->is_pim()) { m_unit->L2_dram_queue_push(PIM_VC, mf); }
+      else              { m_unit->L2_dram_queue_push(MEM_VC, mf); }
     }
     else {
-      m_unit->m_L2_dram_queue[0]->push(mf);
+      m_unit->L2_dram_queue_push(0, mf);
     }
   }
 
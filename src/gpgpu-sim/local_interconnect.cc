@@ -121,6 +121,11 @@ void* xbar_router::Pop(unsigned output_deviceID, unsigned vc) {
   return data;
 }
 
+bool xbar_router::Has_Packet(unsigned output_deviceID, unsigned vc) const {
+  assert(output_deviceID < total_nodes);
+  return !out_buffers[output_deviceID][vc].empty();
+}
+
 bool xbar_router::Has_Buffer_In(unsigned input_deviceID, unsigned vc,
                                 unsigned size, bool update_counter) {
   assert((input_deviceID < total_nodes) && (vc < num_vcs));
@@ -459,6 +464,14 @@ void* LocalInterconnect::Pop(unsigned output_deviceID, unsigned vc) {
   return net[subnet]->Pop(output_deviceID, vc);
 }
 
+bool LocalInterconnect::HasPacket(unsigned output_deviceID,
+                                  unsigned vc) const {
+  int subnet = 0;
+  if (output_deviceID < n_shader) subnet = 1;
+
+  return net[subnet]->Has_Packet(output_deviceID, vc);
+}
+
 void LocalInterconnect::Advance() {
   for (unsigned i = 0; i < n_subnets; ++i) {
     net[i]->Advance();
@@ -60,6 +60,7 @@ class xbar_router {
   void Push(unsigned input_deviceID, unsigned output_deviceID, unsigned vc,
           void* data, unsigned int size);
   void* Pop(unsigned ouput_deviceID, unsigned vc);
+  bool Has_Packet(unsigned output_deviceID, unsigned vc) const;
   void Advance();
 
   bool Busy() const;
@@ -127,6 +128,7 @@ class LocalInterconnect {
   void Push(unsigned input_deviceID, unsigned output_deviceID, void* data,
             unsigned int size, bool is_pim);
   void* Pop(unsigned ouput_deviceID, unsigned vc);
+  bool HasPacket(unsigned output_deviceID, unsigned vc) const;
   void Advance();
   bool Busy() const;
   bool HasBuffer(unsigned deviceID, unsigned int size, bool is_pim) const;
@@ -27,6 +27,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "mem_fetch.h"
+#include "chrome_trace.h"
 #include "gpu-sim.h"
 #include "mem_latency_stat.h"
 #include "shader.h"
@@ -75,7 +76,11 @@ mem_fetch::mem_fetch(const mem_access_t &access, const warp_inst_t *inst,
   }
 }
 
-mem_fetch::~mem_fetch() { m_status = MEM_FETCH_DELETED; }
+mem_fetch::~mem_fetch() {
+  if (g_chrome_trace && g_chrome_trace->sampled(m_request_uid))
+    g_chrome_trace->mf_deleted(this, m_status, m_status_change);
+  m_status = MEM_FETCH_DELETED;
+}
 
 #define MF_TUP_BEGIN(X) static const char *Status_str[] = {
 #define MF_TUP(X) #X
@@ -107,6 +112,8 @@ void mem_fetch::print(FILE *fp, bool print_inst) const {
 
 void mem_fetch::set_status(enum mem_fetch_status status,
                            unsigned long long cycle) {
+  if (g_chrome_trace && g_chrome_trace->sampled(m_request_uid))
+    g_chrome_trace->mf_status(this, m_status, m_status_change, cycle);
   m_status = status;
   m_status_change = cycle;
 }
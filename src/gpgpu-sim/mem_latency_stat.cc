@@ -37,6 +37,7 @@
 #include "mem_fetch.h"
 #include "shader.h"
 #include "stat-tool.h"
+#include "stats_registry.h"
 #include "visualizer.h"
 
 #include <algorithm>
@@ -287,6 +288,61 @@ std::vector<double> gen_stats(std::vector<unsigned> v) {
   return stats;
 }
 
+void memory_stats_t::register_stats(stats_registry &reg) const {
+  const unsigned n_mem = m_memory_config->m_n_mem;
+  const unsigned nbk = m_memory_config->nbk;
+
+  reg.add("mem.max_dq_latency", &max_dq_latency);
+  reg.add("mem.max_mf_latency", &max_mf_latency);
+  reg.add("mem.max_icnt2mem_latency", &max_icnt2mem_latency);
+  reg.add("mem.max_icnt2sh_latency", &max_icnt2sh_latency);
+  reg.add("mem.tot_icnt2mem_latency", &tot_icnt2mem_latency);
+  reg.add("mem.tot_icnt2sh_latency", &tot_icnt2sh_latency);
+  reg.add("mem.tot_mrq_num", &tot_mrq_num);
+  reg.add("mem.tot_non_pim_mrq_num", &tot_non_pim_mrq_num);
+  reg.add("mem.tot_pim_mrq_num", &tot_pim_mrq_num);
+  reg.add("mem.mf_total_lat", &mf_total_lat);
+  reg.add("mem.num_mfs", &num_mfs);
+  reg.add("mem.total_n_access", &total_n_access);
+  reg.add("mem.total_n_reads", &total_n_reads);
+  reg.add("mem.total_n_writes", &total_n_writes);
+  reg.add("mem.total_n_pim", &total_n_pim);
+  reg.add("mem.L2_read_miss", &L2_read_miss);
+  reg.add("mem.L2_write_miss", &L2_write_miss);
+  reg.add("mem.L2_read_hit", &L2_read_hit);
+  reg.add("mem.L2_write_hit", &L2_write_hit);
+
+  // log2 latency histograms
+  reg.add("mem.mrq_lat_table", mrq_lat_table, 32);
+  reg.add("mem.dq_lat_table", dq_lat_table, 32);
+  reg.add("mem.mf_lat_table", mf_lat_table, 32);
+  reg.add("mem.icnt2mem_lat_table", icnt2mem_lat_table, 24);
+  reg.add("mem.icnt2sh_lat_table", icnt2sh_lat_table, 24);
+
+  // [dram chip][bank]
+  reg.add_rows("mem.totalbankreads", totalbankreads, n_mem, nbk);
+  reg.add_rows("mem.totalbankwrites", totalbankwrites, n_mem, nbk);
+  reg.add_rows("mem.totalbankaccesses", totalbankaccesses, n_mem, nbk);
+  reg.add_rows("mem.mf_max_lat_table", mf_max_lat_table, n_mem, nbk);
+  reg.add_rows("mem.num_activates", num_activates, n_mem, nbk);
+  reg.add_rows("mem.row_access", row_access, n_mem, nbk);
+  reg.add_rows("mem.max_conc_access2samerow", max_conc_access2samerow, n_mem,
+               nbk);
+  reg.add_rows("mem.max_servicetime2samerow", max_servicetime2samerow, n_mem,
+               nbk);
+  for (unsigned i = 0; i < NUM_MEM_ACCESS_TYPE; i++)
+    reg.add_rows(std::string("mem.access_type.") +
+                     mem_access_type_str((enum mem_access_type)i),
+                 mem_access_type_stats[i], n_mem, nbk + 1);
+
+  reg.add("mem.L2_cbtoL2length", L2_cbtoL2length, n_mem);
+  reg.add("mem.L2_cbtoL2writelength", L2_cbtoL2writelength, n_mem);
+  reg.add("mem.L2_L2tocblength", L2_L2tocblength, n_mem);
+  reg.add("mem.L2_dramtoL2length", L2_dramtoL2length, n_mem);
+  reg.add("mem.L2_dramtoL2writelength", L2_dramtoL2writelength, n_mem);
+  reg.add("mem.L2_L2todramlength", L2_L2todramlength, n_mem);
+}
+
 void memory_stats_t::memlatstat_print(unsigned n_mem, unsigned gpu_mem_n_bk) {
   unsigned i, j, k, l, m;
   unsigned max_bank_accesses, min_bank_accesses, max_chip_accesses,
@@ -49,6 +49,7 @@ class memory_stats_t {
   void memlatstat_print(unsigned n_mem, unsigned gpu_mem_n_bk);
 
   void visualizer_print(gzFile visualizer_file);
+  void register_stats(class stats_registry &reg) const;
 
   // Reset local L2 stats that are aggregated each sampling window
   void clear_L2_stats_pw();
@@ -0,0 +1,144 @@
+#include "mem_timeseries.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define MEM_TS_TUP_BEGIN(X) static const char *mem_ts_column_str[] = {
+#define MEM_TS_TUP(X) #X
+#define MEM_TS_TUP_END(X) \
+  }                       \
+  ;
+#include "mem_timeseries.tup"
+#undef MEM_TS_TUP_BEGIN
+#undef MEM_TS_TUP
+#undef MEM_TS_TUP_END
+
+// header layout (native byte order):
+//   char     magic[8] = "GSIMTSER"
+//   uint32_t version, byte_order_mark (0x01020304), n_cols, block_rows
+//   uint64_t block_bytes
+//   char     column_name[n_cols][32]
+// block layout: uint64_t n_rows, uint64_t reserved, double col[n_cols][rows]
+static const char mem_ts_magic[8] = {'G', 'S', 'I', 'M', 'T', 'S', 'E', 'R'};
+static const size_t mem_ts_header_bytes = 4096;
+static const size_t mem_ts_block_bytes = 1 << 20;
+static const size_t mem_ts_block_hdr = 2 * sizeof(uint64_t);
+static const size_t mem_ts_name_len = 32;
+
+mem_timeseries::mem_timeseries(const char *filename, unsigned n_channels)
+    : m_filename(filename) {
+  m_block_bytes = mem_ts_block_bytes;
+  m_block_rows = (m_block_bytes - mem_ts_block_hdr) /
+                 (NUM_MEM_TS_COLUMNS * sizeof(double));
+  m_num_blocks = 0;
+  m_block = NULL;
+  m_block_nrows = NULL;
+  m_block_data = NULL;
+  m_last.resize(n_channels);
+  memset(&m_last[0], 0, n_channels * sizeof(dram_sample_counters));
+
+  m_fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (m_fd < 0) {
+    printf("GPGPU-Sim uArch: cannot open DRAM time series file %s\n",
+           filename);
+    return;
+  }
+
+  unsigned char header[mem_ts_header_bytes];
+  memset(header, 0, sizeof(header));
+  uint32_t desc[4] = {1, 0x01020304, NUM_MEM_TS_COLUMNS, m_block_rows};
+  uint64_t block_bytes = m_block_bytes;
+  memcpy(header, mem_ts_magic, sizeof(mem_ts_magic));
+  memcpy(header + 8, desc, sizeof(desc));
+  memcpy(header + 24, &block_bytes, sizeof(block_bytes));
+  assert(32 + NUM_MEM_TS_COLUMNS * mem_ts_name_len <= mem_ts_header_bytes);
+  for (unsigned c = 0; c < NUM_MEM_TS_COLUMNS; c++)
+    strncpy((char *)header + 32 + c * mem_ts_name_len, mem_ts_column_str[c],
+            mem_ts_name_len - 1);
+  if (write(m_fd, header, sizeof(header)) != (ssize_t)sizeof(header)) {
+    printf("GPGPU-Sim uArch: cannot write DRAM time series file %s\n",
+           filename);
+    close();
+  }
+}
+
+mem_timeseries::~mem_timeseries() { close(); }
+
+// Grow the file by one block and map it; the previous block stays in the file
+// and is written back by the kernel after munmap.
+bool mem_timeseries::map_next_block() {
+  if (m_block) munmap(m_block, m_block_bytes);
+  m_block = NULL;
+  const off_t offset =
+      mem_ts_header_bytes + (off_t)m_num_blocks * m_block_bytes;
+  if (ftruncate(m_fd, offset + m_block_bytes) != 0) return false;
+  void *p = mmap(NULL, m_block_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd,
+                 offset);
+  if (p == MAP_FAILED) return false;
+  m_block = (unsigned char *)p;
+  m_block_nrows = (unsigned long long *)m_block;
+  m_block_data = (double *)(m_block + mem_ts_block_hdr);
+  *m_block_nrows = 0;
+  m_num_blocks++;
+  return true;
+}
+
+void mem_timeseries::append_row(const double *row) {
+  if (m_block == NULL || *m_block_nrows == m_block_rows) {
+    if (!map_next_block()) {
+      printf("GPGPU-Sim uArch: DRAM time series file %s: cannot map block\n",
+             m_filename.c_str());
+      close();
+      return;
+    }
+  }
+  const unsigned r = *m_block_nrows;
+  for (unsigned c = 0; c < NUM_MEM_TS_COLUMNS; c++)
+    m_block_data[c * m_block_rows + r] = row[c];
+  *m_block_nrows = r + 1;
+}
+
+void mem_timeseries::sample(unsigned long long cycle, unsigned channel,
+                            const dram_sample_counters &c) {
+  if (!is_open()) return;
+  assert(channel < m_last.size());
+  dram_sample_counters &l = m_last[channel];
+
+  double row[NUM_MEM_TS_COLUMNS];
+  const unsigned long long cmds = c.n_cmd - l.n_cmd;
+  const unsigned long long accesses = c.access_num - l.access_num;
+  row[TS_CYCLE] = cycle;
+  row[TS_CHANNEL] = channel;
+  row[TS_MODE] = c.mode;
+  row[TS_BW_UTIL] = cmds ? (double)(c.bwutil - l.bwutil) / cmds : 0.0;
+  row[TS_ROW_HIT_RATE] =
+      accesses ? (double)(c.hits_num - l.hits_num) / accesses : 0.0;
+  row[TS_READS] = c.n_rd - l.n_rd;
+  row[TS_WRITES] = c.n_wr - l.n_wr;
+  row[TS_PIM] = c.n_pim - l.n_pim;
+  row[TS_MEM_QUEUE] = c.mem_pending;
+  row[TS_MEM_WRITE_QUEUE] = c.mem_write_pending;
+  row[TS_PIM_QUEUE] = c.pim_pending;
+  row[TS_PIM2MEM_SWITCHES] = c.pim2mem_switches - l.pim2mem_switches;
+  row[TS_MEM2PIM_SWITCHES] = c.mem2pim_switches - l.mem2pim_switches;
+  row[TS_ICNT_STALL_MEM_VC] = c.icnt_stall[0] - l.icnt_stall[0];
+  row[TS_ICNT_STALL_PIM_VC] = c.icnt_stall[1] - l.icnt_stall[1];
+  append_row(row);
+  l = c;
+}
+
+void mem_timeseries::close() {
+  if (m_block) {
+    munmap(m_block, m_block_bytes);
+    m_block = NULL;
+  }
+  if (m_fd >= 0) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
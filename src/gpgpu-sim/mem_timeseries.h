@@ -0,0 +1,74 @@
+#ifndef __MEM_TIMESERIES_H__
+#define __MEM_TIMESERIES_H__
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// Cumulative per-channel counters, read by gpgpu_sim at every sample point.
+// mem_timeseries turns consecutive readings into per-window values.
+struct dram_sample_counters {
+  unsigned long long n_cmd;
+  unsigned long long bwutil;
+  unsigned long long access_num;
+  unsigned long long hits_num;
+  unsigned long long n_rd;
+  unsigned long long n_wr;
+  unsigned long long n_pim;
+  unsigned long long pim2mem_switches;
+  unsigned long long mem2pim_switches;
+  unsigned long long icnt_stall[2];  // icnt -> L2 stalls per MEM_VC/PIM_VC
+  unsigned long long mem_queueing_delay;  // MEM pending in PIM mode
+  unsigned long long pim_queueing_delay;  // PIM pending in MEM mode
+  unsigned long long mem2pim_switch_latency;
+  unsigned long long mem2pim_switch_conflicts;
+  unsigned mode;                     // enum memory_mode
+  unsigned mem_pending;
+  unsigned mem_write_pending;
+  unsigned pim_pending;
+};
+
+#define MEM_TS_TUP_BEGIN(X) enum X {
+#define MEM_TS_TUP(X) X
+#define MEM_TS_TUP_END(X) \
+  }                       \
+  ;
+#include "mem_timeseries.tup"
+#undef MEM_TS_TUP_BEGIN
+#undef MEM_TS_TUP
+#undef MEM_TS_TUP_END
+
+// Windowed time series of DRAM/PIM metrics, one row per memory channel and
+// sample interval, written to an append-only memory-mapped file.
+//
+// The file is a 4 KB header (magic "GSIMTSER", column names) followed by
+// fixed-size blocks.  Each block stores up to block_rows rows column by
+// column (doubles) and starts with the number of valid rows, which is updated
+// after every row so the file can be read while the simulation is running.
+class mem_timeseries {
+ public:
+  mem_timeseries(const char *filename, unsigned n_channels);
+  ~mem_timeseries();
+
+  bool is_open() const { return m_fd >= 0; }
+  void sample(unsigned long long cycle, unsigned channel,
+              const dram_sample_counters &c);
+  void close();
+
+ private:
+  void append_row(const double *row);
+  bool map_next_block();
+
+  std::string m_filename;
+  int m_fd;
+  size_t m_block_bytes;
+  unsigned m_block_rows;
+  unsigned m_num_blocks;
+  unsigned char *m_block;  // currently mapped block
+  unsigned long long *m_block_nrows;
+  double *m_block_data;
+
+  std::vector<dram_sample_counters> m_last;
+};
+
+#endif
@@ -0,0 +1,124 @@
+#include "pim_broadcast.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gpu-sim.h"
+#include "mem_fetch.h"
+#include "stats_registry.h"
+
+pim_broadcast_hub::pim_broadcast_hub(const memory_config *config) {
+  m_config = config;
+  m_replicas.resize(config->m_n_mem);
+  m_acks.resize(config->m_n_mem);
+  n_broadcasts = 0;
+  n_replicas = 0;
+
+  // "all" or a comma separated list of channels
+  const char *opt = config->dram_pim_broadcast_channels;
+  if (strcmp(opt, "all") == 0) {
+    for (unsigned ch = 0; ch < config->m_n_mem; ch++) m_channels.push_back(ch);
+    return;
+  }
+  const char *s = opt;
+  while (*s) {
+    char *end;
+    unsigned long ch = strtoul(s, &end, 0);
+    if (end == s || ch >= config->m_n_mem) {
+      printf("GPGPU-Sim uArch: invalid -dram_pim_broadcast_channels \"%s\"\n",
+             opt);
+      abort();
+    }
+    m_channels.push_back(ch);
+    s = (*end == ',') ? end + 1 : end;
+  }
+}
+
+bool pim_broadcast_hub::is_broadcast(mem_fetch *mf) const {
+  return mf->is_pim() && mf->get_is_write() &&
+         ((mf->get_addr() >> m_config->dram_pim_broadcast_bit) & 1);
+}
+
+void pim_broadcast_hub::replicate(mem_fetch *mf, unsigned long long cycle) {
+  assert(m_outstanding.find(mf) == m_outstanding.end());
+  const unsigned home = mf->get_tlx_addr().chip;
+  const unsigned n_sub = m_config->m_n_sub_partition_per_memory_channel;
+  const unsigned local_spid = mf->get_sub_partition_id() % n_sub;
+
+  unsigned copies = 1;  // the original, serviced by the home channel
+  for (unsigned ch : m_channels) {
+    if (ch == home) continue;
+    const warp_inst_t &inst = mf->get_inst();
+    mem_fetch *replica = new mem_fetch(
+        mf->get_access(), inst.empty() ? NULL : &inst, mf->get_ctrl_size(),
+        mf->get_wid(), mf->get_sid(), mf->get_tpc(), m_config, cycle);
+    replica->set_chip(ch);
+    replica->set_parition(ch * n_sub + local_spid);
+    replica->set_status(IN_PARTITION_DRAM_LATENCY_QUEUE, cycle);
+
+    replica_t r;
+    r.mf = replica;
+    r.ready_cycle = cycle + m_config->dram_pim_broadcast_latency;
+    m_replicas[ch].push_back(r);
+    m_original[replica] = mf;
+    copies++;
+    n_replicas++;
+  }
+  m_outstanding[mf] = copies;
+  n_broadcasts++;
+}
+
+mem_fetch *pim_broadcast_hub::replica_top(unsigned channel,
+                                          unsigned long long cycle) const {
+  const std::deque<replica_t> &q = m_replicas[channel];
+  if (q.empty() || q.front().ready_cycle > cycle) return NULL;
+  return q.front().mf;
+}
+
+void pim_broadcast_hub::replica_pop(unsigned channel) {
+  m_replicas[channel].pop_front();
+}
+
+bool pim_broadcast_hub::dram_done(mem_fetch *mf) {
+  std::map<mem_fetch *, mem_fetch *>::iterator r = m_original.find(mf);
+  if (r != m_original.end()) {
+    mem_fetch *original = r->second;
+    m_original.erase(r);
+    delete mf;
+    retire(original);
+    return true;
+  }
+  if (m_outstanding.find(mf) != m_outstanding.end()) {
+    retire(mf);
+    return true;
+  }
+  return false;
+}
+
+void pim_broadcast_hub::retire(mem_fetch *original) {
+  std::map<mem_fetch *, unsigned>::iterator o = m_outstanding.find(original);
+  assert(o != m_outstanding.end() && o->second > 0);
+  if (--o->second == 0) {
+    m_outstanding.erase(o);
+    m_acks[original->get_tlx_addr().chip].push_back(original);
+  }
+}
+
+mem_fetch *pim_broadcast_hub::ack_top(unsigned channel) const {
+  if (m_acks[channel].empty()) return NULL;
+  return m_acks[channel].front();
+}
+
+void pim_broadcast_hub::ack_pop(unsigned channel) {
+  m_acks[channel].pop_front();
+}
+
+void pim_broadcast_hub::print(FILE *fp) const {
+  fprintf(fp, "PIM broadcast: n_broadcasts = %llu, n_replicas = %llu\n",
+          n_broadcasts, n_replicas);
+}
+
+void pim_broadcast_hub::register_stats(stats_registry &reg) const {
+  reg.add("pim_broadcast.n_broadcasts", &n_broadcasts);
+  reg.add("pim_broadcast.n_replicas", &n_replicas);
+}
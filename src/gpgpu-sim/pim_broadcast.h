@@ -0,0 +1,63 @@
+#ifndef __PIM_BROADCAST_H__
+#define __PIM_BROADCAST_H__
+
+#include <stdio.h>
+#include <deque>
+#include <map>
+#include <vector>
+
+class mem_fetch;
+class memory_config;
+
+// Memory-side replication of broadcast PIM writes.
+//
+// A PIM write whose address has bit -dram_pim_broadcast_bit set travels from
+// the SM to its home channel like any other PIM write.  When it leaves the
+// home L2->DRAM queue the hub hands one replica to every other channel of
+// -dram_pim_broadcast_channels, delivered -dram_pim_broadcast_latency cycles
+// later.  Replicas are retired by the hub when their DRAM channel finishes
+// them; the original's write ack is held back until the home channel and
+// all replicas are done, so the SM sees a single store and a single ack.
+class pim_broadcast_hub {
+ public:
+  pim_broadcast_hub(const memory_config *config);
+
+  bool is_broadcast(mem_fetch *mf) const;
+  void replicate(mem_fetch *mf, unsigned long long cycle);
+
+  // replicas waiting to enter the DRAM of channel
+  mem_fetch *replica_top(unsigned channel, unsigned long long cycle) const;
+  void replica_pop(unsigned channel);
+
+  // returns true when mf (a replica or a broadcast original) is owned by the
+  // hub and must not be returned to L2 by the caller
+  bool dram_done(mem_fetch *mf);
+
+  // broadcast originals whose replicas are all done, to be acked by channel
+  mem_fetch *ack_top(unsigned channel) const;
+  void ack_pop(unsigned channel);
+
+  bool busy() const { return !m_outstanding.empty(); }
+  void print(FILE *fp) const;
+  void register_stats(class stats_registry &reg) const;
+
+ private:
+  void retire(mem_fetch *original);
+
+  const memory_config *m_config;
+  std::vector<unsigned> m_channels;  // -dram_pim_broadcast_channels
+
+  struct replica_t {
+    mem_fetch *mf;
+    unsigned long long ready_cycle;
+  };
+  std::vector<std::deque<replica_t> > m_replicas;  // per target channel
+  std::vector<std::deque<mem_fetch *> > m_acks;    // per home channel
+  std::map<mem_fetch *, mem_fetch *> m_original;   // replica -> original
+  std::map<mem_fetch *, unsigned> m_outstanding;   // original -> copies left
+
+  unsigned long long n_broadcasts;
+  unsigned long long n_replicas;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "pim_unit.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void pim_unit_config::init(const char *opt) {
+  char unit = 'N';
+  int n = sscanf(opt, "%c:%u:%u,%u:%u,%u:%u,%u", &unit, &n_regs,
+                 &latency[PIM_OP_MAC], &interval[PIM_OP_MAC],
+                 &latency[PIM_OP_ADD], &interval[PIM_OP_ADD],
+                 &latency[PIM_OP_REDUCE], &interval[PIM_OP_REDUCE]);
+  enabled = (unit != 'N');
+  if (!enabled) return;
+  if ((unit != 'B' && unit != 'G') || n != 8 || n_regs == 0) {
+    printf("GPGPU-Sim uArch: invalid -dram_pim_unit \"%s\"\n", opt);
+    abort();
+  }
+  per_bankgrp = (unit == 'G');
+  for (unsigned i = 0; i < NUM_PIM_OP; i++) {
+    if (interval[i] == 0) interval[i] = 1;
+  }
+}
+
+pim_unit::pim_unit(const pim_unit_config *config) {
+  m_config = config;
+  m_next_issue = 0;
+  m_alloc_count = 0;
+}
+
+bool pim_unit::can_issue(enum pim_op_class op,
+                         unsigned long long cycle) const {
+  return cycle >= m_next_issue;
+}
+
+bool pim_unit::issue(enum pim_op_class op, unsigned row,
+                     unsigned long long cycle) {
+  assert(can_issue(op, cycle));
+  bool spilled = false;
+  unsigned long long done = cycle + m_config->latency[op];
+
+  std::map<unsigned, unsigned long long>::iterator r = m_regs.find(row);
+  if (r == m_regs.end()) {
+    if (m_regs.size() >= m_config->n_regs) {
+      // write the oldest accumulator back to its row
+      std::map<unsigned, unsigned long long>::iterator victim =
+          m_reg_age.begin();
+      for (std::map<unsigned, unsigned long long>::iterator a =
+               m_reg_age.begin();
+           a != m_reg_age.end(); ++a) {
+        if (a->second < victim->second) victim = a;
+      }
+      unsigned long long spill_done = m_regs[victim->first];
+      if (spill_done < cycle) spill_done = cycle;
+      spill_done += m_config->latency[op];
+      done = spill_done + m_config->latency[op];
+      m_spilled.insert(victim->first);
+      m_regs.erase(victim->first);
+      m_reg_age.erase(victim);
+      spilled = true;
+    }
+    m_reg_age[row] = m_alloc_count++;
+    m_regs[row] = done;
+  } else {
+    // dependent accumulate: wait for the previous op on this register
+    if (r->second > cycle) done = r->second + m_config->latency[op];
+    r->second = done;
+  }
+
+  m_next_issue = (spilled ? done - m_config->latency[op] : cycle) +
+                 m_config->interval[op];
+  return spilled;
+}
+
+bool pim_unit::result_ready(unsigned row, unsigned long long cycle) {
+  std::map<unsigned, unsigned long long>::iterator r = m_regs.find(row);
+  const bool in_reg = (r != m_regs.end());
+  if (in_reg && !m_spilled.count(row)) return r->second <= cycle;
+
+  std::map<unsigned, unsigned long long>::iterator rb = m_readback.find(row);
+  if (rb != m_readback.end()) return rb->second <= cycle;
+
+  // the partial sum in the row is added to the register (or to zero) once
+  // the register's last op is done and the ALU is free
+  if (in_reg && r->second > cycle) return false;
+  if (!can_issue(PIM_OP_ADD, cycle)) return false;
+  m_next_issue = cycle + m_config->interval[PIM_OP_ADD];
+  m_readback[row] = cycle + m_config->latency[PIM_OP_ADD];
+  return m_config->latency[PIM_OP_ADD] == 0;
+}
+
+void pim_unit::read_result(unsigned row) {
+  m_regs.erase(row);
+  m_reg_age.erase(row);
+  m_spilled.erase(row);
+  m_readback.erase(row);
+}
@@ -0,0 +1,66 @@
+#ifndef __PIM_UNIT_H__
+#define __PIM_UNIT_H__
+
+#include <map>
+#include <set>
+
+// Op class of a PIM write, taken from two address bits (-dram_pim_op_bit)
+enum pim_op_class { PIM_OP_MAC = 0, PIM_OP_ADD, PIM_OP_REDUCE, NUM_PIM_OP };
+
+// -dram_pim_unit <unit>:<regs>:<mac_lat>,<mac_ii>:<add_lat>,<add_ii>:
+//                <reduce_lat>,<reduce_ii>
+// unit is N (no compute unit model), B (one unit per bank) or G (one unit per
+// bank group)
+struct pim_unit_config {
+  pim_unit_config() {
+    enabled = false;
+    per_bankgrp = false;
+    n_regs = 0;
+    for (unsigned i = 0; i < NUM_PIM_OP; i++) latency[i] = interval[i] = 1;
+  }
+  void init(const char *opt);
+
+  bool enabled;
+  bool per_bankgrp;
+  unsigned n_regs;                // accumulator registers per unit
+  unsigned latency[NUM_PIM_OP];   // ALU pipeline depth (DRAM cycles)
+  unsigned interval[NUM_PIM_OP];  // initiation interval (DRAM cycles)
+};
+
+// In-bank PIM processing unit: a pipelined ALU feeding a small register file.
+//
+// Every PIM write executes one op whose result lands in the register that
+// accumulates the op's DRAM row; the register holds it until a PIM read of
+// that row (the result read) drains it.  When all registers are taken the
+// oldest one is spilled to its row, which blocks the ALU for one op latency.
+// A result that is not (only) in a register, because it was spilled or never
+// computed here, is read back from its row through the ALU as one add.
+class pim_unit {
+ public:
+  pim_unit(const pim_unit_config *config);
+
+  // the ALU can accept op this cycle
+  bool can_issue(enum pim_op_class op, unsigned long long cycle) const;
+  // returns true when a register had to be spilled
+  bool issue(enum pim_op_class op, unsigned row, unsigned long long cycle);
+
+  // the accumulated result of row is out of the ALU pipeline; starts the
+  // read-back of a row without a register, or with a spilled partial sum
+  bool result_ready(unsigned row, unsigned long long cycle);
+  void read_result(unsigned row);
+
+ private:
+  const pim_unit_config *m_config;
+  unsigned long long m_next_issue;
+  // row -> cycle the pending op on its register completes
+  std::map<unsigned, unsigned long long> m_regs;
+  // row -> allocation order, the lowest one is spilled first
+  std::map<unsigned, unsigned long long> m_reg_age;
+  unsigned long long m_alloc_count;
+  // rows holding a spilled partial sum
+  std::set<unsigned> m_spilled;
+  // row -> cycle its read-back completes
+  std::map<unsigned, unsigned long long> m_readback;
+};
+
+#endif
@@ -104,6 +104,9 @@ void mcpat_cycle(const gpgpu_sim_config &config,
     wrapper->set_mem_ctrl_power(power_stats->get_dram_rd(),
                                 power_stats->get_dram_wr(),
                                 power_stats->get_dram_pre());
+    wrapper->set_pim_power(power_stats->get_pim_act(),
+                           power_stats->get_pim_alu(),
+                           power_stats->get_pim_reg());
 
     // Execution pipeline accesses
     // FPU (SP) accesses, Integer ALU (not present in Tesla), Sfu accesses
@@ -72,6 +72,9 @@ void power_mem_stat_t::init() {
     n_rd[i] = (unsigned *)calloc(m_config->m_n_mem, sizeof(unsigned));
     n_wr[i] = (unsigned *)calloc(m_config->m_n_mem, sizeof(unsigned));
     n_req[i] = (unsigned *)calloc(m_config->m_n_mem, sizeof(unsigned));
+    n_pim_act[i] = (unsigned *)calloc(m_config->m_n_mem, sizeof(unsigned));
+    n_pim_alu[i] = (unsigned *)calloc(m_config->m_n_mem, sizeof(unsigned));
+    n_pim_reg[i] = (unsigned *)calloc(m_config->m_n_mem, sizeof(unsigned));
 
     // Interconnect stats
     n_mem_to_simt[i] = (long *)calloc(m_core_config->n_simt_clusters,
@@ -99,6 +102,9 @@ void power_mem_stat_t::save_stats() {
     n_rd[PREV_STAT_IDX][i] = n_rd[CURRENT_STAT_IDX][i];
     n_wr[PREV_STAT_IDX][i] = n_wr[CURRENT_STAT_IDX][i];
     n_req[PREV_STAT_IDX][i] = n_req[CURRENT_STAT_IDX][i];
+    n_pim_act[PREV_STAT_IDX][i] = n_pim_act[CURRENT_STAT_IDX][i];
+    n_pim_alu[PREV_STAT_IDX][i] = n_pim_alu[CURRENT_STAT_IDX][i];
+    n_pim_reg[PREV_STAT_IDX][i] = n_pim_reg[CURRENT_STAT_IDX][i];
   }
 
   for (unsigned i = 0; i < m_core_config->n_simt_clusters; i++) {
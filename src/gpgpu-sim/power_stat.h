@@ -107,6 +107,9 @@ struct mem_power_stats_pod {
   unsigned *n_rd[NUM_STAT_IDX];
   unsigned *n_wr[NUM_STAT_IDX];
   unsigned *n_req[NUM_STAT_IDX];
+  unsigned *n_pim_act[NUM_STAT_IDX];  // banks activated by PIM ACTs
+  unsigned *n_pim_alu[NUM_STAT_IDX];  // PIM ops, per bank
+  unsigned *n_pim_reg[NUM_STAT_IDX];  // PIM register accesses, per bank
 
   // Interconnect stats
   long *n_simt_to_mem[NUM_STAT_IDX];
@@ -750,6 +753,30 @@ class power_stat_t {
     }
     return total;
   }
+  unsigned get_pim_act() {
+    unsigned total = 0;
+    for (unsigned i = 0; i < m_mem_config->m_n_mem; ++i) {
+      total += (pwr_mem_stat->n_pim_act[CURRENT_STAT_IDX][i] -
+                pwr_mem_stat->n_pim_act[PREV_STAT_IDX][i]);
+    }
+    return total;
+  }
+  unsigned get_pim_alu() {
+    unsigned total = 0;
+    for (unsigned i = 0; i < m_mem_config->m_n_mem; ++i) {
+      total += (pwr_mem_stat->n_pim_alu[CURRENT_STAT_IDX][i] -
+                pwr_mem_stat->n_pim_alu[PREV_STAT_IDX][i]);
+    }
+    return total;
+  }
+  unsigned get_pim_reg() {
+    unsigned total = 0;
+    for (unsigned i = 0; i < m_mem_config->m_n_mem; ++i) {
+      total += (pwr_mem_stat->n_pim_reg[CURRENT_STAT_IDX][i] -
+                pwr_mem_stat->n_pim_reg[PREV_STAT_IDX][i]);
+    }
+    return total;
+  }
 
   long get_icnt_simt_to_mem() {
     long total = 0;
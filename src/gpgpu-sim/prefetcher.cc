@@ -0,0 +1,308 @@
+#include "prefetcher.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mem_fetch.h"
+
+// candidates waiting for an idle cache cycle; older ones are dropped
+#define PREFETCH_QUEUE_SIZE 32
+// stride confidence (saturating, 2 bits) needed to prefetch
+#define STRIDE_CONFIDENT 2
+// a demand miss this many blocks from a tracker's last block extends it
+#define STREAM_WINDOW 4
+#define STREAM_CONFIDENT 2
+// throttle thresholds, in percent of resolved prefetches / demand misses
+#define THROTTLE_ACCURACY_HIGH 75
+#define THROTTLE_ACCURACY_LOW 40
+#define THROTTLE_POLLUTION_HIGH 25
+
+void prefetch_config::init(const char *config) {
+  policy = PREFETCH_NONE;
+  if (config == NULL || strcmp(config, "none") == 0) return;
+
+  char p;
+  int ntok = sscanf(config, "%c:%u:%u:%u:%u", &p, &table_entries, &degree,
+                    &distance, &throttle_interval);
+  if (ntok != 5 || table_entries == 0 || degree == 0 || distance == 0) {
+    printf("GPGPU-Sim uArch: prefetcher configuration parsing error (%s)\n",
+           config);
+    abort();
+  }
+  switch (p) {
+    case 'S':
+      policy = PREFETCH_STRIDE;
+      break;
+    case 'L':
+      policy = PREFETCH_STREAM;
+      break;
+    case 'B':
+      policy = PREFETCH_BOTH;
+      break;
+    default:
+      printf("GPGPU-Sim uArch: unknown prefetch policy '%c' (%s)\n", p,
+             config);
+      abort();
+  }
+}
+
+prefetch_engine::prefetch_engine(const prefetch_config &config,
+                                 unsigned block_size, unsigned line_size,
+                                 enum mem_access_type type)
+    : m_config(config) {
+  m_block_size = block_size;
+  m_line_size = line_size;
+  m_type = type;
+  m_degree = config.degree;
+
+  stride_entry_t s;
+  s.pc = 0;
+  s.last_addr = 0;
+  s.stride = 0;
+  s.confidence = 0;
+  s.valid = false;
+  m_stride_table.assign(config.table_entries, s);
+
+  stream_entry_t t;
+  t.last_block = 0;
+  t.direction = 0;
+  t.confidence = 0;
+  t.lru = 0;
+  t.valid = false;
+  m_streams.assign(config.table_entries, t);
+  m_stream_clock = 0;
+
+  m_outstanding = 0;
+  m_epoch_useful = 0;
+  m_epoch_useless = 0;
+  m_epoch_pollution = 0;
+  m_epoch_misses = 0;
+
+  n_candidates = 0;
+  n_issued = 0;
+  n_redundant = 0;
+  n_useful = 0;
+  n_late = 0;
+  n_useless = 0;
+  n_pollution = 0;
+  n_demand_misses = 0;
+  n_degree_up = 0;
+  n_degree_down = 0;
+}
+
+bool prefetch_engine::is_prefetch(const mem_fetch *mf) const {
+  return mf->get_access_type() == m_type;
+}
+
+void prefetch_engine::demand(address_type pc, new_addr_type addr,
+                             new_addr_type block, bool hit, bool miss,
+                             unsigned home) {
+  bool first_use = false;
+  if (hit) {
+    tr1_hash_map<new_addr_type, unsigned>::iterator u = m_unused.find(block);
+    if (u != m_unused.end()) {
+      m_unused.erase(u);
+      first_use = true;
+      resolved(true);
+    }
+  } else if (miss) {
+    n_demand_misses++;
+    m_epoch_misses++;
+    tr1_hash_map<new_addr_type, unsigned>::iterator v = m_victims.find(block);
+    if (v != m_victims.end()) {
+      m_victims.erase(v);
+      n_pollution++;
+      m_epoch_pollution++;
+    }
+  }
+
+  bool stride_hit = false;
+  if (m_config.policy == PREFETCH_STRIDE || m_config.policy == PREFETCH_BOTH)
+    stride_hit = train_stride(pc, addr, home);
+  // streams follow the miss stream and the first use of their prefetches
+  if (!stride_hit && (!hit || first_use) &&
+      (m_config.policy == PREFETCH_STREAM || m_config.policy == PREFETCH_BOTH))
+    train_stream(block, home);
+}
+
+bool prefetch_engine::train_stride(address_type pc, new_addr_type addr,
+                                   unsigned home) {
+  if (pc == (address_type)-1) return false;
+  stride_entry_t &e = m_stride_table[pc % m_stride_table.size()];
+  if (!e.valid || e.pc != pc) {
+    e.valid = true;
+    e.pc = pc;
+    e.last_addr = addr;
+    e.stride = 0;
+    e.confidence = 0;
+    return false;
+  }
+
+  const long long delta = (long long)(addr - e.last_addr);
+  if (delta == 0) return false;  // another warp or thread of the same access
+  if (delta == e.stride) {
+    if (e.confidence < 3) e.confidence++;
+  } else {
+    if (e.confidence > 0) e.confidence--;
+    if (e.confidence == 0) e.stride = delta;
+  }
+  e.last_addr = addr;
+  if (e.confidence < STRIDE_CONFIDENT) return false;
+
+  new_addr_type last = (new_addr_type)-1;
+  for (unsigned i = 0; i < m_degree; i++) {
+    new_addr_type target =
+        addr + e.stride * (long long)(m_config.distance + i);
+    new_addr_type block = target & ~(new_addr_type)(m_block_size - 1);
+    if (block != last) enqueue(block, home);
+    last = block;
+  }
+  return true;
+}
+
+void prefetch_engine::train_stream(new_addr_type block, unsigned home) {
+  m_stream_clock++;
+  stream_entry_t *victim = &m_streams[0];
+  for (unsigned i = 0; i < m_streams.size(); i++) {
+    stream_entry_t &s = m_streams[i];
+    if (!s.valid || s.lru < victim->lru) victim = &s;
+    if (!s.valid) continue;
+
+    const long long delta =
+        ((long long)block - (long long)s.last_block) / (long long)m_block_size;
+    if (delta == 0 || delta > STREAM_WINDOW || delta < -STREAM_WINDOW)
+      continue;
+    const int dir = (delta > 0) ? 1 : -1;
+    if (s.direction == dir) {
+      if (s.confidence < 3) s.confidence++;
+    } else {
+      s.direction = dir;
+      s.confidence = 1;
+    }
+    s.last_block = block;
+    s.lru = m_stream_clock;
+    if (s.confidence >= STREAM_CONFIDENT) {
+      for (unsigned d = 0; d < m_degree; d++) {
+        long long ahead = (long long)(m_config.distance + d) * dir;
+        enqueue(block + ahead * (long long)m_block_size, home);
+      }
+    }
+    return;
+  }
+
+  victim->valid = true;
+  victim->last_block = block;
+  victim->direction = 0;
+  victim->confidence = 0;
+  victim->lru = m_stream_clock;
+}
+
+void prefetch_engine::enqueue(new_addr_type block, unsigned home) {
+  for (std::deque<candidate_t>::const_iterator c = m_candidates.begin();
+       c != m_candidates.end(); ++c)
+    if (c->block == block) return;
+  if (m_unused.find(block) != m_unused.end()) return;
+  if (m_candidates.size() >= PREFETCH_QUEUE_SIZE) m_candidates.pop_front();
+  candidate_t c;
+  c.block = block;
+  c.home = home;
+  m_candidates.push_back(c);
+  n_candidates++;
+}
+
+bool prefetch_engine::may_issue(unsigned mshr_entries) const {
+  // leave at least three quarters of the MSHRs to demand misses
+  unsigned limit = mshr_entries / 4;
+  if (limit == 0) limit = 1;
+  return m_outstanding < limit;
+}
+
+void prefetch_engine::issued() {
+  m_outstanding++;
+  n_issued++;
+}
+
+void prefetch_engine::filled(new_addr_type block, unsigned merged_demands) {
+  assert(m_outstanding > 0);
+  m_outstanding--;
+  if (merged_demands > 0) {
+    // a demand was already waiting on it
+    n_late++;
+    resolved(true);
+  } else {
+    m_unused[block] = 1;
+  }
+}
+
+void prefetch_engine::evicted(new_addr_type line_addr, bool by_prefetch) {
+  for (new_addr_type b = line_addr; b < line_addr + m_line_size;
+       b += m_block_size) {
+    tr1_hash_map<new_addr_type, unsigned>::iterator u = m_unused.find(b);
+    if (u != m_unused.end()) {
+      m_unused.erase(u);
+      resolved(false);
+    }
+    if (by_prefetch && m_victims.find(b) == m_victims.end()) {
+      m_victims[b] = 1;
+      m_victim_order.push_back(b);
+    }
+  }
+  // remember four victims per table entry
+  const unsigned max_victims = 4 * m_config.table_entries;
+  while (m_victim_order.size() > max_victims) {
+    m_victims.erase(m_victim_order.front());
+    m_victim_order.pop_front();
+  }
+}
+
+void prefetch_engine::resolved(bool useful) {
+  if (useful) {
+    n_useful++;
+    m_epoch_useful++;
+  } else {
+    n_useless++;
+    m_epoch_useless++;
+  }
+
+  const unsigned total = m_epoch_useful + m_epoch_useless;
+  if (m_config.throttle_interval == 0 || total < m_config.throttle_interval)
+    return;
+  const unsigned accuracy = 100 * m_epoch_useful / total;
+  const unsigned pollution =
+      m_epoch_misses ? 100 * m_epoch_pollution / m_epoch_misses : 0;
+  if (accuracy >= THROTTLE_ACCURACY_HIGH &&
+      pollution < THROTTLE_POLLUTION_HIGH) {
+    if (m_degree < m_config.degree) {
+      m_degree++;
+      n_degree_up++;
+    }
+  } else if (accuracy < THROTTLE_ACCURACY_LOW ||
+             pollution >= THROTTLE_POLLUTION_HIGH) {
+    if (m_degree > 1) {
+      m_degree--;
+      n_degree_down++;
+    }
+  }
+  m_epoch_useful = 0;
+  m_epoch_useless = 0;
+  m_epoch_pollution = 0;
+  m_epoch_misses = 0;
+}
+
+void prefetch_engine::print(FILE *fp) const {
+  const double accuracy = n_issued ? (double)n_useful / n_issued : 0.0;
+  const double coverage =
+      (n_useful + n_demand_misses)
+          ? (double)n_useful / (n_useful + n_demand_misses)
+          : 0.0;
+  const double lateness = n_useful ? (double)n_late / n_useful : 0.0;
+  fprintf(fp,
+          "\t\tPrefetch: candidates = %llu, issued = %llu, redundant = %llu, "
+          "useful = %llu, late = %llu, useless = %llu, pollution = %llu\n",
+          n_candidates, n_issued, n_redundant, n_useful, n_late, n_useless,
+          n_pollution);
+  fprintf(fp,
+          "\t\tPrefetch: accuracy = %.3g, coverage = %.3g, lateness = %.3g, "
+          "degree = %u (up %llu, down %llu)\n",
+          accuracy, coverage, lateness, m_degree, n_degree_up, n_degree_down);
+}
@@ -0,0 +1,138 @@
+#ifndef __PREFETCHER_H__
+#define __PREFETCHER_H__
+
+#include <stdio.h>
+#include <deque>
+#include <vector>
+#include "../abstract_hardware_model.h"
+#include "../tr1_hash_map.h"
+
+class mem_fetch;
+
+enum prefetch_policy_t {
+  PREFETCH_NONE = 0,
+  PREFETCH_STRIDE,  // 'S': per-PC stride table
+  PREFETCH_STREAM,  // 'L': next-N-block stream detector
+  PREFETCH_BOTH     // 'B': stride first, stream when no stride is confident
+};
+
+// -gpgpu_l1d_prefetcher / -gpgpu_l2_prefetcher
+// none | <policy>:<table>:<degree>:<distance>:<throttle interval>
+struct prefetch_config {
+  prefetch_config() {
+    policy = PREFETCH_NONE;
+    table_entries = 0;
+    degree = 0;
+    distance = 0;
+    throttle_interval = 0;
+  }
+  void init(const char *config);
+  bool enabled() const { return policy != PREFETCH_NONE; }
+
+  enum prefetch_policy_t policy;
+  unsigned table_entries;      // stride table entries / stream trackers
+  unsigned degree;             // maximum prefetches per trigger
+  unsigned distance;           // first prefetch, in strides or blocks ahead
+  unsigned throttle_interval;  // resolved prefetches per feedback epoch,
+                               // 0 = fixed degree
+};
+
+// Prefetch engine of one data cache.
+//
+// The cache trains the engine on every accepted demand read and asks it for
+// one candidate block per cycle; blocks are the cache's MSHR granularity
+// (sectors of a sector cache).  The engine follows each prefetch it issued:
+// filled and then hit by a demand (useful), hit by a demand while still in
+// the MSHR (useful and late), or evicted untouched (useless).  Blocks evicted
+// by a prefetch fill are remembered for a while so a demand miss on them
+// counts as pollution.  With a throttle interval the degree is adjusted
+// after every interval resolved prefetches: raised while accuracy is high
+// and pollution low, lowered otherwise.
+class prefetch_engine {
+ public:
+  prefetch_engine(const prefetch_config &config, unsigned block_size,
+                  unsigned line_size, enum mem_access_type type);
+
+  bool is_prefetch(const mem_fetch *mf) const;
+
+  // training: demand read of block, hit or missed in the tag array (neither
+  // when it hit a reserved line); home is carried to the candidates (the L2
+  // only prefetches for its own bank)
+  void demand(address_type pc, new_addr_type addr, new_addr_type block,
+              bool hit, bool miss, unsigned home);
+
+  struct candidate_t {
+    new_addr_type block;
+    unsigned home;
+  };
+  bool empty() const { return m_candidates.empty(); }
+  const candidate_t &front() const { return m_candidates.front(); }
+  void pop_front() { m_candidates.pop_front(); }
+  // outstanding prefetches the MSHRs may hold
+  bool may_issue(unsigned mshr_entries) const;
+
+  // lifecycle of an issued prefetch
+  void issued();
+  void redundant() { n_redundant++; }
+  void filled(new_addr_type block, unsigned merged_demands);
+  // a line replaced in the tag array, by_prefetch if a prefetch allocated it
+  void evicted(new_addr_type line_addr, bool by_prefetch);
+
+  void print(FILE *fp) const;
+
+ private:
+  void enqueue(new_addr_type block, unsigned home);
+  bool train_stride(address_type pc, new_addr_type addr, unsigned home);
+  void train_stream(new_addr_type block, unsigned home);
+  void resolved(bool useful);
+
+  const prefetch_config &m_config;
+  unsigned m_block_size;
+  unsigned m_line_size;
+  enum mem_access_type m_type;
+  unsigned m_degree;  // current degree, <= m_config.degree
+
+  struct stride_entry_t {
+    address_type pc;
+    new_addr_type last_addr;
+    long long stride;
+    unsigned confidence;
+    bool valid;
+  };
+  std::vector<stride_entry_t> m_stride_table;
+
+  struct stream_entry_t {
+    new_addr_type last_block;
+    int direction;  // +1 / -1, 0 until the second miss
+    unsigned confidence;
+    unsigned long long lru;
+    bool valid;
+  };
+  std::vector<stream_entry_t> m_streams;
+  unsigned long long m_stream_clock;
+
+  std::deque<candidate_t> m_candidates;
+  unsigned m_outstanding;
+  tr1_hash_map<new_addr_type, unsigned> m_unused;  // filled, not yet hit
+  tr1_hash_map<new_addr_type, unsigned> m_victims;  // evicted by prefetches
+  std::deque<new_addr_type> m_victim_order;
+
+  // feedback epoch
+  unsigned m_epoch_useful;
+  unsigned m_epoch_useless;
+  unsigned m_epoch_pollution;
+  unsigned m_epoch_misses;
+
+  unsigned long long n_candidates;
+  unsigned long long n_issued;
+  unsigned long long n_redundant;
+  unsigned long long n_useful;
+  unsigned long long n_late;
+  unsigned long long n_useless;
+  unsigned long long n_pollution;
+  unsigned long long n_demand_misses;
+  unsigned long long n_degree_up;
+  unsigned long long n_degree_down;
+};
+
+#endif
@@ -0,0 +1,219 @@
+#include "replacement_policy.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "gpu-cache.h"
+
+#define RRPV_MAX 3  // 2-bit re-reference prediction values
+// BRRIP inserts at long instead of distant once every this many insertions
+#define BRRIP_LONG_INTERVAL 32
+#define PSEL_MAX 1023  // 10-bit policy selector
+#define DUEL_LEADER_SETS 32
+
+static unsigned next_pow2(unsigned n) {
+  unsigned p = 1;
+  while (p < n) p <<= 1;
+  return p;
+}
+
+replacement_policy *replacement_policy::create(const cache_config &config) {
+  switch (config.get_replacement_policy()) {
+    case LRU:
+      return new lru_policy(config);
+    case FIFO:
+      return new fifo_policy(config);
+    case PLRU:
+      return new plru_policy(config);
+    case SRRIP:
+    case BRRIP:
+    case DRRIP:
+    case STREAM_BYPASS:
+      return new rrip_policy(config);
+    default:
+      printf("GPGPU-Sim uArch: unknown cache replacement policy %d\n",
+             config.get_replacement_policy());
+      abort();
+  }
+  return NULL;
+}
+
+unsigned replacement_policy::assoc() const { return m_config.get_assoc(); }
+
+unsigned lru_policy::victim(unsigned set, cache_block_t **lines) const {
+  const unsigned a = assoc();
+  unsigned victim = (unsigned)-1;
+  unsigned long long oldest = 0;
+  for (unsigned way = 0; way < a; way++) {
+    cache_block_t *line = lines[set * a + way];
+    if (line->is_reserved_line() || line->is_invalid_line()) continue;
+    if (victim == (unsigned)-1 || line->get_last_access_time() < oldest) {
+      oldest = line->get_last_access_time();
+      victim = set * a + way;
+    }
+  }
+  assert(victim != (unsigned)-1);
+  return victim;
+}
+
+unsigned fifo_policy::victim(unsigned set, cache_block_t **lines) const {
+  const unsigned a = assoc();
+  unsigned victim = (unsigned)-1;
+  unsigned long long oldest = 0;
+  for (unsigned way = 0; way < a; way++) {
+    cache_block_t *line = lines[set * a + way];
+    if (line->is_reserved_line() || line->is_invalid_line()) continue;
+    if (victim == (unsigned)-1 || line->get_alloc_time() < oldest) {
+      oldest = line->get_alloc_time();
+      victim = set * a + way;
+    }
+  }
+  assert(victim != (unsigned)-1);
+  return victim;
+}
+
+plru_policy::plru_policy(const cache_config &config)
+    : replacement_policy(config) {
+  // the L1 may grow its associativity up to the maximum between kernels
+  m_set_stride = next_pow2(config.get_max_assoc());
+  m_tree.assign(config.get_nset() * m_set_stride, false);
+}
+
+unsigned plru_policy::victim(unsigned set, cache_block_t **lines) const {
+  const unsigned a = assoc();
+  const unsigned base = set * m_set_stride;
+  unsigned size = next_pow2(a);
+  unsigned node = 1;
+  unsigned lo = 0;
+  // a set bit points at the right half; ways past assoc are never chosen
+  while (size > 1) {
+    const unsigned half = size / 2;
+    if (m_tree[base + node] && lo + half < a) {
+      lo += half;
+      node = 2 * node + 1;
+    } else {
+      node = 2 * node;
+    }
+    size = half;
+  }
+
+  // the tree may point at a line waiting for its fill
+  for (unsigned i = 0; i < a; i++) {
+    const unsigned idx = set * a + (lo + i) % a;
+    if (!lines[idx]->is_reserved_line()) return idx;
+  }
+  assert(0);
+  return (unsigned)-1;
+}
+
+void plru_policy::touch(unsigned idx, bool streaming) {
+  const unsigned a = assoc();
+  const unsigned base = (idx / a) * m_set_stride;
+  const unsigned way = idx % a;
+  unsigned size = next_pow2(a);
+  unsigned node = 1;
+  unsigned lo = 0;
+  // point every node on the way's path at the other half
+  while (size > 1) {
+    const unsigned half = size / 2;
+    if (way < lo + half) {
+      m_tree[base + node] = true;
+      node = 2 * node;
+    } else {
+      m_tree[base + node] = false;
+      lo += half;
+      node = 2 * node + 1;
+    }
+    size = half;
+  }
+}
+
+rrip_policy::rrip_policy(const cache_config &config)
+    : replacement_policy(config) {
+  m_rrpv.assign(config.get_max_num_lines(), RRPV_MAX);
+  m_brrip_count = 0;
+  m_psel = PSEL_MAX / 2;
+  m_leader_stride = 0;
+  if (config.get_replacement_policy() == DRRIP) {
+    // one SRRIP and one BRRIP leader in every group of stride sets; caches
+    // with fewer than 4 sets have no followers and run SRRIP
+    const unsigned n_leaders =
+        std::min((unsigned)DUEL_LEADER_SETS, config.get_nset() / 4);
+    if (n_leaders) m_leader_stride = config.get_nset() / n_leaders;
+  }
+}
+
+rrip_policy::leader_t rrip_policy::leader(unsigned set) const {
+  if (m_leader_stride == 0) return SRRIP_LEADER;
+  switch (set % m_leader_stride) {
+    case 0:
+      return SRRIP_LEADER;
+    case 1:
+      return BRRIP_LEADER;
+    default:
+      return FOLLOWER;
+  }
+}
+
+bool rrip_policy::brrip_insert() {
+  return (m_brrip_count++ % BRRIP_LONG_INTERVAL) != 0;
+}
+
+unsigned rrip_policy::victim(unsigned set, cache_block_t **lines) const {
+  const unsigned a = assoc();
+  unsigned victim = (unsigned)-1;
+  for (unsigned way = 0; way < a; way++) {
+    const unsigned idx = set * a + way;
+    if (lines[idx]->is_reserved_line()) continue;
+    if (victim == (unsigned)-1 || m_rrpv[idx] > m_rrpv[victim]) {
+      victim = idx;
+      if (m_rrpv[idx] == RRPV_MAX) break;
+    }
+  }
+  assert(victim != (unsigned)-1);
+  return victim;
+}
+
+void rrip_policy::touch(unsigned idx, bool streaming) {
+  if (streaming && m_config.get_replacement_policy() == STREAM_BYPASS) return;
+  m_rrpv[idx] = 0;
+}
+
+void rrip_policy::insert(unsigned idx, bool replaced_valid, bool streaming) {
+  const unsigned a = assoc();
+  const unsigned set = idx / a;
+  if (replaced_valid && m_rrpv[idx] < RRPV_MAX) {
+    // age the set until the victim would have reached distant
+    const unsigned char age = RRPV_MAX - m_rrpv[idx];
+    for (unsigned i = set * a; i < (set + 1) * a; i++)
+      m_rrpv[i] = std::min(m_rrpv[i] + age, RRPV_MAX);
+  }
+
+  bool distant = false;
+  switch (m_config.get_replacement_policy()) {
+    case BRRIP:
+      distant = brrip_insert();
+      break;
+    case DRRIP:
+      switch (leader(set)) {
+        case SRRIP_LEADER:
+          if (m_leader_stride && m_psel < PSEL_MAX) m_psel++;
+          break;
+        case BRRIP_LEADER:
+          if (m_psel > 0) m_psel--;
+          distant = brrip_insert();
+          break;
+        case FOLLOWER:
+          if (m_psel > PSEL_MAX / 2) distant = brrip_insert();
+          break;
+      }
+      break;
+    case STREAM_BYPASS:
+      distant = streaming;
+      break;
+    default:
+      break;
+  }
+  m_rrpv[idx] = distant ? RRPV_MAX : RRPV_MAX - 1;
+}
@@ -0,0 +1,96 @@
+#ifndef __REPLACEMENT_POLICY_H__
+#define __REPLACEMENT_POLICY_H__
+
+#include <vector>
+
+struct cache_block_t;
+class cache_config;
+
+// Victim selection and per-set metadata of a tag_array.
+//
+// The tag array itself finds hits and invalid lines; the policy is only asked
+// for a victim when every way of the set holds a line, and it is told about
+// every hit and every allocation.  Lines are addressed by their index in the
+// tag array (set * assoc + way).  Reserved lines (waiting for their fill) are
+// never returned as victims.
+class replacement_policy {
+ public:
+  // policy selected by the <rep> field of the cache config string
+  static replacement_policy *create(const cache_config &config);
+  virtual ~replacement_policy() {}
+
+  // line to replace in set; lines is the tag array, at least one line of the
+  // set is valid and not reserved
+  virtual unsigned victim(unsigned set, cache_block_t **lines) const = 0;
+  // line idx was hit (or had a sector allocated)
+  virtual void touch(unsigned idx, bool streaming) {}
+  // line idx was allocated, replaced_valid if it evicted a valid line
+  virtual void insert(unsigned idx, bool replaced_valid, bool streaming) {}
+
+ protected:
+  replacement_policy(const cache_config &config) : m_config(config) {}
+  unsigned assoc() const;
+
+  const cache_config &m_config;
+};
+
+// 'L': least recently used, from the lines' access timestamps
+class lru_policy : public replacement_policy {
+ public:
+  lru_policy(const cache_config &config) : replacement_policy(config) {}
+  virtual unsigned victim(unsigned set, cache_block_t **lines) const;
+};
+
+// 'F': first in first out, from the lines' allocation timestamps
+class fifo_policy : public replacement_policy {
+ public:
+  fifo_policy(const cache_config &config) : replacement_policy(config) {}
+  virtual unsigned victim(unsigned set, cache_block_t **lines) const;
+};
+
+// 'P': tree pseudo-LRU, one bit per inner node of a binary tree over the
+// ways (assoc - 1 bits per set, rounded up to a power of two ways)
+class plru_policy : public replacement_policy {
+ public:
+  plru_policy(const cache_config &config);
+  virtual unsigned victim(unsigned set, cache_block_t **lines) const;
+  virtual void touch(unsigned idx, bool streaming);
+  virtual void insert(unsigned idx, bool replaced_valid, bool streaming) {
+    touch(idx, streaming);
+  }
+
+ private:
+  unsigned m_set_stride;     // bits reserved per set
+  std::vector<bool> m_tree;  // node n of set s at s * m_set_stride + n
+};
+
+// 'S' / 'B' / 'D' / 'Y': re-reference interval prediction (Jaleel et al.,
+// ISCA 2010) with 2-bit RRPVs.  A hit predicts near re-reference (0), the
+// victim is the first line with the largest RRPV and the set is aged as if
+// it had been incremented until that line reached distant (3).
+//   SRRIP inserts at long (2).
+//   BRRIP inserts at distant, and at long once every 32 insertions.
+//   DRRIP duels SRRIP and BRRIP leader sets and follows the one missing
+//   less through a 10-bit PSEL counter.
+//   Streaming bypass is SRRIP, but streaming (.cs) and last-use (.lu)
+//   accesses insert at distant and are not promoted on a hit, so they
+//   replace each other instead of the set's reused lines.
+class rrip_policy : public replacement_policy {
+ public:
+  rrip_policy(const cache_config &config);
+  virtual unsigned victim(unsigned set, cache_block_t **lines) const;
+  virtual void touch(unsigned idx, bool streaming);
+  virtual void insert(unsigned idx, bool replaced_valid, bool streaming);
+
+ private:
+  enum leader_t { FOLLOWER, SRRIP_LEADER, BRRIP_LEADER };
+  leader_t leader(unsigned set) const;
+  bool brrip_insert();
+
+  std::vector<unsigned char> m_rrpv;  // one per line
+  unsigned m_brrip_count;
+  unsigned m_psel;
+  unsigned m_leader_stride;  // 0: no set dueling
+};
+
+#endif
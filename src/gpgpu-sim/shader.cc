@@ -44,7 +44,9 @@
 #include "mem_fetch.h"
 #include "mem_latency_stat.h"
 #include "shader_trace.h"
+#include "sim_prof.h"
 #include "stat-tool.h"
+#include "stats_registry.h"
 #include "traffic_breakdown.h"
 #include "visualizer.h"
 
@@ -130,7 +132,7 @@ void shader_core_ctx::create_front_pipeline() {
                                          m_config->n_thread_per_shader);
 
   m_not_completed = 0;
-  m_active_threads.reset();
+  m_active_threads.resize(m_config->n_thread_per_shader);
   m_n_active_cta = 0;
   for (unsigned i = 0; i < MAX_CTA_PER_SHADER; i++) m_cta_status[i] = 0;
   for (unsigned i = 0; i < m_config->n_thread_per_shader; i++) {
@@ -159,72 +161,62 @@ void shader_core_ctx::create_front_pipeline() {
                               IN_L1I_MISS_QUEUE);
 }
 
+// Built-in policies, in the order they are matched against -gpgpu_scheduler.
+std::vector<scheduler_policy_t> &shader_core_ctx::scheduler_policies() {
+  static std::vector<scheduler_policy_t> policies;
+  if (policies.empty()) {
+    const scheduler_policy_t builtin[] = {
+        {"lrr", new_scheduler<lrr_scheduler>},
+        {"two_level_active",
+         new_configured_scheduler<two_level_active_scheduler>},
+        {"gto", new_scheduler<gto_scheduler>},
+        {"old", new_scheduler<oldest_scheduler>},
+        {"warp_limiting", new_configured_scheduler<swl_scheduler>},
+        {"ccws", new_configured_scheduler<ccws_scheduler>},
+        {"criticality", new_scheduler<criticality_scheduler>},
+        {"pim_balance", new_configured_scheduler<pim_balance_scheduler>},
+    };
+    policies.assign(builtin, builtin + sizeof(builtin) / sizeof(builtin[0]));
+  }
+  return policies;
+}
+
+void shader_core_ctx::register_scheduler_policy(const char *name,
+                                                scheduler_factory_t create) {
+  scheduler_policy_t policy = {name, create};
+  scheduler_policies().push_back(policy);
+}
+
 void shader_core_ctx::create_schedulers() {
   m_scoreboard = new Scoreboard(m_sid, m_config->max_warps_per_shader, m_gpu);
 
   // scedulers
   // must currently occur after all inputs have been initialized.
   std::string sched_config = m_config->gpgpu_scheduler_string;
-  const concrete_scheduler scheduler =
-      sched_config.find("lrr") != std::string::npos
-          ? CONCRETE_SCHEDULER_LRR
-          : sched_config.find("two_level_active") != std::string::npos
-                ? CONCRETE_SCHEDULER_TWO_LEVEL_ACTIVE
-                : sched_config.find("gto") != std::string::npos
-                      ? CONCRETE_SCHEDULER_GTO
-                      : sched_config.find("old") != std::string::npos
-                            ? CONCRETE_SCHEDULER_OLDEST_FIRST
-                            : sched_config.find("warp_limiting") !=
-                                      std::string::npos
-                                  ? CONCRETE_SCHEDULER_WARP_LIMITING
-                                  : NUM_CONCRETE_SCHEDULERS;
-  assert(scheduler != NUM_CONCRETE_SCHEDULERS);
+  const std::vector<scheduler_policy_t> &policies = scheduler_policies();
+  const scheduler_policy_t *policy = NULL;
+  for (unsigned p = 0; p < policies.size() && !policy; p++) {
+    if (sched_config.find(policies[p].name) != std::string::npos)
+      policy = &policies[p];
+  }
+  if (policy == NULL) {
+    printf("GPGPU-Sim uArch: ERROR ** unknown warp scheduler \"%s\"\n",
+           m_config->gpgpu_scheduler_string);
+    abort();
+  }
 
   for (unsigned i = 0; i < m_config->gpgpu_num_sched_per_core; i++) {
-    switch (scheduler) {
-      case CONCRETE_SCHEDULER_LRR:
-        schedulers.push_back(new lrr_scheduler(
-            m_stats, this, m_scoreboard, m_simt_stack, &m_warp,
-            &m_pipeline_reg[ID_OC_SP], &m_pipeline_reg[ID_OC_DP],
-            &m_pipeline_reg[ID_OC_SFU], &m_pipeline_reg[ID_OC_INT],
-            &m_pipeline_reg[ID_OC_TENSOR_CORE], m_specilized_dispatch_reg,
-            &m_pipeline_reg[ID_OC_MEM], i));
-        break;
-      case CONCRETE_SCHEDULER_TWO_LEVEL_ACTIVE:
-        schedulers.push_back(new two_level_active_scheduler(
-            m_stats, this, m_scoreboard, m_simt_stack, &m_warp,
-            &m_pipeline_reg[ID_OC_SP], &m_pipeline_reg[ID_OC_DP],
-            &m_pipeline_reg[ID_OC_SFU], &m_pipeline_reg[ID_OC_INT],
-            &m_pipeline_reg[ID_OC_TENSOR_CORE], m_specilized_dispatch_reg,
-            &m_pipeline_reg[ID_OC_MEM], i, m_config->gpgpu_scheduler_string));
-        break;
-      case CONCRETE_SCHEDULER_GTO:
-        schedulers.push_back(new gto_scheduler(
-            m_stats, this, m_scoreboard, m_simt_stack, &m_warp,
-            &m_pipeline_reg[ID_OC_SP], &m_pipeline_reg[ID_OC_DP],
-            &m_pipeline_reg[ID_OC_SFU], &m_pipeline_reg[ID_OC_INT],
-            &m_pipeline_reg[ID_OC_TENSOR_CORE], m_specilized_dispatch_reg,
-            &m_pipeline_reg[ID_OC_MEM], i));
-        break;
-      case CONCRETE_SCHEDULER_OLDEST_FIRST:
-        schedulers.push_back(new oldest_scheduler(
-            m_stats, this, m_scoreboard, m_simt_stack, &m_warp,
-            &m_pipeline_reg[ID_OC_SP], &m_pipeline_reg[ID_OC_DP],
-            &m_pipeline_reg[ID_OC_SFU], &m_pipeline_reg[ID_OC_INT],
-            &m_pipeline_reg[ID_OC_TENSOR_CORE], m_specilized_dispatch_reg,
-            &m_pipeline_reg[ID_OC_MEM], i));
-        break;
-      case CONCRETE_SCHEDULER_WARP_LIMITING:
-        schedulers.push_back(new swl_scheduler(
-            m_stats, this, m_scoreboard, m_simt_stack, &m_warp,
-            &m_pipeline_reg[ID_OC_SP], &m_pipeline_reg[ID_OC_DP],
-            &m_pipeline_reg[ID_OC_SFU], &m_pipeline_reg[ID_OC_INT],
-            &m_pipeline_reg[ID_OC_TENSOR_CORE], m_specilized_dispatch_reg,
-            &m_pipeline_reg[ID_OC_MEM], i, m_config->gpgpu_scheduler_string));
-        break;
-      default:
-        abort();
-    };
+    schedulers.push_back(
+        policy->create(this, i, m_config->gpgpu_scheduler_string));
+  }
+
+  if (m_config->gpgpu_pim_throttle > 0) {
+    std::string throttled = std::string(",") +
+                            m_config->gpgpu_pim_throttle_schedulers + ",";
+    bool enable = throttled.find("," + policy->name + ",") !=
+                  std::string::npos;
+    for (unsigned i = 0; i < schedulers.size(); i++)
+      schedulers[i]->set_pim_throttle(enable);
   }
 
   for (unsigned i = 0; i < m_warp.size(); i++) {
@@ -464,7 +456,7 @@ shader_core_ctx::shader_core_ctx(class gpgpu_sim *gpu,
   m_occupied_shmem = 0;
   m_occupied_regs = 0;
   m_occupied_ctas = 0;
-  m_occupied_hwtid.reset();
+  m_occupied_hwtid.resize(m_config->n_thread_per_shader);
   m_occupied_cta_to_hwtid.clear();
 }
 
@@ -517,7 +509,8 @@ void shader_core_ctx::init_warps(unsigned cta_id, unsigned start_thread,
           active_threads.set(t);
         }
       }
-      m_simt_stack[i]->launch(start_pc, active_threads);
+      m_simt_stack[i]->launch(start_pc, active_threads,
+                              kernel.entry()->max_simt_stack_depth());
 
       if (m_gpu->resume_option == 1 && kernel_id == m_gpu->resume_kernel &&
           ctaid >= m_gpu->resume_CTA && ctaid < m_gpu->checkpoint_CTA_t) {
@@ -537,6 +530,7 @@ void shader_core_ctx::init_warps(unsigned cta_id, unsigned start_thread,
       }
 
       m_warp[i]->init(start_pc, cta_id, i, active_threads, m_dynamic_warp_id);
+      wakeup_scheduler(i);
       ++m_dynamic_warp_id;
       m_not_completed += n_active;
       ++m_active_warps;
@@ -591,6 +585,11 @@ void shader_core_stats::print(FILE *fout) const {
   fprintf(fout, "gpgpu_n_tot_w_icount = %lld\n", warp_icount_uarch);
 
   fprintf(fout, "gpgpu_n_stall_shd_mem = %d\n", gpgpu_n_stall_shd_mem);
+  if (m_config->gpgpu_pim_throttle > 0) {
+    fprintf(fout, "pim_throttle_cycles = %u\n", pim_throttle_cycles);
+    fprintf(fout, "pim_throttle_demoted = %u\n", pim_throttle_demoted);
+    fprintf(fout, "pim_throttle_issued = %u\n", pim_throttle_issued);
+  }
   fprintf(fout, "gpgpu_n_mem_read_local = %d\n", gpgpu_n_mem_read_local);
   fprintf(fout, "gpgpu_n_mem_write_local = %d\n", gpgpu_n_mem_write_local);
   fprintf(fout, "gpgpu_n_mem_read_global = %d\n", gpgpu_n_mem_read_global);
@@ -707,6 +706,78 @@ void shader_core_stats::print(FILE *fout) const {
   m_incoming_traffic_stats->print(fout);
 }
 
+void shader_core_stats::register_stats(stats_registry &reg) const {
+  const unsigned n = m_config->num_shader();
+
+  // per shader core
+  reg.add("shd.shader_cycles", shader_cycles, n);
+  reg.add("shd.num_sim_insn", m_num_sim_insn, n);
+  reg.add("shd.num_sim_winsn", m_num_sim_winsn, n);
+  reg.add("shd.num_decoded_insn", m_num_decoded_insn, n);
+  reg.add("shd.num_FPdecoded_insn", m_num_FPdecoded_insn, n);
+  reg.add("shd.num_INTdecoded_insn", m_num_INTdecoded_insn, n);
+  reg.add("shd.num_storequeued_insn", m_num_storequeued_insn, n);
+  reg.add("shd.num_loadqueued_insn", m_num_loadqueued_insn, n);
+  reg.add("shd.num_ialu_acesses", m_num_ialu_acesses, n);
+  reg.add("shd.num_fp_acesses", m_num_fp_acesses, n);
+  reg.add("shd.num_imul_acesses", m_num_imul_acesses, n);
+  reg.add("shd.num_fpmul_acesses", m_num_fpmul_acesses, n);
+  reg.add("shd.num_idiv_acesses", m_num_idiv_acesses, n);
+  reg.add("shd.num_fpdiv_acesses", m_num_fpdiv_acesses, n);
+  reg.add("shd.num_sp_acesses", m_num_sp_acesses, n);
+  reg.add("shd.num_sfu_acesses", m_num_sfu_acesses, n);
+  reg.add("shd.num_tensor_core_acesses", m_num_tensor_core_acesses, n);
+  reg.add("shd.num_mem_acesses", m_num_mem_acesses, n);
+  reg.add("shd.num_tex_inst", m_num_tex_inst, n);
+  reg.add("shd.read_regfile_acesses", m_read_regfile_acesses, n);
+  reg.add("shd.write_regfile_acesses", m_write_regfile_acesses, n);
+  reg.add("shd.non_rf_operands", m_non_rf_operands, n);
+  reg.add("shd.n_diverge", m_n_diverge, n);
+  reg.add("shd.n_shmem_bank_access", gpgpu_n_shmem_bank_access, n);
+  reg.add("shd.n_simt_to_mem", n_simt_to_mem, n);
+  reg.add("shd.n_mem_to_simt", n_mem_to_simt, n);
+
+  // whole GPU
+  reg.add("shd.n_load_insn", &gpgpu_n_load_insn);
+  reg.add("shd.n_store_insn", &gpgpu_n_store_insn);
+  reg.add("shd.n_shmem_insn", &gpgpu_n_shmem_insn);
+  reg.add("shd.n_sstarr_insn", &gpgpu_n_sstarr_insn);
+  reg.add("shd.n_tex_insn", &gpgpu_n_tex_insn);
+  reg.add("shd.n_const_insn", &gpgpu_n_const_insn);
+  reg.add("shd.n_param_insn", &gpgpu_n_param_insn);
+  reg.add("shd.n_shmem_bkconflict", &gpgpu_n_shmem_bkconflict);
+  reg.add("shd.n_cache_bkconflict", &gpgpu_n_cache_bkconflict);
+  reg.add("shd.n_intrawarp_mshr_merge", &gpgpu_n_intrawarp_mshr_merge);
+  reg.add("shd.n_cmem_portconflict", &gpgpu_n_cmem_portconflict);
+  reg.add("shd.n_stall_shd_mem", &gpgpu_n_stall_shd_mem);
+  reg.add("shd.pim_throttle_cycles", &pim_throttle_cycles);
+  reg.add("shd.pim_throttle_demoted", &pim_throttle_demoted);
+  reg.add("shd.pim_throttle_issued", &pim_throttle_issued);
+  reg.add("shd.reg_bank_conflict_stalls", &gpu_reg_bank_conflict_stalls);
+  reg.add("shd.stall_shd_mem_breakdown", &gpu_stall_shd_mem_breakdown[0][0],
+          N_MEM_STAGE_ACCESS_TYPE * N_MEM_STAGE_STALL_TYPE,
+          N_MEM_STAGE_STALL_TYPE);
+  reg.add("shd.cycle_distro", shader_cycle_distro, m_config->warp_size + 3);
+  reg.add("shd.single_issue_nums", single_issue_nums,
+          m_config->gpgpu_num_sched_per_core);
+  reg.add("shd.dual_issue_nums", dual_issue_nums,
+          m_config->gpgpu_num_sched_per_core);
+  reg.add("shd.ctas_completed", &ctas_completed);
+  reg.add("shd.n_mem_read_local", &gpgpu_n_mem_read_local);
+  reg.add("shd.n_mem_write_local", &gpgpu_n_mem_write_local);
+  reg.add("shd.n_mem_texture", &gpgpu_n_mem_texture);
+  reg.add("shd.n_mem_const", &gpgpu_n_mem_const);
+  reg.add("shd.n_mem_read_global", &gpgpu_n_mem_read_global);
+  reg.add("shd.n_mem_write_global", &gpgpu_n_mem_write_global);
+  reg.add("shd.n_mem_read_inst", &gpgpu_n_mem_read_inst);
+  reg.add("shd.n_mem_l2_writeback", &gpgpu_n_mem_l2_writeback);
+  reg.add("shd.n_mem_l1_write_allocate", &gpgpu_n_mem_l1_write_allocate);
+  reg.add("shd.n_mem_l2_write_allocate", &gpgpu_n_mem_l2_write_allocate);
+  reg.add("shd.n_mem_l1_prefetch", &gpgpu_n_mem_l1_prefetch);
+  reg.add("shd.made_write_mfs", &made_write_mfs);
+  reg.add("shd.made_read_mfs", &made_read_mfs);
+}
+
 void shader_core_stats::event_warp_issued(unsigned s_id, unsigned warp_id,
                                           unsigned num_issued,
                                           unsigned dynamic_warp_id) {
@@ -857,6 +928,7 @@ void shader_core_ctx::decode() {
     const warp_inst_t *pI1 = get_next_inst(m_inst_fetch_buffer.m_warp_id, pc);
     m_warp[m_inst_fetch_buffer.m_warp_id]->ibuffer_fill(0, pI1);
     m_warp[m_inst_fetch_buffer.m_warp_id]->inc_inst_in_pipeline();
+    wakeup_scheduler(m_inst_fetch_buffer.m_warp_id);
     if (pI1) {
       m_stats->m_num_decoded_insn[m_sid]++;
       if (pI1->oprnd_type == INT_OP) {
@@ -1008,7 +1080,10 @@ void shader_core_ctx::issue_warp(register_set &pipe_reg_set,
                      m_warp[warp_id]->get_dynamic_warp_id(),
                      sch_id);  // dynamic instruction information
   m_stats->shader_cycle_distro[2 + (*pipe_reg)->active_count()]++;
-  func_exec_inst(**pipe_reg);
+  {
+    SIM_PROF_SCOPE(FUNC_EXEC);
+    func_exec_inst(**pipe_reg);
+  }
 
   if (next_inst->op == BARRIER_OP) {
     m_warp[warp_id]->store_info_of_last_inst_at_barrier(*pipe_reg);
@@ -1129,6 +1204,7 @@ void scheduler_unit::order_by_priority(
 }
 
 void scheduler_unit::cycle() {
+  SIM_PROF_SCOPE(SCHEDULER_CYCLE);
   SCHED_DPRINTF("scheduler_unit::cycle()\n");
   bool valid_inst =
       false;  // there was one warp with a valid instruction to issue (didn't
@@ -1137,10 +1213,20 @@ void scheduler_unit::cycle() {
                              // waiting for pending register writes
   bool issued_inst = false;  // of these we issued one
 
+  if (m_sleeping) {
+    m_stats->shader_cycle_distro[0]++;  // idle
+    return;
+  }
+
+  bool polled = false;  // some warp got past the waiting/ibuffer checks
   order_warps();
-  for (std::vector<shd_warp_t *>::const_iterator iter =
-           m_next_cycle_prioritized_warps.begin();
-       iter != m_next_cycle_prioritized_warps.end(); iter++) {
+  const bool pim_throttled = m_pim_throttle &&
+                             m_shader->get_gpu()->pim_backpressure() &&
+                             deprioritize_pim_stores();
+  const std::vector<shd_warp_t *> &issue_order =
+      pim_throttled ? m_issue_order : m_next_cycle_prioritized_warps;
+  for (std::vector<shd_warp_t *>::const_iterator iter = issue_order.begin();
+       iter != issue_order.end(); iter++) {
     // Don't consider warps that are not yet valid
     if ((*iter) == NULL || (*iter)->done_exit()) {
       continue;
@@ -1173,6 +1259,7 @@ void scheduler_unit::cycle() {
     while (!warp(warp_id).waiting() && !warp(warp_id).ibuffer_empty() &&
            (checked < max_issue) && (checked <= issued) &&
            (issued < max_issue)) {
+      polled = true;
       const warp_inst_t *pI = warp(warp_id).ibuffer_next_inst();
       // Jin: handle cdp latency;
       if (pI && pI->m_is_cdp && warp(warp_id).m_cdp_latency > 0) {
@@ -1220,7 +1307,8 @@ void scheduler_unit::cycle() {
               if (m_mem_out->has_free(m_shader->m_config->sub_core_model,
                                       m_id) &&
                   (!diff_exec_units ||
-                   previous_issued_inst_exec_type != exec_unit_type_t::MEM)) {
+                   previous_issued_inst_exec_type != exec_unit_type_t::MEM) &&
+                  (!pI->is_load() || load_issue_allowed(warp_id))) {
                 m_shader->issue_warp(*m_mem_out, pI, active_mask, warp_id,
                                      m_id);
                 issued++;
@@ -1229,6 +1317,9 @@ void scheduler_unit::cycle() {
                 previous_issued_inst_exec_type = exec_unit_type_t::MEM;
 
                 warp(warp_id).inc_n_mem_ops_issued();
+                if (pim_throttled && pI->is_store() &&
+                    pI->cache_op == CACHE_STREAMING)
+                  m_stats->pim_throttle_issued++;
               }
             } else {
               bool sp_pipe_avail =
@@ -1392,7 +1483,14 @@ void scheduler_unit::cycle() {
         SCHED_DPRINTF(
             "Warp (warp_id %u, dynamic_warp_id %u) issued %u instructions\n",
             (*iter)->get_warp_id(), (*iter)->get_dynamic_warp_id(), issued);
-        do_on_warp_issued(warp_id, issued, iter);
+        // the policy sees the warp's place in its own list
+        if (pim_throttled)
+          do_on_warp_issued(warp_id, issued,
+                            std::find(m_next_cycle_prioritized_warps.begin(),
+                                      m_next_cycle_prioritized_warps.end(),
+                                      *iter));
+        else
+          do_on_warp_issued(warp_id, issued, iter);
       }
       checked++;
     }
@@ -1422,6 +1520,18 @@ void scheduler_unit::cycle() {
     }
   }
 
+  // Nothing changes until a warp is woken up.  Warps at a memory barrier
+  // keep being polled since waiting() is what releases them.
+  if (!polled && !m_pim_throttle && can_sleep()) {
+    m_sleeping = true;
+    for (unsigned i = 0; i < m_supervised_warps.size(); i++) {
+      if (m_supervised_warps[i]->get_membar()) {
+        m_sleeping = false;
+        break;
+      }
+    }
+  }
+
   // issue stall statistics:
   if (!valid_inst)
     m_stats->shader_cycle_distro[0]++;  // idle or control hazard
@@ -1432,6 +1542,34 @@ void scheduler_unit::cycle() {
     m_stats->shader_cycle_distro[2]++;  // pipeline stalled
 }
 
+static bool next_inst_is_pim_store(shd_warp_t *w) {
+  if (w == NULL || w->done_exit()) return false;
+  const warp_inst_t *inst = w->ibuffer_next_inst();
+  return inst && inst->is_store() && inst->cache_op == CACHE_STREAMING;
+}
+
+static bool next_inst_is_not_pim_store(shd_warp_t *w) {
+  return !next_inst_is_pim_store(w);
+}
+
+// While the DRAM PIM queues are backed up, warps about to issue a PIM store
+// only get the issue slots the compute and MEM warps leave over.  The
+// policy's order is kept within both groups.  The partition is done on a
+// copy, so policies that carry their list across cycles (two-level,
+// criticality) get their order back once the back-pressure ends.  Returns
+// true when a warp was moved, i.e. m_issue_order is to be used this cycle.
+bool scheduler_unit::deprioritize_pim_stores() {
+  m_issue_order = m_next_cycle_prioritized_warps;
+  std::vector<shd_warp_t *>::iterator first_pim =
+      std::stable_partition(m_issue_order.begin(), m_issue_order.end(),
+                            next_inst_is_not_pim_store);
+  unsigned demoted = m_issue_order.end() - first_pim;
+  if (demoted == 0) return false;
+  m_stats->pim_throttle_cycles++;
+  m_stats->pim_throttle_demoted += demoted;
+  return true;
+}
+
 void scheduler_unit::do_on_warp_issued(
     unsigned warp_id, unsigned num_issued,
     const std::vector<shd_warp_t *>::const_iterator &prioritized_iter) {
@@ -1572,6 +1710,175 @@ void swl_scheduler::order_warps() {
   }
 }
 
+#define CCWS_DECAY_PERIOD 64
+
+ccws_scheduler::ccws_scheduler(
+    shader_core_stats *stats, shader_core_ctx *shader, Scoreboard *scoreboard,
+    simt_stack **simt, std::vector<shd_warp_t *> *warp, register_set *sp_out,
+    register_set *dp_out, register_set *sfu_out, register_set *int_out,
+    register_set *tensor_core_out, std::vector<register_set *> &spec_cores_out,
+    register_set *mem_out, int id, char *config_string)
+    : scheduler_unit(stats, shader, scoreboard, simt, warp, sp_out, dp_out,
+                     sfu_out, int_out, tensor_core_out, spec_cores_out, mem_out,
+                     id),
+      m_base_score(100),
+      m_miss_score(50),
+      m_cycle(0) {
+  const char *params = strstr(config_string, "ccws");
+  if (params) sscanf(params, "ccws:%u:%u", &m_base_score, &m_miss_score);
+  unsigned n_warps = shader->get_config()->max_warps_per_shader;
+  m_score.assign(n_warps, 0);
+  m_throttled.assign(n_warps, false);
+}
+
+void ccws_scheduler::order_warps() {
+  if (++m_cycle % CCWS_DECAY_PERIOD == 0) {
+    for (unsigned i = 0; i < m_supervised_warps.size(); i++) {
+      unsigned &score = m_score[m_supervised_warps[i]->get_warp_id()];
+      score -= score / 4;
+    }
+  }
+  order_by_priority(m_next_cycle_prioritized_warps, m_supervised_warps,
+                    m_last_supervised_issued, m_supervised_warps.size(),
+                    ORDERING_GREEDY_THEN_PRIORITY_FUNC,
+                    scheduler_unit::sort_warps_by_oldest_dynamic_id);
+
+  // Stack the scores of the live warps, highest first.  Warps that end up
+  // past the cutoff may not issue loads; the first warp always may.
+  m_by_score.clear();
+  unsigned long long total = 0;
+  for (unsigned i = 0; i < m_supervised_warps.size(); i++) {
+    shd_warp_t *w = m_supervised_warps[i];
+    m_throttled[w->get_warp_id()] = false;
+    if (w->done_exit() || w->functional_done()) continue;
+    m_by_score.push_back(w);
+    total += effective_score(w);
+  }
+  const unsigned long long cutoff =
+      (unsigned long long)m_base_score * m_by_score.size();
+  if (total <= cutoff) return;
+
+  std::stable_sort(m_by_score.begin(), m_by_score.end(), by_score(this));
+  unsigned long long stacked = 0;
+  for (unsigned i = 0; i < m_by_score.size(); i++) {
+    stacked += effective_score(m_by_score[i]);
+    if (i > 0 && stacked > cutoff)
+      m_throttled[m_by_score[i]->get_warp_id()] = true;
+  }
+}
+
+void criticality_scheduler::done_adding_supervised_warps() {
+  m_last_supervised_issued = m_supervised_warps.begin();
+  unsigned n_warps = m_shader->get_config()->max_warps_per_shader;
+  m_n_issued.assign(n_warps, 0);
+  m_dynamic_id.assign(n_warps, (unsigned)-1);
+  m_next_cycle_prioritized_warps = m_supervised_warps;
+}
+
+bool criticality_scheduler::more_critical(const shd_warp_t *lhs,
+                                          const shd_warp_t *rhs) const {
+  unsigned long long lhs_issued = m_n_issued[lhs->get_warp_id()];
+  unsigned long long rhs_issued = m_n_issued[rhs->get_warp_id()];
+  if (lhs_issued != rhs_issued) return lhs_issued < rhs_issued;
+  return lhs->get_dynamic_warp_id() < rhs->get_dynamic_warp_id();
+}
+
+void criticality_scheduler::order_warps() {
+  // a relaunched warp slot starts over and needs a full sort
+  bool resort = false;
+  for (unsigned i = 0; i < m_next_cycle_prioritized_warps.size(); i++) {
+    shd_warp_t *w = m_next_cycle_prioritized_warps[i];
+    unsigned wid = w->get_warp_id();
+    if (w->get_dynamic_warp_id() != m_dynamic_id[wid]) {
+      m_dynamic_id[wid] = w->get_dynamic_warp_id();
+      m_n_issued[wid] = 0;
+      resort = true;
+    }
+  }
+
+  if (resort) {
+    std::stable_sort(m_next_cycle_prioritized_warps.begin(),
+                     m_next_cycle_prioritized_warps.end(),
+                     by_criticality(this));
+  } else if (m_moved_warp >= 0) {
+    // only the warp that issued has become less critical: move it back
+    std::vector<shd_warp_t *>::iterator w =
+        m_next_cycle_prioritized_warps.begin();
+    while ((*w)->get_warp_id() != (unsigned)m_moved_warp) ++w;
+    std::vector<shd_warp_t *>::iterator pos =
+        std::upper_bound(w + 1, m_next_cycle_prioritized_warps.end(), *w,
+                         by_criticality(this));
+    std::rotate(w, w + 1, pos);
+  }
+  m_moved_warp = -1;
+}
+
+void criticality_scheduler::do_on_warp_issued(
+    unsigned warp_id, unsigned num_issued,
+    const std::vector<shd_warp_t *>::const_iterator &prioritized_iter) {
+  scheduler_unit::do_on_warp_issued(warp_id, num_issued, prioritized_iter);
+  // called once per instruction; num_issued counts this cycle's total
+  m_n_issued[warp_id]++;
+  m_moved_warp = warp_id;
+}
+
+#define PIM_BALANCE_WINDOW 1024
+
+pim_balance_scheduler::pim_balance_scheduler(
+    shader_core_stats *stats, shader_core_ctx *shader, Scoreboard *scoreboard,
+    simt_stack **simt, std::vector<shd_warp_t *> *warp, register_set *sp_out,
+    register_set *dp_out, register_set *sfu_out, register_set *int_out,
+    register_set *tensor_core_out, std::vector<register_set *> &spec_cores_out,
+    register_set *mem_out, int id, char *config_string)
+    : scheduler_unit(stats, shader, scoreboard, simt, warp, sp_out, dp_out,
+                     sfu_out, int_out, tensor_core_out, spec_cores_out, mem_out,
+                     id),
+      m_target_percent(25),
+      m_n_issued(0),
+      m_n_pim_issued(0) {
+  const char *params = strstr(config_string, "pim_balance");
+  if (params) sscanf(params, "pim_balance:%u", &m_target_percent);
+  assert(m_target_percent <= 100);
+  m_next_is_pim.assign(shader->get_config()->max_warps_per_shader, false);
+}
+
+void pim_balance_scheduler::order_warps() {
+  order_by_priority(m_next_cycle_prioritized_warps, m_supervised_warps,
+                    m_last_supervised_issued, m_supervised_warps.size(),
+                    ORDERING_GREEDY_THEN_PRIORITY_FUNC,
+                    scheduler_unit::sort_warps_by_oldest_dynamic_id);
+  for (unsigned i = 0; i < m_next_cycle_prioritized_warps.size(); i++) {
+    shd_warp_t *w = m_next_cycle_prioritized_warps[i];
+    m_next_is_pim[w->get_warp_id()] = next_inst_is_pim_store(w);
+  }
+  // over the target share: compute and MEM warps first, else PIM first
+  if ((unsigned long long)m_n_pim_issued * 100 >
+      (unsigned long long)m_target_percent * m_n_issued) {
+    std::stable_partition(m_next_cycle_prioritized_warps.begin(),
+                          m_next_cycle_prioritized_warps.end(),
+                          next_inst_is_not_pim_store);
+  } else {
+    std::stable_partition(m_next_cycle_prioritized_warps.begin(),
+                          m_next_cycle_prioritized_warps.end(),
+                          next_inst_is_pim_store);
+  }
+}
+
+void pim_balance_scheduler::do_on_warp_issued(
+    unsigned warp_id, unsigned num_issued,
+    const std::vector<shd_warp_t *>::const_iterator &prioritized_iter) {
+  scheduler_unit::do_on_warp_issued(warp_id, num_issued, prioritized_iter);
+  m_n_issued++;
+  if (m_next_is_pim[warp_id]) {
+    m_n_pim_issued++;
+    m_next_is_pim[warp_id] = false;
+  }
+  if (m_n_issued >= PIM_BALANCE_WINDOW) {
+    m_n_issued /= 2;
+    m_n_pim_issued /= 2;
+  }
+}
+
 void shader_core_ctx::read_operands() {}
 
 address_type coalesced_segment(address_type addr,
@@ -1633,7 +1940,8 @@ unsigned shader_core_ctx::translate_local_memaddr(
     for (unsigned i = 0; i < num_accesses; i++) {
       address_type local_word = localaddr / 4 + i;
       address_type linear_address = local_word * max_concurrent_threads * 4 +
-                                    thread_base + LOCAL_GENERIC_START;
+                                    thread_base +
+                                    g_generic_mem_layout.local_generic_start;
       translated_addrs[i] = linear_address;
     }
   } else {
@@ -1646,7 +1954,7 @@ unsigned shader_core_ctx::translate_local_memaddr(
            local_word);  // Make sure access doesn't overflow into next 4B chunk
     address_type linear_address = local_word * max_concurrent_threads * 4 +
                                   local_word_offset + thread_base +
-                                  LOCAL_GENERIC_START;
+                                  g_generic_mem_layout.local_generic_start;
     translated_addrs[0] = linear_address;
   }
   return num_accesses;
@@ -1835,6 +2143,8 @@ mem_stage_stall_type ldst_unit::process_cache_access(
     delete mf;
   } else {
     assert(status == MISS || status == HIT_RESERVED);
+    if (status == MISS && cache == m_L1D && inst.is_load())
+      m_core->l1d_load_miss(inst.warp_id());
     // inst.clear_active( access.get_warp_mask() ); // threads in mf writeback
     // when mf returns
     inst.accessq_pop_back();
@@ -2555,6 +2865,7 @@ inst->space.get_type() != shared_space) { unsigned warp_id = inst->warp_id();
 }
 */
 void ldst_unit::cycle() {
+  SIM_PROF_SCOPE(LDST_CYCLE);
   writeback();
   for (int i = 0; i < m_config->reg_file_port_throughput; ++i)
     m_operand_collector->step();
@@ -3368,16 +3679,34 @@ void shader_core_config::set_pipeline_latency() {
 }
 
 void shader_core_ctx::cycle() {
-  if (!isactive() && get_not_completed() == 0) return;
+  if (quiescent()) return;
 
   m_stats->shader_cycles[m_sid]++;
-  writeback();
-  execute();
-  read_operands();
-  issue();
+  {
+    SIM_PROF_SCOPE(CORE_WRITEBACK);
+    writeback();
+  }
+  {
+    SIM_PROF_SCOPE(CORE_EXECUTE);
+    execute();
+  }
+  {
+    SIM_PROF_SCOPE(CORE_READ_OPERANDS);
+    read_operands();
+  }
+  {
+    SIM_PROF_SCOPE(CORE_ISSUE);
+    issue();
+  }
   for (int i = 0; i < m_config->inst_fetch_throughput; ++i) {
-    decode();
-    fetch();
+    {
+      SIM_PROF_SCOPE(CORE_DECODE);
+      decode();
+    }
+    {
+      SIM_PROF_SCOPE(CORE_FETCH);
+      fetch();
+    }
   }
 }
 
@@ -3401,6 +3730,12 @@ std::list<opndcoll_rfu_t::op_t> opndcoll_rfu_t::arbiter_t::allocate_reads() {
   assert(_square > 0);
   int _pri = (int)m_last_cu;
 
+  if (m_num_queued == 0) {
+    // no read can be granted; only the priority diagonal moves on
+    m_last_cu = (_pri + 1) % _outputs;
+    return result;
+  }
+
   // Clear matching
   for (int i = 0; i < _inputs; ++i) _inmatch[i] = -1;
   for (int j = 0; j < _outputs; ++j) _outmatch[j] = -1;
@@ -3466,6 +3801,7 @@ std::list<opndcoll_rfu_t::op_t> opndcoll_rfu_t::arbiter_t::allocate_reads() {
         op_t &op = m_queue[bank].front();
         result.push_back(op);
         m_queue[bank].pop_front();
+        m_num_queued--;
       }
     }
   }
@@ -3572,6 +3908,7 @@ void barrier_set_t::warp_reaches_barrier(unsigned cta_id, unsigned warp_id,
       // all warps have reached barrier, so release waiting warps...
       m_bar_id_to_warps[bar_id] &= ~at_barrier;
       m_warp_at_barrier &= ~at_barrier;
+      m_shader->wakeup_schedulers();
       if (bar_type == RED) {
         m_shader->broadcast_barrier_reduction(cta_id, bar_id, at_barrier);
       }
@@ -3583,6 +3920,7 @@ void barrier_set_t::warp_reaches_barrier(unsigned cta_id, unsigned warp_id,
       // warps...
       m_bar_id_to_warps[bar_id] &= ~at_barrier;
       m_warp_at_barrier &= ~at_barrier;
+      m_shader->wakeup_schedulers();
       if (bar_type == RED) {
         m_shader->broadcast_barrier_reduction(cta_id, bar_id, at_barrier);
       }
@@ -3610,6 +3948,7 @@ void barrier_set_t::warp_exit(unsigned warp_id) {
       // all warps have reached barrier, so release waiting warps...
       m_bar_id_to_warps[i] &= ~at_a_specific_barrier;
       m_warp_at_barrier &= ~at_a_specific_barrier;
+      m_shader->wakeup_schedulers();
     }
   }
 }
@@ -3693,6 +4032,8 @@ bool shader_core_ctx::warp_waiting_at_mem_barrier(unsigned warp_id) {
       }
       return false;
     }
+    // writes the fence waits for may sit in an L2 write-combining block
+    if (m_memory_config->l2_wcb_entries) m_gpu->request_wcb_drain();
   } else {
     if (!m_scoreboard->pendingWrites(warp_id)) {
       m_warp[warp_id]->clear_membar();
@@ -3725,6 +4066,7 @@ void shader_core_ctx::set_max_cta(const kernel_info_t &kernel) {
 void shader_core_ctx::decrement_atomic_count(unsigned wid, unsigned n) {
   assert(m_warp[wid]->get_n_atomic() >= n);
   m_warp[wid]->dec_n_atomic(n);
+  wakeup_scheduler(wid);
 }
 
 void shader_core_ctx::broadcast_barrier_reduction(unsigned cta_id,
@@ -4172,6 +4514,7 @@ bool opndcoll_rfu_t::collector_unit_t::allocate(register_set *pipeline_reg_set,
   assert(m_free);
   assert(m_not_ready.none());
   m_free = false;
+  m_rfu->m_num_busy_cu++;
   m_output_register = output_reg_set;
   warp_inst_t **pipeline_reg = pipeline_reg_set->get_ready();
   if ((pipeline_reg) and !((*pipeline_reg)->empty())) {
@@ -4201,6 +4544,7 @@ void opndcoll_rfu_t::collector_unit_t::dispatch() {
   // move_warp(*m_output_register,m_warp);
   m_output_register->move_in(m_warp);
   m_free = true;
+  m_rfu->m_num_busy_cu--;
   m_output_register = NULL;
   for (unsigned i = 0; i < MAX_REG_OPERANDS * 2; i++) m_src_op[i].reset();
 }
@@ -4228,12 +4572,20 @@ simt_core_cluster::simt_core_cluster(class gpgpu_sim *gpu, unsigned cluster_id,
   m_stats = stats;
   m_memory_stats = mstats;
   m_mem_config = mem_config;
+  m_n_awake_cores = 0;
 }
 
 void simt_core_cluster::core_cycle() {
-  for (std::list<unsigned>::iterator it = m_core_sim_order.begin();
-       it != m_core_sim_order.end(); ++it) {
-    m_core[*it]->cycle();
+  if (m_n_awake_cores > 0) {
+    unsigned n_awake = 0;
+    for (std::list<unsigned>::iterator it = m_core_sim_order.begin();
+         it != m_core_sim_order.end(); ++it) {
+      shader_core_ctx *core = m_core[*it];
+      if (core->quiescent()) continue;
+      core->cycle();
+      if (!core->quiescent()) n_awake++;
+    }
+    m_n_awake_cores = n_awake;
   }
 
   if (m_config->simt_core_sim_order == 1) {
@@ -4283,6 +4635,7 @@ unsigned simt_core_cluster::get_n_active_cta() const {
 }
 
 unsigned simt_core_cluster::get_n_active_sms() const {
+  if (m_n_awake_cores == 0) return 0;
   unsigned n = 0;
   for (unsigned i = 0; i < m_config->n_simt_cores_per_cluster; i++)
     n += m_core[i]->isactive();
@@ -4324,6 +4677,7 @@ unsigned simt_core_cluster::issue_block2core() {
         m_core[core]->can_issue_1block(*kernel)) {
       m_core[core]->issue_block2core(*kernel);
       num_blocks_issued++;
+      m_n_awake_cores++;
       m_cta_issue_next_core = core;
       break;
     }
@@ -4390,6 +4744,9 @@ void simt_core_cluster::icnt_inject_request_packet(class mem_fetch *mf) {
     case L2_WR_ALLOC_R:
       m_stats->gpgpu_n_mem_l2_write_allocate++;
       break;
+    case L1_PREF_R:
+      m_stats->gpgpu_n_mem_l1_prefetch++;
+      break;
     default:
       assert(0);
   }
@@ -40,6 +40,7 @@
 #include <list>
 #include <map>
 #include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -297,17 +298,6 @@ enum scheduler_prioritization_type {
   SCHEDULER_PRIORITIZATION_YOUNGEST,  // Youngest First
 };
 
-// Each of these corresponds to a string value in the gpgpsim.config file
-// For example - to specify the LRR scheudler the config must contain lrr
-enum concrete_scheduler {
-  CONCRETE_SCHEDULER_LRR = 0,
-  CONCRETE_SCHEDULER_GTO,
-  CONCRETE_SCHEDULER_TWO_LEVEL_ACTIVE,
-  CONCRETE_SCHEDULER_WARP_LIMITING,
-  CONCRETE_SCHEDULER_OLDEST_FIRST,
-  NUM_CONCRETE_SCHEDULERS
-};
-
 class scheduler_unit {  // this can be copied freely, so can be used in std
                         // containers.
  public:
@@ -331,7 +321,9 @@ class scheduler_unit {  // this can be copied freely, so can be used in std
         m_tensor_core_out(tensor_core_out),
         m_spec_cores_out(spec_cores_out),
         m_mem_out(mem_out),
-        m_id(id) {}
+        m_id(id),
+        m_pim_throttle(false),
+        m_sleeping(false) {}
   virtual ~scheduler_unit() {}
   virtual void add_supervised_warp_id(int i) {
     m_supervised_warps.push_back(&warp(i));
@@ -377,8 +369,20 @@ class scheduler_unit {  // this can be copied freely, so can be used in std
   virtual void order_warps() = 0;
 
   int get_schd_id() const { return m_id; }
+  // act on the DRAM PIM queue back-pressure (-gpgpu_pim_throttle)
+  void set_pim_throttle(bool enable) { m_pim_throttle = enable; }
+  // a supervised warp may have become issuable (ibuffer fill, barrier or
+  // atomic release, new CTA)
+  void wakeup() { m_sleeping = false; }
+  // a load of a supervised warp missed in the L1D
+  virtual void on_l1d_load_miss(unsigned warp_id) {}
 
  protected:
+  // whether order_warps() may be skipped while no warp can issue; policies
+  // that update their own state in order_warps() must return false
+  virtual bool can_sleep() const { return true; }
+  // policies may hold back the loads of a warp that is otherwise ready
+  virtual bool load_issue_allowed(unsigned warp_id) const { return true; }
   virtual void do_on_warp_issued(
       unsigned warp_id, unsigned num_issued,
       const std::vector<shd_warp_t *>::const_iterator &prioritized_iter);
@@ -414,6 +418,18 @@ class scheduler_unit {  // this can be copied freely, so can be used in std
   std::vector<register_set *> &m_spec_cores_out;
 
   int m_id;
+
+ private:
+  // fills m_issue_order with the prioritized warps, those whose next
+  // instruction is a PIM store behind all others
+  bool deprioritize_pim_stores();
+  bool m_pim_throttle;
+  // this cycle's issue order while the PIM store throttle is active; the
+  // policy's own m_next_cycle_prioritized_warps is left as it was
+  std::vector<shd_warp_t *> m_issue_order;
+  // set after a cycle in which every warp was exited, waiting or had an
+  // empty ibuffer; cleared by wakeup()
+  bool m_sleeping;
 };
 
 class lrr_scheduler : public scheduler_unit {
@@ -515,6 +531,8 @@ class two_level_active_scheduler : public scheduler_unit {
   virtual void do_on_warp_issued(
       unsigned warp_id, unsigned num_issued,
       const std::vector<shd_warp_t *>::const_iterator &prioritized_iter);
+  // order_warps() rotates the pending list every cycle
+  virtual bool can_sleep() const { return false; }
 
  private:
   std::deque<shd_warp_t *> m_pending_warps;
@@ -544,6 +562,143 @@ class swl_scheduler : public scheduler_unit {
   unsigned m_num_warps_to_limit;
 };
 
+// Cache-conscious scheduler (CCWS-like): L1D load misses raise a warp's
+// lost-locality score.  When the scores no longer fit the cutoff, the warps
+// with the lowest scores may not issue loads until the scores decay.
+// Config: ccws[:<base score>:<miss score>]
+class ccws_scheduler : public scheduler_unit {
+ public:
+  ccws_scheduler(shader_core_stats *stats, shader_core_ctx *shader,
+                 Scoreboard *scoreboard, simt_stack **simt,
+                 std::vector<shd_warp_t *> *warp, register_set *sp_out,
+                 register_set *dp_out, register_set *sfu_out,
+                 register_set *int_out, register_set *tensor_core_out,
+                 std::vector<register_set *> &spec_cores_out,
+                 register_set *mem_out, int id, char *config_string);
+  virtual ~ccws_scheduler() {}
+  virtual void order_warps();
+  virtual void done_adding_supervised_warps() {
+    m_last_supervised_issued = m_supervised_warps.begin();
+  }
+  virtual void on_l1d_load_miss(unsigned warp_id) {
+    m_score[warp_id] += m_miss_score;
+  }
+
+ protected:
+  // scores decay every 64 cycles (CCWS_DECAY_PERIOD)
+  virtual bool can_sleep() const { return false; }
+  virtual bool load_issue_allowed(unsigned warp_id) const {
+    return !m_throttled[warp_id];
+  }
+
+ private:
+  unsigned effective_score(const shd_warp_t *w) const {
+    return std::max(m_score[w->get_warp_id()], m_base_score);
+  }
+  struct by_score {
+    explicit by_score(const ccws_scheduler *sched) : m_sched(sched) {}
+    bool operator()(const shd_warp_t *lhs, const shd_warp_t *rhs) const {
+      return m_sched->effective_score(lhs) > m_sched->effective_score(rhs);
+    }
+    const ccws_scheduler *m_sched;
+  };
+
+  unsigned m_base_score;
+  unsigned m_miss_score;
+  unsigned long long m_cycle;
+  std::vector<unsigned> m_score;  // lost-locality score, by warp id
+  std::vector<bool> m_throttled;  // loads held back, by warp id
+  std::vector<shd_warp_t *> m_by_score;
+};
+
+// Criticality-aware scheduler: warps that have issued the fewest
+// instructions since they were launched lag behind their CTA and go first
+// (oldest first on ties).  The order is kept sorted across cycles; only the
+// warp that issued is moved.
+class criticality_scheduler : public scheduler_unit {
+ public:
+  criticality_scheduler(shader_core_stats *stats, shader_core_ctx *shader,
+                        Scoreboard *scoreboard, simt_stack **simt,
+                        std::vector<shd_warp_t *> *warp,
+                        register_set *sp_out, register_set *dp_out,
+                        register_set *sfu_out, register_set *int_out,
+                        register_set *tensor_core_out,
+                        std::vector<register_set *> &spec_cores_out,
+                        register_set *mem_out, int id)
+      : scheduler_unit(stats, shader, scoreboard, simt, warp, sp_out, dp_out,
+                       sfu_out, int_out, tensor_core_out, spec_cores_out,
+                       mem_out, id),
+        m_moved_warp(-1) {}
+  virtual ~criticality_scheduler() {}
+  virtual void order_warps();
+  virtual void done_adding_supervised_warps();
+
+ protected:
+  virtual void do_on_warp_issued(
+      unsigned warp_id, unsigned num_issued,
+      const std::vector<shd_warp_t *>::const_iterator &prioritized_iter);
+
+ private:
+  bool more_critical(const shd_warp_t *lhs, const shd_warp_t *rhs) const;
+  struct by_criticality {
+    explicit by_criticality(const criticality_scheduler *sched)
+        : m_sched(sched) {}
+    bool operator()(const shd_warp_t *lhs, const shd_warp_t *rhs) const {
+      return m_sched->more_critical(lhs, rhs);
+    }
+    const criticality_scheduler *m_sched;
+  };
+
+  std::vector<unsigned long long> m_n_issued;  // by warp id
+  std::vector<unsigned> m_dynamic_id;          // by warp id
+  int m_moved_warp;  // issued last cycle, to be re-sorted
+};
+
+// PIM-aware scheduler: greedy-then-oldest order, with the warps about to
+// issue a PIM (CACHE_STREAMING) store moved behind or ahead of the others
+// to keep those stores near a target share of the issued instructions.
+// Config: pim_balance[:<percent>]
+class pim_balance_scheduler : public scheduler_unit {
+ public:
+  pim_balance_scheduler(shader_core_stats *stats, shader_core_ctx *shader,
+                        Scoreboard *scoreboard, simt_stack **simt,
+                        std::vector<shd_warp_t *> *warp,
+                        register_set *sp_out, register_set *dp_out,
+                        register_set *sfu_out, register_set *int_out,
+                        register_set *tensor_core_out,
+                        std::vector<register_set *> &spec_cores_out,
+                        register_set *mem_out, int id, char *config_string);
+  virtual ~pim_balance_scheduler() {}
+  virtual void order_warps();
+  virtual void done_adding_supervised_warps() {
+    m_last_supervised_issued = m_supervised_warps.begin();
+  }
+
+ protected:
+  virtual void do_on_warp_issued(
+      unsigned warp_id, unsigned num_issued,
+      const std::vector<shd_warp_t *>::const_iterator &prioritized_iter);
+
+ private:
+  unsigned m_target_percent;
+  unsigned m_n_issued;
+  unsigned m_n_pim_issued;
+  std::vector<bool> m_next_is_pim;  // by warp id, set by order_warps()
+};
+
+// Warp scheduler policies.  -gpgpu_scheduler selects the first registered
+// policy whose name occurs in the option string.  New policies are added
+// with shader_core_ctx::register_scheduler_policy() before the cores are
+// created; shader_core_ctx::new_scheduler<T> builds the usual constructor
+// arguments.
+typedef scheduler_unit *(*scheduler_factory_t)(class shader_core_ctx *core,
+                                               unsigned id,
+                                               char *config_string);
+struct scheduler_policy_t {
+  std::string name;
+  scheduler_factory_t create;
+};
+
 class opndcoll_rfu_t {  // operand collector based register file unit
  public:
   // constructors
@@ -551,6 +706,7 @@ class opndcoll_rfu_t {  // operand collector based register file unit
     m_num_banks = 0;
     m_shader = NULL;
     m_initialized = false;
+    m_num_busy_cu = 0;
   }
   void add_cu_set(unsigned cu_set, unsigned num_cu, unsigned num_dispatch);
   typedef std::vector<register_set *> port_vector_t;
@@ -563,9 +719,13 @@ class opndcoll_rfu_t {  // operand collector based register file unit
   bool writeback(warp_inst_t &warp);
 
   void step() {
-    dispatch_ready_cu();
+    // nothing to dispatch while every collector unit is free, and no
+    // instruction can be accepted while all of them are busy
+    if (m_num_busy_cu > 0) dispatch_ready_cu();
     allocate_reads();
-    for (unsigned p = 0; p < m_in_ports.size(); p++) allocate_cu(p);
+    if (m_num_busy_cu < m_cu.size()) {
+      for (unsigned p = 0; p < m_in_ports.size(); p++) allocate_cu(p);
+    }
     process_banks();
   }
 
@@ -737,6 +897,9 @@ class opndcoll_rfu_t {  // operand collector based register file unit
       m_queue = NULL;
       m_allocated_bank = NULL;
       m_allocator_rr_head = NULL;
+      m_busy_banks = NULL;
+      m_num_busy_banks = 0;
+      m_num_queued = 0;
       _inmatch = NULL;
       _outmatch = NULL;
       _request = NULL;
@@ -754,6 +917,7 @@ class opndcoll_rfu_t {  // operand collector based register file unit
         _request[i] = new int[m_num_collectors];
       m_queue = new std::list<op_t>[num_banks];
       m_allocated_bank = new allocation_t[num_banks];
+      m_busy_banks = new unsigned[num_banks];
       m_allocator_rr_head = new unsigned[num_cu];
       for (unsigned n = 0; n < num_cu; n++)
         m_allocator_rr_head[n] = n % num_banks;
@@ -791,6 +955,7 @@ class opndcoll_rfu_t {  // operand collector based register file unit
         if (op.valid()) {
           unsigned bank = op.get_bank();
           m_queue[bank].push_back(op);
+          m_num_queued++;
         }
       }
     }
@@ -800,13 +965,17 @@ class opndcoll_rfu_t {  // operand collector based register file unit
     void allocate_bank_for_write(unsigned bank, const op_t &op) {
       assert(bank < m_num_banks);
       m_allocated_bank[bank].alloc_write(op);
+      m_busy_banks[m_num_busy_banks++] = bank;
     }
     void allocate_for_read(unsigned bank, const op_t &op) {
       assert(bank < m_num_banks);
       m_allocated_bank[bank].alloc_read(op);
+      m_busy_banks[m_num_busy_banks++] = bank;
     }
     void reset_alloction() {
-      for (unsigned b = 0; b < m_num_banks; b++) m_allocated_bank[b].reset();
+      for (unsigned n = 0; n < m_num_busy_banks; n++)
+        m_allocated_bank[m_busy_banks[n]].reset();
+      m_num_busy_banks = 0;
     }
 
    private:
@@ -814,7 +983,10 @@ class opndcoll_rfu_t {  // operand collector based register file unit
     unsigned m_num_collectors;
 
     allocation_t *m_allocated_bank;  // bank # -> register that wins
+    unsigned *m_busy_banks;  // banks allocated this cycle, for the reset
+    unsigned m_num_busy_banks;
     std::list<op_t> *m_queue;
+    unsigned m_num_queued;  // read requests over all bank queues
 
     unsigned *
         m_allocator_rr_head;  // cu # -> next bank to check for request (rr-arb)
@@ -930,6 +1102,7 @@ class opndcoll_rfu_t {  // operand collector based register file unit
   unsigned m_bank_warp_shift;
   unsigned m_warp_size;
   std::vector<collector_unit_t *> m_cu;
+  unsigned m_num_busy_cu;  // collector units holding an instruction
   arbiter_t m_arbiter;
 
   unsigned m_num_banks_per_sched;
@@ -1428,13 +1601,6 @@ class shader_core_config : public core_config {
 
     delete[] tokd;
 
-    if (n_thread_per_shader > MAX_THREAD_PER_SM) {
-      printf(
-          "GPGPU-Sim uArch: Error ** increase MAX_THREAD_PER_SM in "
-          "abstract_hardware_model.h from %u to %u\n",
-          MAX_THREAD_PER_SM, n_thread_per_shader);
-      abort();
-    }
     max_warps_per_shader = n_thread_per_shader / warp_size;
     assert(!(n_thread_per_shader % warp_size));
 
@@ -1587,6 +1753,8 @@ class shader_core_config : public core_config {
   unsigned m_specialized_unit_num;
 
   bool gpgpu_pim_fence;
+  float gpgpu_pim_throttle;  // PIM queue occupancy that throttles, 0 = off
+  char *gpgpu_pim_throttle_schedulers;
 };
 
 struct shader_core_stats_pod {
@@ -1654,6 +1822,11 @@ struct shader_core_stats_pod {
   unsigned *last_shader_cycle_distro;
   unsigned *num_warps_issuable;
   unsigned gpgpu_n_stall_shd_mem;
+  // -gpgpu_pim_throttle: scheduler cycles with PIM store warps moved back,
+  // warps moved back and PIM stores issued anyway
+  unsigned pim_throttle_cycles;
+  unsigned pim_throttle_demoted;
+  unsigned pim_throttle_issued;
   unsigned *single_issue_nums;
   unsigned *dual_issue_nums;
 
@@ -1670,6 +1843,7 @@ struct shader_core_stats_pod {
   int gpgpu_n_mem_l2_writeback;
   int gpgpu_n_mem_l1_write_allocate;
   int gpgpu_n_mem_l2_write_allocate;
+  int gpgpu_n_mem_l1_prefetch;
 
   unsigned made_write_mfs;
   unsigned made_read_mfs;
@@ -1801,6 +1975,7 @@ class shader_core_stats : public shader_core_stats_pod {
                          unsigned dynamic_warp_id);
 
   void visualizer_print(gzFile visualizer_file);
+  void register_stats(class stats_registry &reg) const;
 
   void print(FILE *fout) const;
 
@@ -1860,6 +2035,32 @@ class shader_core_mem_fetch_allocator : public mem_fetch_allocator {
   const memory_config *m_memory_config;
 };
 
+// One bit per hardware thread of a core.  Behaves like the std::bitset it
+// replaces, but is sized from -gpgpu_shader_core_pipeline at run time; bits
+// past the end read as clear.
+class hw_thread_mask_t {
+ public:
+  void resize(unsigned n) { m_bits.assign(n, false); }
+  unsigned size() const { return m_bits.size(); }
+
+  void set(unsigned tid) { m_bits.at(tid) = true; }
+  void reset(unsigned tid) { m_bits.at(tid) = false; }
+  void reset() { std::fill(m_bits.begin(), m_bits.end(), false); }
+  bool test(unsigned tid) const { return tid < m_bits.size() && m_bits[tid]; }
+  unsigned count() const {
+    return std::count(m_bits.begin(), m_bits.end(), true);
+  }
+  std::string to_string() const {
+    std::string str(m_bits.size(), '0');
+    for (unsigned tid = 0; tid < m_bits.size(); tid++)
+      if (m_bits[tid]) str[m_bits.size() - 1 - tid] = '1';
+    return str;
+  }
+
+ private:
+  std::vector<bool> m_bits;
+};
+
 class shader_core_ctx : public core_t {
  public:
   // creator:
@@ -1900,6 +2101,9 @@ class shader_core_ctx : public core_t {
     else
       return 0;
   }
+  // no CTA and no unfinished thread: cycle() has nothing to do until the
+  // next CTA is issued to this core
+  bool quiescent() const { return !isactive() && get_not_completed() == 0; }
   kernel_info_t *get_kernel() { return m_kernel; }
   unsigned get_sid() const { return m_sid; }
 
@@ -1917,6 +2121,16 @@ class shader_core_ctx : public core_t {
   // modifiers
   void mem_instruction_stats(const warp_inst_t &inst);
   void decrement_atomic_count(unsigned wid, unsigned n);
+  // wake the scheduler supervising warp_id, or all of them
+  void wakeup_scheduler(unsigned warp_id) {
+    schedulers[warp_id % schedulers.size()]->wakeup();
+  }
+  void wakeup_schedulers() {
+    for (unsigned i = 0; i < schedulers.size(); i++) schedulers[i]->wakeup();
+  }
+  void l1d_load_miss(unsigned warp_id) {
+    schedulers[warp_id % schedulers.size()]->on_l1d_load_miss(warp_id);
+  }
   void inc_store_req(unsigned warp_id) { m_warp[warp_id]->inc_store_req(); }
   void dec_inst_in_pipeline(unsigned warp_id) {
     m_warp[warp_id]->dec_inst_in_pipeline();
@@ -2118,6 +2332,21 @@ class shader_core_ctx : public core_t {
 
   void issue();
   friend class scheduler_unit;  // this is needed to use private issue warp.
+
+ public:
+  static void register_scheduler_policy(const char *name,
+                                        scheduler_factory_t create);
+  // factories for schedulers constructed without / with the config string
+  template <class T>
+  static scheduler_unit *new_scheduler(shader_core_ctx *core, unsigned id,
+                                       char *config_string);
+  template <class T>
+  static scheduler_unit *new_configured_scheduler(shader_core_ctx *core,
+                                                  unsigned id,
+                                                  char *config_string);
+
+ protected:
+  static std::vector<scheduler_policy_t> &scheduler_policies();
   friend class TwoLevelScheduler;
   friend class LooseRoundRobbinScheduler;
   friend class opndcoll_rfu_t;
@@ -2189,7 +2418,7 @@ class shader_core_ctx : public core_t {
   unsigned m_cta_status[MAX_CTA_PER_SHADER];  // CTAs status
   unsigned m_not_completed;  // number of threads to be completed (==0 when all
                              // thread on this core completed)
-  std::bitset<MAX_THREAD_PER_SM> m_active_threads;
+  hw_thread_mask_t m_active_threads;
 
   // thread contexts
   thread_ctx_t *m_threadState;
@@ -2250,10 +2479,37 @@ class shader_core_ctx : public core_t {
   unsigned int m_occupied_shmem;
   unsigned int m_occupied_regs;
   unsigned int m_occupied_ctas;
-  std::bitset<MAX_THREAD_PER_SM> m_occupied_hwtid;
+  hw_thread_mask_t m_occupied_hwtid;
   std::map<unsigned int, unsigned int> m_occupied_cta_to_hwtid;
 };
 
+template <class T>
+scheduler_unit *shader_core_ctx::new_scheduler(shader_core_ctx *core,
+                                               unsigned id,
+                                               char *config_string) {
+  return new T(core->m_stats, core, core->m_scoreboard, core->m_simt_stack,
+               &core->m_warp, &core->m_pipeline_reg[ID_OC_SP],
+               &core->m_pipeline_reg[ID_OC_DP],
+               &core->m_pipeline_reg[ID_OC_SFU],
+               &core->m_pipeline_reg[ID_OC_INT],
+               &core->m_pipeline_reg[ID_OC_TENSOR_CORE],
+               core->m_specilized_dispatch_reg,
+               &core->m_pipeline_reg[ID_OC_MEM], id);
+}
+
+template <class T>
+scheduler_unit *shader_core_ctx::new_configured_scheduler(
+    shader_core_ctx *core, unsigned id, char *config_string) {
+  return new T(core->m_stats, core, core->m_scoreboard, core->m_simt_stack,
+               &core->m_warp, &core->m_pipeline_reg[ID_OC_SP],
+               &core->m_pipeline_reg[ID_OC_DP],
+               &core->m_pipeline_reg[ID_OC_SFU],
+               &core->m_pipeline_reg[ID_OC_INT],
+               &core->m_pipeline_reg[ID_OC_TENSOR_CORE],
+               core->m_specilized_dispatch_reg,
+               &core->m_pipeline_reg[ID_OC_MEM], id, config_string);
+}
+
 class exec_shader_core_ctx : public shader_core_ctx {
  public:
   exec_shader_core_ctx(class gpgpu_sim *gpu, class simt_core_cluster *cluster,
@@ -2346,6 +2602,9 @@ class simt_core_cluster {
 
   unsigned m_cta_issue_next_core;
   std::list<unsigned> m_core_sim_order;
+  // upper bound on the non-quiescent cores; recounted by core_cycle(),
+  // raised when a CTA is issued
+  unsigned m_n_awake_cores;
   std::list<mem_fetch *> m_response_fifo;
 };
 
@@ -0,0 +1,73 @@
+#include "sim_prof.h"
+
+#include <string.h>
+#include <sys/time.h>
+
+namespace SimProf {
+
+#define SP_TUP_BEGIN(X) const char *region_str[] = {
+#define SP_TUP(X, D) #X
+#define SP_TUP_END(X) \
+  }                   \
+  ;
+#include "sim_prof_regions.tup"
+#undef SP_TUP_BEGIN
+#undef SP_TUP
+#undef SP_TUP_END
+
+#define SP_TUP_BEGIN(X) const unsigned region_depth[] = {
+#define SP_TUP(X, D) D
+#define SP_TUP_END(X) \
+  }                   \
+  ;
+#include "sim_prof_regions.tup"
+#undef SP_TUP_BEGIN
+#undef SP_TUP
+#undef SP_TUP_END
+
+unsigned long long region_ticks[NUM_SIM_PROF_REGIONS] = {0};
+unsigned long long region_calls[NUM_SIM_PROF_REGIONS] = {0};
+
+static unsigned long long start_ticks = 0;
+static double start_wall = 0;
+
+static double wall_seconds() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+void init() {
+  start_ticks = read_tsc();
+  start_wall = wall_seconds();
+}
+
+void print(FILE *fout, unsigned long long sim_cycles,
+           unsigned long long sim_insn) {
+  double elapsed = wall_seconds() - start_wall;
+  unsigned long long elapsed_ticks = read_tsc() - start_ticks;
+  if (elapsed <= 0 || elapsed_ticks == 0) return;
+  // timestamp counter is calibrated against the wall clock over the whole run
+  double ticks_per_sec = (double)elapsed_ticks / elapsed;
+
+  fprintf(fout, "\n========= Simulator self-profile =========\n");
+  fprintf(fout, "sim_prof_host_time = %.3f sec\n", elapsed);
+  fprintf(fout, "sim_prof_tsc_freq = %.1f MHz\n", ticks_per_sec / 1e6);
+  fprintf(fout, "%-28s %12s %8s %16s %12s %10s\n", "region", "host_sec",
+          "%host", "calls", "calls/cycle", "ns/call");
+  for (unsigned i = 0; i < NUM_SIM_PROF_REGIONS; i++) {
+    char name[64];
+    unsigned indent = 2 * region_depth[i];
+    snprintf(name, sizeof(name), "%*s%s", indent, "", region_str[i]);
+    double sec = region_ticks[i] / ticks_per_sec;
+    fprintf(fout, "%-28s %12.3f %7.2f%% %16llu %12.3f %10.1f\n", name, sec,
+            100.0 * sec / elapsed, region_calls[i],
+            sim_cycles ? (double)region_calls[i] / sim_cycles : 0.0,
+            region_calls[i] ? 1e9 * sec / region_calls[i] : 0.0);
+  }
+  fprintf(fout, "sim_prof_cycles_per_sec = %.1f\n", sim_cycles / elapsed);
+  fprintf(fout, "sim_prof_insn_per_sec = %.1f\n", sim_insn / elapsed);
+  fprintf(fout, "==========================================\n");
+}
+
+}  // namespace SimProf
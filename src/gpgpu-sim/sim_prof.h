@@ -0,0 +1,79 @@
+#ifndef __SIM_PROF_H__
+#define __SIM_PROF_H__
+
+#include <stdio.h>
+#include <time.h>
+
+// Simulator self-profiler: attributes host (wall-clock) time to the major
+// simulation loops using scoped timestamp-counter timers. Build with
+// SELF_PROF=1 to enable; otherwise SIM_PROF_SCOPE() compiles to nothing.
+
+namespace SimProf {
+
+#define SP_TUP_BEGIN(X) enum X {
+#define SP_TUP(X, D) X
+#define SP_TUP_END(X) \
+  }                   \
+  ;
+#include "sim_prof_regions.tup"
+#undef SP_TUP_BEGIN
+#undef SP_TUP
+#undef SP_TUP_END
+
+extern const char *region_str[];
+extern const unsigned region_depth[];
+extern unsigned long long region_ticks[NUM_SIM_PROF_REGIONS];
+extern unsigned long long region_calls[NUM_SIM_PROF_REGIONS];
+
+static inline unsigned long long read_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned lo, hi;
+  __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+  return ((unsigned long long)hi << 32) | lo;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+class scoped_timer {
+ public:
+  scoped_timer(sim_prof_region_type region)
+      : m_region(region), m_start(read_tsc()) {}
+  ~scoped_timer() {
+    region_ticks[m_region] += read_tsc() - m_start;
+    region_calls[m_region]++;
+  }
+
+ private:
+  sim_prof_region_type m_region;
+  unsigned long long m_start;
+};
+
+// Records the timestamp counter and wall-clock origin used to convert ticks
+// into seconds. Called once when the performance model is created.
+void init();
+
+// Prints the per-region breakdown followed by the simulation rates.
+void print(FILE *fout, unsigned long long sim_cycles,
+           unsigned long long sim_insn);
+
+}  // namespace SimProf
+
+#if SELF_PROF_ON
+
+#define SIM_PROF_CAT_(a, b) a##b
+#define SIM_PROF_CAT(a, b) SIM_PROF_CAT_(a, b)
+#define SIM_PROF_SCOPE(x) \
+  SimProf::scoped_timer SIM_PROF_CAT(sim_prof_timer_, __LINE__)(SimProf::x)
+
+#else
+
+#define SIM_PROF_SCOPE(x) \
+  do {                    \
+  } while (0)
+
+#endif
+
+#endif
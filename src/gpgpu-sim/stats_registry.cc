@@ -0,0 +1,148 @@
+#include "stats_registry.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+// file layout (native byte order, checked through the byte-order mark):
+//   char     magic[8] = "GSIMSTAT"
+//   uint32_t version, byte_order_mark (0x01020304), num_entries
+//   uint64_t record_size
+//   per entry: uint32_t name_len, char name[name_len],
+//              uint32_t kind, count, cols, uint64_t offset
+//   records:   uint32_t type, index, uint64_t cycle, insn, <columns>
+static const char stats_magic[8] = {'G', 'S', 'I', 'M', 'S', 'T', 'A', 'T'};
+static const uint32_t stats_version = 1;
+static const uint32_t stats_bom = 0x01020304;
+static const size_t stats_record_hdr =
+    2 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+static const size_t stat_kind_size[] = {sizeof(uint32_t), sizeof(uint64_t),
+                                        sizeof(int64_t), sizeof(double)};
+
+stats_registry::stats_registry() {
+  m_record_size = stats_record_hdr;
+  m_num_records = 0;
+  m_fp = NULL;
+}
+
+stats_registry::~stats_registry() { close(); }
+
+void stats_registry::add_reader(const std::string &name, stat_kind kind,
+                                unsigned count, unsigned cols,
+                                std::function<void(unsigned char *)> read) {
+  assert(m_fp == NULL && "stats must be registered before the first dump");
+  stat_entry e;
+  e.name = name;
+  e.kind = kind;
+  e.count = count;
+  e.cols = cols;
+  e.offset = (m_record_size + 7) & ~(size_t)7;
+  e.read = read;
+  m_record_size = e.offset + count * stat_kind_size[kind];
+  m_entries.push_back(e);
+}
+
+void stats_registry::add(const std::string &name, const unsigned *p,
+                         unsigned n, unsigned cols) {
+  add_reader(name, STAT_U32, n, cols, [p, n](unsigned char *dst) {
+    for (unsigned i = 0; i < n; i++) ((uint32_t *)dst)[i] = p[i];
+  });
+}
+
+void stats_registry::add(const std::string &name, const unsigned long long *p,
+                         unsigned n, unsigned cols) {
+  add_reader(name, STAT_U64, n, cols, [p, n](unsigned char *dst) {
+    for (unsigned i = 0; i < n; i++) ((uint64_t *)dst)[i] = p[i];
+  });
+}
+
+void stats_registry::add(const std::string &name, const int *p, unsigned n,
+                         unsigned cols) {
+  add_reader(name, STAT_I64, n, cols, [p, n](unsigned char *dst) {
+    for (unsigned i = 0; i < n; i++) ((int64_t *)dst)[i] = p[i];
+  });
+}
+
+void stats_registry::add(const std::string &name, const long *p, unsigned n,
+                         unsigned cols) {
+  add_reader(name, STAT_I64, n, cols, [p, n](unsigned char *dst) {
+    for (unsigned i = 0; i < n; i++) ((int64_t *)dst)[i] = p[i];
+  });
+}
+
+void stats_registry::add(const std::string &name, const double *p, unsigned n,
+                         unsigned cols) {
+  add_reader(name, STAT_F64, n, cols, [p, n](unsigned char *dst) {
+    memcpy(dst, p, n * sizeof(double));
+  });
+}
+
+void stats_registry::add_rows(const std::string &name, unsigned *const *rows,
+                              unsigned nrows, unsigned ncols) {
+  add_reader(name, STAT_U32, nrows * ncols, ncols,
+             [rows, nrows, ncols](unsigned char *dst) {
+               uint32_t *out = (uint32_t *)dst;
+               for (unsigned r = 0; r < nrows; r++)
+                 for (unsigned c = 0; c < ncols; c++)
+                   out[r * ncols + c] = rows[r][c];
+             });
+}
+
+void stats_registry::set_output(const char *filename) {
+  m_filename = filename ? filename : "";
+}
+
+void stats_registry::write_header() {
+  fwrite(stats_magic, 1, sizeof(stats_magic), m_fp);
+  uint32_t n = m_entries.size();
+  uint64_t rsize = m_record_size;
+  fwrite(&stats_version, sizeof(uint32_t), 1, m_fp);
+  fwrite(&stats_bom, sizeof(uint32_t), 1, m_fp);
+  fwrite(&n, sizeof(uint32_t), 1, m_fp);
+  fwrite(&rsize, sizeof(uint64_t), 1, m_fp);
+  for (std::vector<stat_entry>::const_iterator e = m_entries.begin();
+       e != m_entries.end(); ++e) {
+    uint32_t desc[3] = {(uint32_t)e->kind, e->count, e->cols};
+    uint32_t len = e->name.size();
+    uint64_t offset = e->offset;
+    fwrite(&len, sizeof(uint32_t), 1, m_fp);
+    fwrite(e->name.data(), 1, len, m_fp);
+    fwrite(desc, sizeof(uint32_t), 3, m_fp);
+    fwrite(&offset, sizeof(uint64_t), 1, m_fp);
+  }
+}
+
+void stats_registry::dump(stat_record_type type, unsigned long long cycle,
+                          unsigned long long insn) {
+  if (!enabled()) return;
+  if (m_fp == NULL) {
+    m_fp = fopen(m_filename.c_str(), "wb");
+    if (m_fp == NULL) {
+      printf("GPGPU-Sim uArch: cannot open binary stats file %s\n",
+             m_filename.c_str());
+      m_filename.clear();
+      return;
+    }
+    write_header();
+    m_record.assign(m_record_size, 0);
+  }
+
+  unsigned char *rec = &m_record[0];
+  uint32_t hdr[2] = {(uint32_t)type, m_num_records++};
+  uint64_t when[2] = {cycle, insn};
+  memcpy(rec, hdr, sizeof(hdr));
+  memcpy(rec + sizeof(hdr), when, sizeof(when));
+  for (std::vector<stat_entry>::const_iterator e = m_entries.begin();
+       e != m_entries.end(); ++e)
+    e->read(rec + e->offset);
+  fwrite(rec, 1, m_record_size, m_fp);
+  fflush(m_fp);
+}
+
+void stats_registry::close() {
+  if (m_fp) {
+    fclose(m_fp);
+    m_fp = NULL;
+  }
+}
@@ -0,0 +1,116 @@
+#ifndef __STATS_REGISTRY_H__
+#define __STATS_REGISTRY_H__
+
+#include <stdio.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Registry of simulator counters for the binary statistics stream.
+//
+// Every counter, histogram or per-unit vector is declared once with a name
+// and a pointer to its storage.  A dump copies the current values into a
+// fixed-size record without any formatting.  The file starts with a header
+// describing each column (name, type, element count, row length), followed
+// by one record per kernel and, optionally, per sampling interval.
+// scripts/stats_bin_convert.py converts the file to CSV or JSON.
+
+enum stat_record_type {
+  STAT_RECORD_KERNEL = 1,  // end of a kernel (print_stats)
+  STAT_RECORD_SAMPLE = 2   // every gpu_stat_sample_freq cycles
+};
+
+class stats_registry {
+ public:
+  enum stat_kind { STAT_U32 = 0, STAT_U64 = 1, STAT_I64 = 2, STAT_F64 = 3 };
+
+  stats_registry();
+  ~stats_registry();
+
+  // scalar (n == 1), vector (n elements) or row-major matrix of n / cols rows
+  void add(const std::string &name, const unsigned *p, unsigned n = 1,
+           unsigned cols = 0);
+  void add(const std::string &name, const unsigned long long *p,
+           unsigned n = 1, unsigned cols = 0);
+  void add(const std::string &name, const int *p, unsigned n = 1,
+           unsigned cols = 0);
+  void add(const std::string &name, const long *p, unsigned n = 1,
+           unsigned cols = 0);
+  void add(const std::string &name, const double *p, unsigned n = 1,
+           unsigned cols = 0);
+  // matrix stored as an array of row pointers, e.g. [dram chip][bank]
+  void add_rows(const std::string &name, unsigned *const *rows, unsigned nrows,
+                unsigned ncols);
+  // counters keyed by an enum; all keys must be present when registered
+  template <class K>
+  void add_map(const std::string &name, const std::map<K, unsigned> *m) {
+    const unsigned n = m->size();
+    add_reader(name, STAT_U32, n, 0, [m, n](unsigned char *dst) {
+      unsigned *out = (unsigned *)dst;
+      unsigned i = 0;
+      for (typename std::map<K, unsigned>::const_iterator it = m->begin();
+           it != m->end() && i < n; ++it, ++i)
+        out[i] = it->second;
+    });
+  }
+  // samples appended during the run, as {count, sum, max}
+  template <class T>
+  void add_series(const std::string &name, const std::vector<T> *v) {
+    add_reader(name, STAT_U64, 3, 0, [v](unsigned char *dst) {
+      unsigned long long *out = (unsigned long long *)dst;
+      out[0] = v->size();
+      out[1] = 0;
+      out[2] = 0;
+      for (unsigned i = 0; i < v->size(); i++) {
+        out[1] += (*v)[i];
+        if ((*v)[i] > out[2]) out[2] = (*v)[i];
+      }
+    });
+  }
+  // log of enum values, as the number of occurrences of each of the n keys
+  template <class K>
+  void add_histogram(const std::string &name, const std::vector<K> *v,
+                     unsigned n) {
+    add_reader(name, STAT_U32, n, 0, [v, n](unsigned char *dst) {
+      unsigned *out = (unsigned *)dst;
+      for (unsigned i = 0; i < n; i++) out[i] = 0;
+      for (unsigned i = 0; i < v->size(); i++)
+        if ((unsigned)(*v)[i] < n) out[(unsigned)(*v)[i]]++;
+    });
+  }
+  // anything else: |read| fills |count| elements of |kind| at the pointer
+  void add_reader(const std::string &name, stat_kind kind, unsigned count,
+                  unsigned cols, std::function<void(unsigned char *)> read);
+
+  // The file is created and the header written on the first dump, after all
+  // units have registered their counters.
+  void set_output(const char *filename);
+  bool enabled() const { return !m_filename.empty(); }
+  void dump(stat_record_type type, unsigned long long cycle,
+            unsigned long long insn);
+  void close();
+
+  unsigned num_entries() const { return m_entries.size(); }
+
+ private:
+  struct stat_entry {
+    std::string name;
+    stat_kind kind;
+    unsigned count;
+    unsigned cols;
+    size_t offset;  // byte offset of the column inside a record
+    std::function<void(unsigned char *)> read;
+  };
+
+  void write_header();
+
+  std::vector<stat_entry> m_entries;
+  std::vector<unsigned char> m_record;
+  size_t m_record_size;
+  unsigned m_num_records;
+  std::string m_filename;
+  FILE *m_fp;
+};
+
+#endif
@@ -312,7 +312,6 @@ class my_time_vector {
   }
   void print_dist(void) {
     unsigned i;
-    calculate_dist();
     std::cout << "LD_mem_lat_dist ";
     for (i = 0; i < ld_vector_size; i++) {
       std::cout << " " << (int)overal_ld_time_dist[i];
@@ -360,6 +359,8 @@ void time_vector_create(int size) {
   g_my_time_vector = new my_time_vector(size, size);
 }
 
+void time_vector_calculate_dist(void) { g_my_time_vector->calculate_dist(); }
+
 void time_vector_print(void) { g_my_time_vector->print_dist(); }
 
 void time_vector_print_interval2gzfile(gzFile outfile) {
@@ -33,6 +33,9 @@
 #include <zlib.h>
 
 void time_vector_create(int size);
+// folds the finished requests into the distributions time_vector_print()
+// and the visualizer log report
+void time_vector_calculate_dist(void);
 void time_vector_print(void);
 void time_vector_update(unsigned int uid, int slot, long int cycle, int type);
 void check_time_vector_update(unsigned int uid, int slot, long int latency,
@@ -0,0 +1,189 @@
+#include "write_combining.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include "gpu-sim.h"
+#include "mem_fetch.h"
+#include "stats_registry.h"
+
+write_combining_buffer::write_combining_buffer(const memory_config *config) {
+  m_config = config;
+  m_n_entries = config->l2_wcb_entries;
+  m_block_size = config->l2_wcb_block_size;
+  n_writes = 0;
+  n_merged = 0;
+  n_flush_full = 0;
+  n_flush_timeout = 0;
+  n_flush_evict = 0;
+  n_flush_conflict = 0;
+  n_flush_drain = 0;
+
+  const unsigned n_sectors = m_block_size / SECTOR_SIZE;
+  if (m_block_size < SECTOR_SIZE || (m_block_size & (m_block_size - 1)) ||
+      n_sectors > 64) {
+    printf("GPGPU-Sim uArch: -gpgpu_l2_wcb_block_size must be a power of two "
+           "between %u and %u bytes\n",
+           SECTOR_SIZE, 64 * SECTOR_SIZE);
+    abort();
+  }
+  m_full_block = (n_sectors == 64) ? ~0ULL : ((1ULL << n_sectors) - 1);
+}
+
+bool write_combining_buffer::can_combine(mem_fetch *mf) const {
+  if (!mf->is_pim() || mf->get_access_type() != GLOBAL_ACC_W) return false;
+  // broadcast writes are replicated from the original's access, keep them
+  // as they are
+  if (m_config->dram_pim_broadcast_bit &&
+      ((mf->get_addr() >> m_config->dram_pim_broadcast_bit) & 1))
+    return false;
+  const new_addr_type offset = mf->get_addr() & (m_block_size - 1);
+  return mf->get_data_size() > 0 &&
+         offset + mf->get_data_size() <= m_block_size;
+}
+
+new_addr_type write_combining_buffer::block_of(mem_fetch *mf) const {
+  return mf->get_addr() & ~(new_addr_type)(m_block_size - 1);
+}
+
+unsigned long long write_combining_buffer::sector_bits(mem_fetch *mf) const {
+  const unsigned offset = mf->get_addr() & (m_block_size - 1);
+  const unsigned first = offset / SECTOR_SIZE;
+  const unsigned last = (offset + mf->get_data_size() - 1) / SECTOR_SIZE;
+  unsigned long long bits = 0;
+  for (unsigned s = first; s <= last; s++) bits |= 1ULL << s;
+  return bits;
+}
+
+bool write_combining_buffer::merge(mem_fetch *mf) {
+  const new_addr_type block = block_of(mf);
+  const unsigned long long bits = sector_bits(mf);
+  const addrdec_t &tlx = mf->get_tlx_addr();
+  n_writes++;
+
+  for (std::deque<entry_t>::iterator e = m_entries.begin();
+       e != m_entries.end(); ++e) {
+    if (e->closed || e->block != block) continue;
+    const addrdec_t &lead = e->leader->get_tlx_addr();
+    // a rewritten sector or a different op class is a second PIM op: close
+    // the block so the two reach the DRAM in order
+    if (lead.bk != tlx.bk || lead.row != tlx.row || (e->sectors & bits) ||
+        (m_config->dram_pim_op_bit &&
+         (((e->leader->get_addr() ^ mf->get_addr()) >>
+           m_config->dram_pim_op_bit) & 0x3))) {
+      e->closed = WCB_CLOSE_CONFLICT;
+      continue;
+    }
+
+    e->sectors |= bits;
+    e->leader->set_data_size(e->leader->get_data_size() +
+                             mf->get_data_size());
+    e->followers.push_back(mf);
+    if (e->sectors == m_full_block) e->closed = WCB_CLOSE_FULL;
+    n_merged++;
+    return true;
+  }
+  return false;
+}
+
+void write_combining_buffer::insert(mem_fetch *mf, unsigned long long cycle) {
+  assert(!full());
+  // only the youngest block of a DRAM row takes writes, or a write folded
+  // into an older block would reach the row ahead of this one
+  const addrdec_t &tlx = mf->get_tlx_addr();
+  for (std::deque<entry_t>::iterator o = m_entries.begin();
+       o != m_entries.end(); ++o) {
+    const addrdec_t &lead = o->leader->get_tlx_addr();
+    if (!o->closed && lead.chip == tlx.chip && lead.bk == tlx.bk &&
+        lead.row == tlx.row)
+      o->closed = WCB_CLOSE_CONFLICT;
+  }
+
+  entry_t e;
+  e.leader = mf;
+  e.block = block_of(mf);
+  e.sectors = sector_bits(mf);
+  e.open_cycle = cycle;
+  e.leader_size = mf->get_data_size();
+  e.closed = (e.sectors == m_full_block) ? WCB_CLOSE_FULL : WCB_OPEN;
+  m_entries.push_back(e);
+}
+
+mem_fetch *write_combining_buffer::ready_top(unsigned long long cycle) const {
+  if (m_entries.empty()) return NULL;
+  const entry_t &e = m_entries.front();
+  if (!e.closed && cycle < e.open_cycle + m_config->l2_wcb_timeout)
+    return NULL;
+  return e.leader;
+}
+
+mem_fetch *write_combining_buffer::pop(unsigned long long cycle) {
+  assert(!m_entries.empty());
+  entry_t &e = m_entries.front();
+  if (e.closed == WCB_CLOSE_FULL)
+    n_flush_full++;
+  else if (e.closed == WCB_CLOSE_CONFLICT)
+    n_flush_conflict++;
+  else if (e.closed == WCB_CLOSE_DRAIN)
+    n_flush_drain++;
+  else if (cycle >= e.open_cycle + m_config->l2_wcb_timeout)
+    n_flush_timeout++;
+  else
+    n_flush_evict++;
+
+  mem_fetch *leader = e.leader;
+  if (!e.followers.empty()) {
+    in_flight_t &f = m_in_flight[leader];
+    f.leader_size = e.leader_size;
+    f.followers.swap(e.followers);
+  }
+  m_entries.pop_front();
+  return leader;
+}
+
+void write_combining_buffer::drain() {
+  for (std::deque<entry_t>::iterator e = m_entries.begin();
+       e != m_entries.end(); ++e)
+    if (!e->closed) e->closed = WCB_CLOSE_DRAIN;
+}
+
+void write_combining_buffer::dram_done(mem_fetch *mf) {
+  if (m_in_flight.empty()) return;
+  std::map<mem_fetch *, in_flight_t>::iterator f = m_in_flight.find(mf);
+  if (f == m_in_flight.end()) return;
+  mf->set_data_size(f->second.leader_size);
+  for (unsigned i = 0; i < f->second.followers.size(); i++) {
+    mem_fetch *follower = f->second.followers[i];
+    follower->set_reply();
+    m_acks.push_back(follower);
+  }
+  m_in_flight.erase(f);
+}
+
+mem_fetch *write_combining_buffer::ack_top() const {
+  if (m_acks.empty()) return NULL;
+  return m_acks.front();
+}
+
+void write_combining_buffer::print(FILE *fp, unsigned id) const {
+  fprintf(fp,
+          "L2 WCB[%u]: n_writes = %llu, n_merged = %llu, flushes (full = "
+          "%llu, timeout = %llu, evict = %llu, conflict = %llu, drain = "
+          "%llu)\n",
+          id, n_writes, n_merged, n_flush_full, n_flush_timeout, n_flush_evict,
+          n_flush_conflict, n_flush_drain);
+}
+
+void write_combining_buffer::register_stats(stats_registry &reg,
+                                            unsigned id) const {
+  char prefix[32];
+  snprintf(prefix, sizeof(prefix), "l2_wcb[%u].", id);
+  const std::string p(prefix);
+
+  reg.add(p + "n_writes", &n_writes);
+  reg.add(p + "n_merged", &n_merged);
+  reg.add(p + "n_flush_full", &n_flush_full);
+  reg.add(p + "n_flush_timeout", &n_flush_timeout);
+  reg.add(p + "n_flush_evict", &n_flush_evict);
+  reg.add(p + "n_flush_conflict", &n_flush_conflict);
+  reg.add(p + "n_flush_drain", &n_flush_drain);
+}
@@ -0,0 +1,102 @@
+#ifndef __WRITE_COMBINING_H__
+#define __WRITE_COMBINING_H__
+
+#include <stdio.h>
+#include <deque>
+#include <map>
+#include <vector>
+#include "../abstract_hardware_model.h"
+
+class mem_fetch;
+class memory_config;
+
+// Write-combining buffer in front of the L2->DRAM queue of a sub partition.
+//
+// PIM and streaming (st.cs) writes bypass the L2, so without the buffer every
+// sector store becomes its own DRAM request.  The buffer keeps up to
+// -gpgpu_l2_wcb_entries open blocks of -gpgpu_l2_wcb_block_size bytes.  A
+// write that falls into an open block with the same DRAM bank and row and
+// does not overlap the sectors already there is folded into the block's
+// leader, which then carries all of them to the DRAM as one request.  Opening
+// a block closes the older blocks of its DRAM row, so writes to a row keep
+// their order.  The folded writes are acked when the leader comes back from
+// the DRAM, so a PIM fence still waits for every write it covers.
+//
+// Blocks leave in the order they were opened, once they are complete, were
+// closed by a conflicting write (n_flush_conflict), were closed by drain()
+// (a PIM fence is pending or a PIM read must not overtake them) or have been
+// open for -gpgpu_l2_wcb_timeout cycles.  When all entries are taken the
+// oldest block is flushed to make room.
+class write_combining_buffer {
+ public:
+  write_combining_buffer(const memory_config *config);
+
+  // true for writes the buffer may hold
+  bool can_combine(mem_fetch *mf) const;
+  // fold mf into an open block, false if no open block accepts it; an open
+  // block of the same address that mf conflicts with is closed
+  bool merge(mem_fetch *mf);
+  bool full() const { return m_entries.size() >= m_n_entries; }
+  void insert(mem_fetch *mf, unsigned long long cycle);
+
+  // leader of the oldest block if it may leave the buffer at cycle
+  mem_fetch *ready_top(unsigned long long cycle) const;
+  // remove the oldest block, returns its leader
+  mem_fetch *pop(unsigned long long cycle);
+  bool empty() const { return m_entries.empty(); }
+
+  // close every open block so it is flushed as soon as the queue allows
+  void drain();
+
+  // mf returned from DRAM: restore a leader and queue the acks of the
+  // writes folded into it
+  void dram_done(mem_fetch *mf);
+  mem_fetch *ack_top() const;
+  void ack_pop() { m_acks.pop_front(); }
+
+  void print(FILE *fp, unsigned id) const;
+  void register_stats(class stats_registry &reg, unsigned id) const;
+
+ private:
+  // why a block stopped taking writes
+  enum close_reason {
+    WCB_OPEN = 0,
+    WCB_CLOSE_FULL,
+    WCB_CLOSE_CONFLICT,  // overlapping sectors, op class or a newer row block
+    WCB_CLOSE_DRAIN
+  };
+  struct entry_t {
+    mem_fetch *leader;
+    new_addr_type block;
+    unsigned long long sectors;  // one bit per SECTOR_SIZE chunk of the block
+    unsigned long long open_cycle;
+    unsigned leader_size;  // leader's data size before merging
+    close_reason closed;
+    std::vector<mem_fetch *> followers;
+  };
+  new_addr_type block_of(mem_fetch *mf) const;
+  unsigned long long sector_bits(mem_fetch *mf) const;
+
+  const memory_config *m_config;
+  unsigned m_n_entries;
+  unsigned m_block_size;
+  unsigned long long m_full_block;
+
+  std::deque<entry_t> m_entries;  // oldest first
+  struct in_flight_t {
+    unsigned leader_size;
+    std::vector<mem_fetch *> followers;
+  };
+  std::map<mem_fetch *, in_flight_t> m_in_flight;  // merged leaders in DRAM
+  std::deque<mem_fetch *> m_acks;
+
+  unsigned long long n_writes;
+  unsigned long long n_merged;
+  unsigned long long n_flush_full;
+  unsigned long long n_flush_timeout;
+  unsigned long long n_flush_evict;
+  unsigned long long n_flush_conflict;
+  unsigned long long n_flush_drain;
+};
+
+#endif
@@ -49,7 +49,8 @@ const char* perf_count_label[] = {
     "CC_H,",        "CC_M,",    "SHRD_ACC,", "REG_RD,",      "REG_WR,",
     "NON_REG_OPs,", "SP_ACC,",  "SFU_ACC,",  "FPU_ACC,",     "MEM_RD,",
     "MEM_WR,",      "MEM_PRE,", "L2_RH,",    "L2_RM,",       "L2_WH,",
-    "L2_WM,",       "NOC_A,",   "PIPE_A,",   "IDLE_CORE_N,", "CONST_DYNAMICN"};
+    "L2_WM,",       "NOC_A,",   "PIPE_A,",   "IDLE_CORE_N,", "CONST_DYNAMICN,",
+    "PIM_ACT,",     "PIM_ALU,", "PIM_REG"};
 
 void ParseXML::parse(char* filepath) {
   unsigned int i, j, k, m, n;
@@ -323,6 +324,24 @@ void ParseXML::parse(char* filepath) {
           atof(xNode2.getChildNode("param", i).getAttribute("value"));
       continue;
     }
+    if (strcmp(xNode2.getChildNode("param", i).getAttribute("name"),
+               "pim_act_energy") == 0) {
+      sys.pim_act_energy =
+          atof(xNode2.getChildNode("param", i).getAttribute("value"));
+      continue;
+    }
+    if (strcmp(xNode2.getChildNode("param", i).getAttribute("name"),
+               "pim_alu_energy") == 0) {
+      sys.pim_alu_energy =
+          atof(xNode2.getChildNode("param", i).getAttribute("value"));
+      continue;
+    }
+    if (strcmp(xNode2.getChildNode("param", i).getAttribute("name"),
+               "pim_reg_energy") == 0) {
+      sys.pim_reg_energy =
+          atof(xNode2.getChildNode("param", i).getAttribute("value"));
+      continue;
+    }
     if (strcmp(xNode2.getChildNode("param", i).getAttribute("name"),
                "TOT_INST") == 0) {
       sys.scaling_coefficients[TOT_INST] =
@@ -503,6 +522,24 @@ void ParseXML::parse(char* filepath) {
           atof(xNode2.getChildNode("param", i).getAttribute("value"));
       continue;
     }
+    if (strcmp(xNode2.getChildNode("param", i).getAttribute("name"),
+               "PIM_ACT") == 0) {
+      sys.scaling_coefficients[PIM_ACT] =
+          atof(xNode2.getChildNode("param", i).getAttribute("value"));
+      continue;
+    }
+    if (strcmp(xNode2.getChildNode("param", i).getAttribute("name"),
+               "PIM_ALU") == 0) {
+      sys.scaling_coefficients[PIM_ALU] =
+          atof(xNode2.getChildNode("param", i).getAttribute("value"));
+      continue;
+    }
+    if (strcmp(xNode2.getChildNode("param", i).getAttribute("name"),
+               "PIM_REG") == 0) {
+      sys.scaling_coefficients[PIM_REG] =
+          atof(xNode2.getChildNode("param", i).getAttribute("value"));
+      continue;
+    }
 
     /*
                     if
@@ -4209,6 +4246,9 @@ void ParseXML::initialize()  // Initialize all
   sys.opt_area = false;
   sys.interconnect_projection_type = 1;
   sys.idle_core_power = 0;
+  sys.pim_act_energy = 0;
+  sys.pim_alu_energy = 0;
+  sys.pim_reg_energy = 0;
   int i, j;
   for (i = 0; i <= 63; i++) {
     sys.scaling_coefficients[i] = 1;
@@ -99,6 +99,9 @@ enum perf_count_t {
   PIPE_A,
   IDLE_CORE_N,
   CONST_DYNAMICN,
+  PIM_ACT,
+  PIM_ALU,
+  PIM_REG,
   NUM_PERFORMANCE_COUNTERS
 };
 
@@ -660,6 +663,10 @@ typedef struct {
   int physical_address_width;
   int virtual_memory_page_size;
   double idle_core_power;
+  // Per-operation PIM energies (nJ); McPAT has no in-DRAM compute model.
+  double pim_act_energy;
+  double pim_alu_energy;
+  double pim_reg_energy;
   double num_idle_cores;
   int arch;
   double total_cycles;
@@ -34,7 +34,8 @@
 static const char* pwr_cmp_label[] = {
     "IBP,", "ICP,",  "DCP,",   "TCP,",   "CCP,",        "SHRDP,",
     "RFP,", "SPP,",  "SFUP,",  "FPUP,",  "SCHEDP,",     "L2CP,",
-    "MCP,", "NOCP,", "DRAMP,", "PIPEP,", "IDLE_COREP,", "CONST_DYNAMICP"};
+    "MCP,", "NOCP,", "DRAMP,", "PIPEP,", "IDLE_COREP,", "CONST_DYNAMICP,",
+    "PIMP"};
 
 enum pwr_cmp_t {
   IBP = 0,
@@ -55,6 +56,7 @@ enum pwr_cmp_t {
   PIPEP,
   IDLE_COREP,
   CONST_DYNAMICP,
+  PIMP,
   NUM_COMPONENTS_MODELLED
 };
 
@@ -406,13 +408,21 @@ void gpgpu_sim_wrapper::set_NoC_power(double noc_tot_reads,
   sample_perf_counters[NOC_A] = noc_tot_reads + noc_tot_writes;
 }
 
+void gpgpu_sim_wrapper::set_pim_power(double pim_act, double pim_alu,
+                                      double pim_reg) {
+  sample_perf_counters[PIM_ACT] = pim_act;
+  sample_perf_counters[PIM_ALU] = pim_alu;
+  sample_perf_counters[PIM_REG] = pim_reg;
+}
+
 void gpgpu_sim_wrapper::power_metrics_calculations() {
   total_sample_count++;
   kernel_sample_count++;
 
   // Current sample power
   double sample_power =
-      proc->rt_power.readOp.dynamic + sample_cmp_pwr[CONST_DYNAMICP];
+      proc->rt_power.readOp.dynamic + sample_cmp_pwr[CONST_DYNAMICP] +
+      sample_cmp_pwr[PIMP];
 
   // Average power
   // Previous + new + constant dynamic power (e.g., dynamic clocking power)
@@ -598,6 +608,17 @@ void gpgpu_sim_wrapper::update_coefficients() {
   effpower_coeff[NOC_A] =
       initpower_coeff[NOC_A] * p->sys.scaling_coefficients[NOC_A];
 
+  // PIM energies are given per operation in nJ
+  initpower_coeff[PIM_ACT] = p->sys.pim_act_energy * 1e-9;
+  initpower_coeff[PIM_ALU] = p->sys.pim_alu_energy * 1e-9;
+  initpower_coeff[PIM_REG] = p->sys.pim_reg_energy * 1e-9;
+  effpower_coeff[PIM_ACT] =
+      initpower_coeff[PIM_ACT] * p->sys.scaling_coefficients[PIM_ACT];
+  effpower_coeff[PIM_ALU] =
+      initpower_coeff[PIM_ALU] * p->sys.scaling_coefficients[PIM_ALU];
+  effpower_coeff[PIM_REG] =
+      initpower_coeff[PIM_REG] * p->sys.scaling_coefficients[PIM_REG];
+
   const_dynamic_power =
       proc->get_const_dynamic_power() / (proc->cores[0]->executionTime);
 
@@ -691,6 +712,14 @@ void gpgpu_sim_wrapper::update_components_power() {
 
   proc_power += sample_cmp_pwr[CONST_DYNAMICP];
 
+  // PIM power is not part of the McPAT tree; it comes from the per-operation
+  // energies scaled in update_coefficients().
+  sample_cmp_pwr[PIMP] =
+      sample_perf_counters[PIM_ACT] * effpower_coeff[PIM_ACT] +
+      sample_perf_counters[PIM_ALU] * effpower_coeff[PIM_ALU] +
+      sample_perf_counters[PIM_REG] * effpower_coeff[PIM_REG];
+  proc_power += sample_cmp_pwr[PIMP];
+
   double sum_pwr_cmp = 0;
   for (unsigned i = 0; i < num_pwr_cmps; i++) {
     sum_pwr_cmp += sample_cmp_pwr[i];
@@ -100,6 +100,7 @@ class gpgpu_sim_wrapper {
   void set_active_lanes_power(double sp_avg_active_lane,
                               double sfu_avg_active_lane);
   void set_NoC_power(double noc_tot_reads, double noc_tot_write);
+  void set_pim_power(double pim_act, double pim_alu, double pim_reg);
   bool sanity_check(double a, double b);
 
  private:
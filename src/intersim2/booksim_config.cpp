@@ -201,6 +201,10 @@ BookSimConfig::BookSimConfig( )
   _int_map["read_reply_end_vc"] = 13;
   _int_map["write_reply_begin_vc"] = 10;
   _int_map["write_reply_end_vc"] = 15;
+  // VCs of GPGPU-Sim PIM requests (traffic class 1), -1 = upper half of the
+  // read/write request VCs, the lower half is left to MEM requests
+  _int_map["pim_request_begin_vc"] = -1;
+  _int_map["pim_request_end_vc"] = -1;
 
   // Control Injection of Packets into Replicated Networks
   _int_map["read_request_subnet"] = 0;
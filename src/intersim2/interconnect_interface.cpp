@@ -46,7 +46,7 @@
 #include "network.hpp"
 #include "trace.h"
 
-InterconnectInterface* InterconnectInterface::New(const char* const config_file)
+InterconnectInterface* InterconnectInterface::New(const char* const config_file, unsigned shader_to_mem_vcs)
 {
   if (! config_file ) {
     cout << "Interconnect Requires a configfile" << endl;
@@ -55,6 +55,7 @@ InterconnectInterface* InterconnectInterface::New(const char* const config_file)
   InterconnectInterface* icnt_interface = new InterconnectInterface();
   icnt_interface->_icnt_config = new IntersimConfig();
   icnt_interface->_icnt_config->ParseFile(config_file);
+  icnt_interface->_shader_to_mem_vcs = shader_to_mem_vcs;
 
   return icnt_interface;
 }
@@ -85,6 +86,14 @@ void InterconnectInterface::CreateInterconnect(unsigned n_shader, unsigned n_mem
   _n_shader = n_shader;
   _n_mem = n_mem;
 
+  // one traffic class per shader-to-memory VC, set before the routers and
+  // the routing map size their per-class state; class priorities and the
+  // VCs of the PIM class are set with class_priority and pim_request_*_vc
+  if (_icnt_config->GetInt("classes") < (int)_shader_to_mem_vcs) {
+    _icnt_config->Assign("classes", (int)_shader_to_mem_vcs);
+  }
+  _classes = _icnt_config->GetInt("classes");
+
   InitializeRoutingMap(*_icnt_config);
 
   gPrintActivity = (_icnt_config->GetInt("print_activity") > 0);
@@ -113,6 +122,7 @@ void InterconnectInterface::CreateInterconnect(unsigned n_shader, unsigned n_mem
   }
 
   assert(_icnt_config->GetStr("sim_type") == "gpgpusim");
+
   _traffic_manager = static_cast<GPUTrafficManager*>(TrafficManager::New( *_icnt_config, _net )) ;
 
   _flit_size = _icnt_config->GetInt( "flit_size" );
@@ -144,10 +154,17 @@ void InterconnectInterface::Init()
   //       _boundary_buffer, _ejection_buffer and _ejected_flit_queue should be cleared
 }
 
-void InterconnectInterface::Push(unsigned input_deviceID, unsigned output_deviceID, void *data, unsigned int size)
+int InterconnectInterface::_TrafficClass(bool is_pim) const
+{
+  if (is_pim && _shader_to_mem_vcs > 1)
+    return 1; // PIM_VC
+  return 0;   // MEM_VC
+}
+
+void InterconnectInterface::Push(unsigned input_deviceID, unsigned output_deviceID, void *data, unsigned int size, bool is_pim)
 {
   // it should have free buffer
-  assert(HasBuffer(input_deviceID, size));
+  assert(HasBuffer(input_deviceID, size, is_pim));
 
   DPRINTF(INTERCONNECT, "Sent %d bytes from %d to %d", size, input_deviceID, output_deviceID);
 
@@ -189,7 +206,8 @@ void InterconnectInterface::Push(unsigned input_deviceID, unsigned output_device
   }
 
   //TODO: _include_queuing ?
-  _traffic_manager->_GeneratePacket( input_icntID, -1, 0 /*class*/, _traffic_manager->_time, subnet, n_flits, packet_type, data, output_icntID);
+  int cl = _TrafficClass(is_pim);
+  _traffic_manager->_GeneratePacket( input_icntID, -1, cl, _traffic_manager->_time, subnet, n_flits, packet_type, data, output_icntID);
 
 #if DOUB
   cout <<"Traffic[" << subnet << "] (mapped) sending form "<< input_icntID << " to " << output_icntID << endl;
@@ -211,22 +229,51 @@ void* InterconnectInterface::Pop(unsigned deviceID, unsigned vc)
   if (deviceID < _n_shader)
     subnet = 1;
 
-  int turn = _round_robin_turn[subnet][icntID];
-  for (int vc=0;(vc<_vcs) && (data==NULL);vc++) {
-    if (_boundary_buffer[subnet][icntID][turn].HasPacket()) {
-      data = _boundary_buffer[subnet][icntID][turn].PopPacket();
-    }
-    turn++;
-    if (turn == _vcs) turn = 0;
+  // memory nodes pop requests of one traffic class (L2 VC) at a time
+  int cl_begin = 0, cl_end = _classes;
+  if ((deviceID >= _n_shader) && (_shader_to_mem_vcs > 1)) {
+    assert((int)vc < _classes);
+    cl_begin = vc;
+    cl_end = vc + 1;
   }
-  if (data) {
-    _round_robin_turn[subnet][icntID] = turn;
+
+  for (int cl = cl_begin; (cl < cl_end) && (data == NULL); cl++) {
+    int turn = _round_robin_turn[subnet][icntID][cl];
+    for (int i=0;(i<_vcs) && (data==NULL);i++) {
+      if (_boundary_buffer[subnet][icntID][cl][turn].HasPacket()) {
+        data = _boundary_buffer[subnet][icntID][cl][turn].PopPacket();
+      }
+      turn++;
+      if (turn == _vcs) turn = 0;
+    }
+    if (data) {
+      _round_robin_turn[subnet][icntID][cl] = turn;
+    }
   }
 
   return data;
 
 }
 
+bool InterconnectInterface::HasPacket(unsigned deviceID, unsigned vc) const
+{
+  int icntID = _node_map.find(deviceID)->second;
+  int subnet = (deviceID < _n_shader) ? 1 : 0;
+
+  int cl_begin = 0, cl_end = _classes;
+  if ((deviceID >= _n_shader) && (_shader_to_mem_vcs > 1)) {
+    cl_begin = vc;
+    cl_end = vc + 1;
+  }
+
+  for (int cl = cl_begin; cl < cl_end; cl++) {
+    for (int i = 0; i < _vcs; i++) {
+      if (_boundary_buffer[subnet][icntID][cl][i].HasPacket()) return true;
+    }
+  }
+  return false;
+}
+
 void InterconnectInterface::Advance()
 {
   _traffic_manager->_Step();
@@ -234,12 +281,17 @@ void InterconnectInterface::Advance()
 
 bool InterconnectInterface::Busy() const
 {
-  bool busy = !_traffic_manager->_total_in_flight_flits[0].empty();
+  bool busy = false;
+  for (int cl = 0; cl < _classes; ++cl) {
+    busy |= !_traffic_manager->_total_in_flight_flits[cl].empty();
+  }
   if (!busy) {
     for (int s = 0; s < _subnets; ++s) {
       for (unsigned n = 0; n < _n_shader+_n_mem; ++n) {
-        //FIXME: if this cannot make sure _partial_packets is empty
-        assert(_traffic_manager->_input_queue[s][n][0].empty());
+        for (int cl = 0; cl < _classes; ++cl) {
+          //FIXME: if this cannot make sure _partial_packets is empty
+          assert(_traffic_manager->_input_queue[s][n][cl].empty());
+        }
       }
     }
   }
@@ -247,9 +299,11 @@ bool InterconnectInterface::Busy() const
     return true;
   for (int s = 0; s < _subnets; ++s) {
     for (unsigned n=0; n < (_n_shader+_n_mem); ++n) {
-      for (int vc=0; vc<_vcs; ++vc) {
-        if (_boundary_buffer[s][n][vc].HasPacket() ) {
-          return true;
+      for (int cl=0; cl<_classes; ++cl) {
+        for (int vc=0; vc<_vcs; ++vc) {
+          if (_boundary_buffer[s][n][cl][vc].HasPacket() ) {
+            return true;
+          }
         }
       }
     }
@@ -257,23 +311,34 @@ bool InterconnectInterface::Busy() const
   return false;
 }
 
-bool InterconnectInterface::HasBuffer(unsigned deviceID, unsigned int size) const
+bool InterconnectInterface::HasBuffer(unsigned deviceID, unsigned int size, bool is_pim) const
 {
   bool has_buffer = false;
   unsigned int n_flits = size / _flit_size + ((size % _flit_size)? 1:0);
   int icntID = _node_map.find(deviceID)->second;
+  int cl = _TrafficClass(is_pim);
 
-  has_buffer = _traffic_manager->_input_queue[0][icntID][0].size() +n_flits <= _input_buffer_capacity;
+  has_buffer = _traffic_manager->_input_queue[0][icntID][cl].size() +n_flits <= _input_buffer_capacity;
 
   if ((_subnets>1) && deviceID >= _n_shader) // deviceID is memory node
-    has_buffer = _traffic_manager->_input_queue[1][icntID][0].size() +n_flits <= _input_buffer_capacity;
+    has_buffer = _traffic_manager->_input_queue[1][icntID][cl].size() +n_flits <= _input_buffer_capacity;
 
   return has_buffer;
 }
 
-void InterconnectInterface::DisplayStats() const
+void InterconnectInterface::UpdateStats()
 {
   _traffic_manager->UpdateStats();
+  // hack: booksim2 use _drain_time and calculate delta time based on it, but we don't, change this if you have a better idea
+  _traffic_manager->_drain_time = _traffic_manager->_time;
+  // hack: also _total_sims equals to number of kernel calls
+  _traffic_manager->_total_sims += 1;
+
+  _traffic_manager->_UpdateOverallStats();
+}
+
+void InterconnectInterface::DisplayStats() const
+{
   _traffic_manager->DisplayStats();
 }
 
@@ -284,12 +349,6 @@ unsigned InterconnectInterface::GetFlitSize() const
 
 void InterconnectInterface::DisplayOverallStats() const
 {
-  // hack: booksim2 use _drain_time and calculate delta time based on it, but we don't, change this if you have a better idea
-  _traffic_manager->_drain_time = _traffic_manager->_time;
-  // hack: also _total_sims equals to number of kernel calls
-  _traffic_manager->_total_sims += 1;
-
-  _traffic_manager->_UpdateOverallStats();
   _traffic_manager->DisplayOverallStats();
   if(_traffic_manager->_print_csv_results) {
     _traffic_manager->DisplayOverallStatsCSV();
@@ -326,12 +385,15 @@ void InterconnectInterface::Transfer2BoundaryBuffer(int subnet, int output)
   int vc;
   for (vc=0; vc<_vcs;vc++) {
 
-    if ( !_ejection_buffer[subnet][output][vc].empty() && _boundary_buffer[subnet][output][vc].Size() < _boundary_buffer_capacity ) {
-      flit = _ejection_buffer[subnet][output][vc].front();
-      assert(flit);
+    if ( _ejection_buffer[subnet][output][vc].empty() ) {
+      continue;
+    }
+    flit = _ejection_buffer[subnet][output][vc].front();
+    assert(flit);
 
+    if ( _boundary_buffer[subnet][output][flit->cl][vc].Size() < _boundary_buffer_capacity ) {
       _ejection_buffer[subnet][output][vc].pop();
-      _boundary_buffer[subnet][output][vc].PushFlitData( flit->data, flit->tail);
+      _boundary_buffer[subnet][output][flit->cl][vc].PushFlitData( flit->data, flit->tail);
 
       _ejected_flit_queue[subnet][output].push(flit); //indicate this flit is already popped from ejection buffer and ready for credit return
 
@@ -386,7 +448,11 @@ void InterconnectInterface::_CreateBuffer()
 
     for (unsigned node=0;node < nodes;++node){
       _ejection_buffer[subnet][node].resize(_vcs);
-      _boundary_buffer[subnet][node].resize(_vcs);
+      _boundary_buffer[subnet][node].resize(_classes);
+      _round_robin_turn[subnet][node].resize(_classes, 0);
+      for (int cl=0;cl < _classes;++cl){
+        _boundary_buffer[subnet][node][cl].resize(_vcs);
+      }
     }
   }
 }
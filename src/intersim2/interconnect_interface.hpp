@@ -48,16 +48,19 @@ class InterconnectInterface {
 public:
   InterconnectInterface();
   virtual ~InterconnectInterface();
-  static InterconnectInterface* New(const char* const config_file);
+  static InterconnectInterface* New(const char* const config_file, unsigned shader_to_mem_vcs = 1);
   virtual void CreateInterconnect(unsigned n_shader,  unsigned n_mem);
 
   //node side functions
   virtual void Init();
-  virtual void Push(unsigned input_deviceID, unsigned output_deviceID, void* data, unsigned int size);
+  virtual void Push(unsigned input_deviceID, unsigned output_deviceID, void* data, unsigned int size, bool is_pim = false);
   virtual void* Pop(unsigned ouput_deviceID, unsigned vc);
+  // a Pop(deviceID, vc) would return a packet
+  virtual bool HasPacket(unsigned deviceID, unsigned vc) const;
   virtual void Advance();
   virtual bool Busy() const;
-  virtual bool HasBuffer(unsigned deviceID, unsigned int size) const;
+  virtual bool HasBuffer(unsigned deviceID, unsigned int size, bool is_pim = false) const;
+  virtual void UpdateStats();
   virtual void DisplayStats() const;
   virtual void DisplayOverallStats() const;
   unsigned GetFlitSize() const;
@@ -95,9 +98,10 @@ protected:
   void _CreateBuffer( );
   void _CreateNodeMap(unsigned n_shader, unsigned n_mem, unsigned n_node, int use_map);
   void _DisplayMap(int dim,int count);
+  int _TrafficClass(bool is_pim) const;
 
-  // size: [subnets][nodes][vcs]
-  vector<vector<vector<_BoundaryBufferItem> > > _boundary_buffer;
+  // size: [subnets][nodes][classes][vcs]
+  vector<vector<vector<vector<_BoundaryBufferItem> > > > _boundary_buffer;
   unsigned int _boundary_buffer_capacity;
   // size: [subnets][nodes][vcs]
   vector<vector<vector<_EjectionBufferItem> > > _ejection_buffer;
@@ -107,7 +111,8 @@ protected:
   unsigned int _ejection_buffer_capacity;
   unsigned int _input_buffer_capacity;
 
-  vector<vector<int> > _round_robin_turn; //keep track of _boundary_buffer last used in icnt_pop
+  // size: [subnets][nodes][classes]
+  vector<vector<vector<int> > > _round_robin_turn; //keep track of _boundary_buffer last used in icnt_pop
 
   GPUTrafficManager* _traffic_manager;
   unsigned _flit_size;
@@ -116,6 +121,12 @@ protected:
   vector<Network *> _net;
   int _vcs;
   int _subnets;
+  int _classes;
+
+  // Same semantics as the local crossbar: with more than one shader-to-memory
+  // VC, PIM requests are injected as traffic class 1 (PIM_VC) and each class
+  // is popped separately at the memory nodes.
+  unsigned _shader_to_mem_vcs;
 
   //deviceID to icntID map
   //deviceID : Starts from 0 for shaders and then continues until mem nodes
@@ -68,6 +68,21 @@ int gReadReqBeginVC, gReadReqEndVC;
 int gWriteReqBeginVC, gWriteReqEndVC;
 int gReadReplyBeginVC, gReadReplyEndVC;
 int gWriteReplyBeginVC, gWriteReplyEndVC;
+int gPimReqBeginVC, gPimReqEndVC;
+
+// GPGPU-Sim injects PIM requests as traffic class 1; they use the VCs given
+// by pim_request_begin_vc/pim_request_end_vc, so that PIM streams do not
+// block regular loads and stores inside the network.  Unset, the request
+// VCs are split between the two classes (see InitializeRoutingMap).
+static inline void pim_vc_range( const Flit *f, int &vcBegin, int &vcEnd )
+{
+  if ( ( f->cl == 1 ) && ( gPimReqBeginVC >= 0 ) &&
+       ( ( f->type == Flit::READ_REQUEST ) ||
+         ( f->type == Flit::WRITE_REQUEST ) ) ) {
+    vcBegin = gPimReqBeginVC;
+    vcEnd = gPimReqEndVC;
+  }
+}
 
 // ============================================================
 //  QTree: Nearest Common Ancestor
@@ -89,6 +104,7 @@ void qtree_nca( const Router *r, const Flit *f,
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   int out_port;
@@ -140,6 +156,7 @@ void tree4_anca( const Router *r, const Flit *f,
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   int range = 1;
@@ -210,6 +227,7 @@ void tree4_nca( const Router *r, const Flit *f,
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   int out_port;
@@ -273,6 +291,7 @@ void fattree_nca( const Router *r, const Flit *f,
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   int out_port;
@@ -338,6 +357,7 @@ void fattree_anca( const Router *r, const Flit *f,
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
 
@@ -418,6 +438,7 @@ void adaptive_xy_yx_mesh( const Router *r, const Flit *f,
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   int out_port;
@@ -490,6 +511,7 @@ void xy_yx_mesh( const Router *r, const Flit *f,
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   int out_port;
@@ -658,6 +680,7 @@ void dim_order_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   if ( !inject && f->watch ) {
@@ -697,6 +720,7 @@ void dim_order_ni_mesh( const Router *r, const Flit *f, int in_channel, OutputSe
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   // at the destination router, we don't need to separate VCs by destination
@@ -747,6 +771,7 @@ void dim_order_pni_mesh( const Router *r, const Flit *f, int in_channel, OutputS
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   if(inject || (r->GetID() != f->dest)) {
@@ -827,6 +852,7 @@ void romm_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *outpu
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   int out_port;
@@ -888,6 +914,7 @@ void romm_ni_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *ou
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   // at the destination router, we don't need to separate VCs by destination
@@ -945,6 +972,7 @@ void min_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   outputs->Clear( );
@@ -1045,6 +1073,7 @@ void planar_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputSe
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   outputs->Clear( );
@@ -1222,6 +1251,7 @@ void limited_adapt_mesh( const Router *r, const Flit *f, int in_channel, OutputS
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   if ( inject ) {
@@ -1289,6 +1319,7 @@ void valiant_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *ou
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   int out_port;
@@ -1350,6 +1381,7 @@ void valiant_torus( const Router *r, const Flit *f, int in_channel, OutputSet *o
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   int out_port;
@@ -1429,6 +1461,7 @@ void valiant_ni_torus( const Router *r, const Flit *f, int in_channel,
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   // at the destination router, we don't need to separate VCs by destination
@@ -1531,6 +1564,7 @@ void dim_order_torus( const Router *r, const Flit *f, int in_channel,
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   int out_port;
@@ -1599,6 +1633,7 @@ void dim_order_ni_torus( const Router *r, const Flit *f, int in_channel,
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   int out_port;
@@ -1664,6 +1699,7 @@ void dim_order_bal_torus( const Router *r, const Flit *f, int in_channel,
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   int out_port;
@@ -1731,6 +1767,7 @@ void min_adapt_torus( const Router *r, const Flit *f, int in_channel, OutputSet
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   outputs->Clear( );
@@ -1812,6 +1849,7 @@ void dest_tag_fly( const Router *r, const Flit *f, int in_channel,
     vcBegin = gWriteReplyBeginVC;
     vcEnd = gWriteReplyEndVC;
   }
+  pim_vc_range( f, vcBegin, vcEnd );
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
   int out_port;
@@ -1954,6 +1992,30 @@ void InitializeRoutingMap( const Configuration & config )
   if(gWriteReplyEndVC < 0) {
     gWriteReplyEndVC = gNumVCs - 1;
   }
+  gPimReqBeginVC     = config.GetInt("pim_request_begin_vc");
+  gPimReqEndVC       = config.GetInt("pim_request_end_vc");
+  if((gPimReqBeginVC >= 0) && (gPimReqEndVC < gPimReqBeginVC)) {
+    gPimReqEndVC = gPimReqBeginVC;
+  }
+  if((gPimReqBeginVC < 0) && (config.GetInt("classes") > 1) &&
+     (config.GetStr("sim_type") == "gpgpusim")) {
+    // PIM requests (class 1) get the upper half of the request VCs and MEM
+    // requests keep the lower half; with a single request VC both share it
+    int begin = min(gReadReqBeginVC, gWriteReqBeginVC);
+    int end = max(gReadReqEndVC, gWriteReqEndVC);
+    if(end > begin) {
+      gPimReqBeginVC = begin + (end - begin + 1) / 2;
+      gPimReqEndVC = end;
+      gReadReqEndVC = min(gReadReqEndVC, gPimReqBeginVC - 1);
+      gWriteReqEndVC = min(gWriteReqEndVC, gPimReqBeginVC - 1);
+      if(gReadReqBeginVC > gReadReqEndVC) {
+        gReadReqBeginVC = begin;
+      }
+      if(gWriteReqBeginVC > gWriteReqEndVC) {
+        gWriteReqBeginVC = begin;
+      }
+    }
+  }
 
   /* Register routing functions here */
 
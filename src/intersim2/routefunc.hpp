@@ -44,5 +44,6 @@ extern int gReadReqBeginVC, gReadReqEndVC;
 extern int gWriteReqBeginVC, gWriteReqEndVC;
 extern int gReadReplyBeginVC, gReadReplyEndVC;
 extern int gWriteReplyBeginVC, gWriteReplyEndVC;
+extern int gPimReqBeginVC, gPimReqEndVC;
 
 #endif
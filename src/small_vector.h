@@ -0,0 +1,102 @@
+#ifndef __SMALL_VECTOR_H__
+#define __SMALL_VECTOR_H__
+
+#include <assert.h>
+#include <stddef.h>
+#include <new>
+
+// Vector with the first N elements stored inline.  Used for short per
+// instruction queues (e.g. a warp's memory accesses) that are built and
+// drained every time the instruction executes; only unusually long queues
+// spill to the heap.
+template <typename T, unsigned N>
+class small_vector {
+ public:
+  typedef T *iterator;
+  typedef const T *const_iterator;
+
+  small_vector() : m_data(inline_data()), m_size(0), m_capacity(N) {}
+  small_vector(const small_vector &other)
+      : m_data(inline_data()), m_size(0), m_capacity(N) {
+    append(other);
+  }
+  ~small_vector() {
+    clear();
+    release();
+  }
+
+  small_vector &operator=(const small_vector &other) {
+    if (this != &other) {
+      clear();
+      append(other);
+    }
+    return *this;
+  }
+
+  void push_back(const T &v) {
+    if (m_size == m_capacity) grow(2 * m_capacity);
+    new (m_data + m_size) T(v);
+    m_size++;
+  }
+  void pop_back() {
+    assert(m_size > 0);
+    m_size--;
+    m_data[m_size].~T();
+  }
+  void clear() {
+    while (m_size) pop_back();
+  }
+
+  T &back() {
+    assert(m_size > 0);
+    return m_data[m_size - 1];
+  }
+  const T &back() const {
+    assert(m_size > 0);
+    return m_data[m_size - 1];
+  }
+  T &operator[](unsigned i) { return m_data[i]; }
+  const T &operator[](unsigned i) const { return m_data[i]; }
+
+  unsigned size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  iterator begin() { return m_data; }
+  iterator end() { return m_data + m_size; }
+  const_iterator begin() const { return m_data; }
+  const_iterator end() const { return m_data + m_size; }
+
+ private:
+  T *inline_data() { return reinterpret_cast<T *>(m_inline); }
+
+  void append(const small_vector &other) {
+    if (other.m_size > m_capacity) grow(other.m_size);
+    for (unsigned i = 0; i < other.m_size; i++)
+      new (m_data + i) T(other.m_data[i]);
+    m_size = other.m_size;
+  }
+  void grow(unsigned capacity) {
+    T *data = static_cast<T *>(::operator new(capacity * sizeof(T)));
+    for (unsigned i = 0; i < m_size; i++) {
+      new (data + i) T(m_data[i]);
+      m_data[i].~T();
+    }
+    release();
+    m_data = data;
+    m_capacity = capacity;
+  }
+  void release() {
+    if (m_data != inline_data()) ::operator delete(m_data);
+  }
+
+  union {
+    char m_inline[N * sizeof(T)];
+    double m_align;
+    long long m_align_ll;
+  };
+  T *m_data;
+  unsigned m_size;
+  unsigned m_capacity;
+};
+
+#endif